@@ -0,0 +1,169 @@
+/** @file arena.c
+ *
+ * @brief Static arena for module pools and the RAM budget report.
+ *
+ * A bump allocator over [__arena_start, __arena_end). Pools are linked in
+ * carving order for the report. The stack high-water mark comes from the
+ * paint Reset_Handler lays below the initial stack (see startup.h): the
+ * lowest word that no longer holds the pattern is as deep as the stack
+ * has been.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "arena.h"
+#include "startup.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if ((ARENA_ALIGN & (ARENA_ALIGN - 1u)) != 0u)
+#error "ARENA_ALIGN must be a power of two"
+#endif
+
+#if (ARENA_LINKER_REGION != 0u)
+/* Defined by Linker.ld */
+extern char __arena_start[];
+extern char __arena_end[];
+extern uint32_t _sdata;
+extern uint32_t _top_of_stack;
+
+#define ARENA_START           __arena_start
+#define ARENA_END             __arena_end
+#else
+static char g_arena_storage[ARENA_HOST_SIZE] __attribute__((aligned(ARENA_ALIGN)));
+
+#define ARENA_START           g_arena_storage
+#define ARENA_END             (&g_arena_storage[ARENA_HOST_SIZE])
+#endif
+
+/* Next free byte and the pools carved so far */
+static char * g_p_arena_next = ARENA_START;
+static arena_pool_t * g_p_pools = NULL;
+static arena_pool_t * g_p_last_pool = NULL;
+
+
+/*!
+ * @brief Carve a pool from the arena.
+ *
+ * Calling it again for a pool that already has storage returns that
+ * storage, so a module init may run more than once.
+ *
+ * @param[out] p_pool Pool descriptor, owned by the caller.
+ * @param[in] p_name Name shown by the mem command.
+ * @param[in] item_size Bytes per item.
+ * @param[in] capacity Number of items.
+ *
+ * @return Pool storage (ARENA_ALIGN aligned), or NULL if the arena is too
+ *         small; grow _Min_Heap_Size in Linker.ld then.
+ */
+void *
+arena_pool_init (arena_pool_t * p_pool, char const * p_name,
+                 uint32_t item_size, uint32_t capacity)
+{
+    uint32_t const size = ((item_size * capacity) + (ARENA_ALIGN - 1u)) &
+                          ~(ARENA_ALIGN - 1u);
+
+    if (NULL != p_pool->p_base)
+    {
+        return p_pool->p_base;
+    }
+
+    if (size > (uint32_t)(ARENA_END - g_p_arena_next))
+    {
+        return NULL;
+    }
+
+    p_pool->p_name = p_name;
+    p_pool->p_base = g_p_arena_next;
+    p_pool->item_size = item_size;
+    p_pool->capacity = capacity;
+    p_pool->peak = 0u;
+    p_pool->p_next = NULL;
+
+    g_p_arena_next += size;
+
+    if (NULL == g_p_last_pool)
+    {
+        g_p_pools = p_pool;
+    }
+    else
+    {
+        g_p_last_pool->p_next = p_pool;
+    }
+
+    g_p_last_pool = p_pool;
+
+    return p_pool->p_base;
+}
+
+
+/*!
+ * @brief Record how many items of a pool are in use, for its peak.
+ *
+ * @param[in,out] p_pool Pool to update.
+ * @param[in] in_use Items in use now.
+ */
+void
+arena_pool_use (arena_pool_t * p_pool, uint32_t in_use)
+{
+    if (in_use > p_pool->peak)
+    {
+        p_pool->peak = in_use;
+    }
+}
+
+
+/*!
+ * @brief First pool in carving order; follow p_next for the rest.
+ *
+ * @return First pool, or NULL if none was carved.
+ */
+arena_pool_t const *
+arena_get_pools (void)
+{
+    return g_p_pools;
+}
+
+
+/*!
+ * @brief Report static RAM, arena fill and stack high-water mark.
+ *
+ * Host builds have no linker symbols and report only the arena.
+ *
+ * @param[out] p_usage Usage report.
+ */
+void
+arena_get_usage (arena_usage_t * p_usage)
+{
+#if (ARENA_LINKER_REGION != 0u)
+    uint32_t const * p_word = (uint32_t const *)(void const *)__arena_end;
+
+    /* Deepest stack use: first word above the arena the stack overwrote */
+    while ((p_word < &_top_of_stack) && (STARTUP_STACK_PAINT == *p_word))
+    {
+        p_word++;
+    }
+
+    p_usage->static_bytes = (uint32_t)((uintptr_t)__arena_start - (uintptr_t)&_sdata);
+    p_usage->stack_used = (uint32_t)((uintptr_t)&_top_of_stack - (uintptr_t)p_word);
+    p_usage->stack_size = (uint32_t)((uintptr_t)&_top_of_stack - (uintptr_t)__arena_end);
+#else
+    p_usage->static_bytes = 0u;
+    p_usage->stack_used = 0u;
+    p_usage->stack_size = 0u;
+#endif
+
+    p_usage->arena_used = (uint32_t)(g_p_arena_next - ARENA_START);
+    p_usage->arena_size = (uint32_t)(ARENA_END - ARENA_START);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
@@ -0,0 +1,77 @@
+/** @file arena.h
+ *
+ * @brief Static arena for module pools and the RAM budget report.
+ *
+ * The arena is the _Min_Heap_Size region Linker.ld reserves after .noinit.
+ * Modules carve their working pools from it once, at init, with
+ * arena_pool_init(); nothing is ever freed, so there is no fragmentation
+ * and no malloc. Each pool records its peak use, and the mem command
+ * lists every pool together with the static RAM and the deepest stack
+ * use, so a build can be trimmed to the RAM its part actually has.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Carve from the Linker.ld region (0: a static array, for host builds) */
+#ifndef ARENA_LINKER_REGION
+#define ARENA_LINKER_REGION   1u
+#endif
+
+/* Size of the static array used instead of the linker region */
+#ifndef ARENA_HOST_SIZE
+#define ARENA_HOST_SIZE       4096u
+#endif
+
+/* Alignment of every pool (jsmn tokens and entries hold 32-bit fields) */
+#define ARENA_ALIGN           8u
+
+/**
+ * @brief Pool carved from the arena, owned by the module that uses it.
+ */
+typedef struct arena_pool
+{
+    char const * p_name;            /**< Name in the mem report */
+    void * p_base;                  /**< Pool storage, NULL until carved */
+    uint32_t item_size;             /**< Bytes per item */
+    uint32_t capacity;              /**< Items the pool holds */
+    uint32_t peak;                  /**< Most items in use at once */
+    struct arena_pool * p_next;     /**< Next pool in carving order */
+} arena_pool_t;
+
+/**
+ * @brief RAM budget report.
+ */
+typedef struct arena_usage
+{
+    uint32_t static_bytes;          /**< .data, .bss and .noinit */
+    uint32_t arena_used;            /**< Arena bytes carved (with alignment) */
+    uint32_t arena_size;            /**< Total arena bytes */
+    uint32_t stack_used;            /**< Deepest stack use since reset */
+    uint32_t stack_size;            /**< RAM between the arena and the top */
+} arena_usage_t;
+
+/* Public API functions */
+void * arena_pool_init(arena_pool_t * p_pool, char const * p_name,
+                       uint32_t item_size, uint32_t capacity);
+void arena_pool_use(arena_pool_t * p_pool, uint32_t in_use);
+arena_pool_t const * arena_get_pools(void);
+void arena_get_usage(arena_usage_t * p_usage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARENA_H */
+
+/*** end of file ***/
@@ -0,0 +1,437 @@
+/** @file cli-bin.c
+ *
+ * @brief Binary framed command mode for the CLI.
+ *
+ * Request bytes are COBS-decoded as they are fed in, straight into the
+ * frame buffer, so a frame needs no second pass before its CRC is checked.
+ * The argument fields are then mapped onto a cli_args_t view pointing into
+ * the frame (number fields into a small text scratch) and the registered
+ * handlers run unchanged.
+ *
+ * Responses are built in place: the handler writes its payload behind the
+ * frame header, the CRC is appended and the frame is COBS-encoded in place.
+ * With frames shorter than 255 bytes COBS adds exactly one leading code
+ * byte, so the header is simply written one byte in.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "cli-bin.h"
+#include "startup.h"
+#include "crc16.h"
+#include "cli-fmt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* In-place encoding relies on a single COBS block per response frame */
+#if (CLI_WRITE_BUFFER_SIZE > 256u)
+#error "CLI_WRITE_BUFFER_SIZE too large for in-place COBS encoding"
+#endif
+
+/* Frame layout */
+#define CLI_BIN_DELIMITER       0u
+#define CLI_BIN_MAX_CODE        0xFFu
+#define CLI_BIN_REQUEST_HEADER  2u      /* seq, id */
+#define CLI_BIN_RESPONSE_HEADER 4u      /* code byte, seq, id, status */
+#define CLI_BIN_TRAILER         3u      /* crc16, delimiter */
+#define CLI_BIN_CRC_SIZE        2u
+
+/* Argument field length byte: bit 7 marks a little-endian unsigned number */
+#define CLI_BIN_FIELD_LENGTH    0x7Fu
+#define CLI_BIN_NUMBER_MAX      4u      /* uint32_t */
+#define CLI_BIN_NUMBER_SIZE     11u     /* "4294967295" and its terminator */
+
+/* Receive result codes */
+#define CLI_BIN_RESULT_OK       0
+#define CLI_BIN_RESULT_PENDING  1       /* Frame still arriving */
+
+/* Decoded request frame and COBS decoder state */
+static uint8_t g_bin_frame[CLI_BIN_FRAME_SIZE] STARTUP_NOINIT;
+static size_t g_bin_length = 0u;
+static uint8_t g_bin_code = 0u;         /* Code of the current block, 0 before the first */
+static uint8_t g_bin_remaining = 0u;    /* Data bytes left in the current block */
+static base_type g_b_bin_discard = CLI_FALSE;
+static int32_t g_bin_result = CLI_BIN_RESULT_PENDING;
+
+/* Argv view, kept across continuation calls, and numeric fields as text */
+static cli_args_t g_bin_args;
+static char g_bin_numbers[CLI_MAX_ARGS][CLI_BIN_NUMBER_SIZE];
+static base_type g_b_bin_in_progress = CLI_FALSE;
+
+
+/*!
+ * @brief COBS-encode a frame in place.
+ *
+ * @param[in,out] p_frame Frame with a spare code byte at [0] and the data
+ *                in [1..length-1]; at most 254 data bytes.
+ * @param[in] length Frame length including the code byte.
+ */
+static void
+cli_bin_encode_in_place (uint8_t * p_frame, size_t length)
+{
+    size_t code_position = 0u;
+    uint8_t code = 1u;
+    size_t index = 0u;
+
+    for (index = 1u; index < length; index++)
+    {
+        if (CLI_BIN_DELIMITER == p_frame[index])
+        {
+            /* Each zero becomes the code byte of the block that follows */
+            p_frame[code_position] = code;
+            code_position = index;
+            code = 1u;
+        }
+        else
+        {
+            code++;
+        }
+    }
+
+    p_frame[code_position] = code;
+}
+
+
+/*!
+ * @brief Begin a response frame at the current output position.
+ *
+ * @param[in,out] p_output Output for the response.
+ *
+ * @return Offset of the frame in p_output, or -1 if there is no room for
+ *         an empty frame.
+ */
+static int32_t
+cli_bin_open_frame (cli_output_t * p_output)
+{
+    size_t start = p_output->length;
+
+    if ((p_output->size - start) < (CLI_BIN_RESPONSE_HEADER + CLI_BIN_TRAILER))
+    {
+        return -1;
+    }
+
+    p_output->p_buffer[start + 1u] = (char)g_bin_frame[0];
+    p_output->p_buffer[start + 2u] = (char)g_bin_frame[1];
+    p_output->length = start + CLI_BIN_RESPONSE_HEADER;
+
+    return (int32_t)start;
+}
+
+
+/*!
+ * @brief Complete a response frame: status, CRC, COBS and delimiter.
+ *
+ * @param[in,out] p_output Output holding the frame; the payload ends at
+ *                p_output->length and CLI_BIN_TRAILER bytes are free.
+ * @param[in] start Frame offset from cli_bin_open_frame().
+ * @param[in] status Response status byte.
+ */
+static void
+cli_bin_close_frame (cli_output_t * p_output, size_t start, int8_t status)
+{
+    uint8_t * p_frame = (uint8_t *)&p_output->p_buffer[start];
+    size_t length = p_output->length - start;
+    uint16_t crc = 0u;
+
+    p_frame[3] = (uint8_t)status;
+    crc = crc16_update(CRC16_INIT, &p_frame[1], length - 1u);
+    p_frame[length] = (uint8_t)(crc & 0xFFu);
+    p_frame[length + 1u] = (uint8_t)(crc >> 8);
+    length += CLI_BIN_CRC_SIZE;
+
+    cli_bin_encode_in_place(p_frame, length);
+    p_frame[length] = CLI_BIN_DELIMITER;
+
+    p_output->length = start + length + 1u;
+}
+
+
+/*!
+ * @brief Validate a decoded frame and map its arguments onto the argv view.
+ *
+ * Byte fields point into the frame; number fields are converted to
+ * decimal text, which is what the handlers parse.
+ *
+ * @return CLI_BIN_RESULT_OK or a CLI_BIN_STATUS_* error.
+ */
+static int32_t
+cli_bin_parse_frame (void)
+{
+    size_t position = CLI_BIN_REQUEST_HEADER;
+    size_t end = 0u;
+    size_t field_length = 0u;
+    uint16_t crc = 0u;
+    int32_t argc = 1;
+    uint32_t value = 0u;
+    size_t index = 0u;
+    base_type b_number = CLI_FALSE;
+
+    if (g_bin_length < (CLI_BIN_REQUEST_HEADER + CLI_BIN_CRC_SIZE))
+    {
+        return CLI_BIN_STATUS_FRAME;
+    }
+
+    end = g_bin_length - CLI_BIN_CRC_SIZE;
+    crc = (uint16_t)((uint16_t)g_bin_frame[end] | ((uint16_t)g_bin_frame[end + 1u] << 8));
+
+    if (crc != crc16_update(CRC16_INIT, g_bin_frame, end))
+    {
+        return CLI_BIN_STATUS_CRC;
+    }
+
+    /* argv[0] is filled in from the command id when the request runs */
+    while (position < end)
+    {
+        b_number = ((g_bin_frame[position] & CLI_BIN_FIELD_NUMBER) != 0u) ? CLI_TRUE : CLI_FALSE;
+        field_length = g_bin_frame[position] & CLI_BIN_FIELD_LENGTH;
+        position++;
+
+        if (((position + field_length) > end) || ((uint32_t)argc >= CLI_MAX_ARGS) ||
+            ((CLI_TRUE == b_number) &&
+             ((0u == field_length) || (field_length > CLI_BIN_NUMBER_MAX))))
+        {
+            return CLI_BIN_STATUS_FRAME;
+        }
+
+        if (CLI_TRUE == b_number)
+        {
+            value = 0u;
+
+            for (index = field_length; index > 0u; index--)
+            {
+                value = (value << 8) | g_bin_frame[position + index - 1u];
+            }
+
+            g_bin_args.argv[argc] = g_bin_numbers[argc];
+            g_bin_args.arglen[argc] = (uint16_t)cli_fmt(g_bin_numbers[argc], CLI_BIN_NUMBER_SIZE,
+                                                        "%u", (unsigned int)value);
+        }
+        else
+        {
+            g_bin_args.argv[argc] = (char const *)&g_bin_frame[position];
+            g_bin_args.arglen[argc] = (uint16_t)field_length;
+        }
+
+        position += field_length;
+        argc++;
+    }
+
+    g_bin_args.argc = argc;
+
+    return CLI_BIN_RESULT_OK;
+}
+
+
+/*!
+ * @brief Start receiving a new binary request frame.
+ */
+void
+cli_bin_begin (void)
+{
+    g_bin_length = 0u;
+    g_bin_code = 0u;
+    g_bin_remaining = 0u;
+    g_b_bin_discard = CLI_FALSE;
+    g_bin_result = CLI_BIN_RESULT_PENDING;
+    g_b_bin_in_progress = CLI_FALSE;
+}
+
+
+/*!
+ * @brief Feed received bytes into the frame decoder.
+ *
+ * Consumes bytes only up to and including the frame delimiter, so anything
+ * that follows stays with the caller. Empty frames (repeated delimiters)
+ * are skipped; an oversized frame is dropped up to its delimiter and then
+ * reported as an error.
+ *
+ * @param[in] p_data Received bytes.
+ * @param[in] len Number of bytes offered.
+ * @param[out] p_consumed Number of bytes taken from p_data.
+ *
+ * @return CLI_BIN_FEED_MORE, CLI_BIN_FEED_DONE or CLI_BIN_FEED_ERROR;
+ *         after DONE or ERROR call cli_bin_process_command() for the reply.
+ */
+int32_t
+cli_bin_feed (char const * p_data, size_t len, size_t * p_consumed)
+{
+    size_t used = 0u;
+    uint8_t byte = 0u;
+
+    while ((CLI_BIN_RESULT_PENDING == g_bin_result) && (used < len))
+    {
+        byte = (uint8_t)p_data[used];
+        used++;
+
+        if (CLI_BIN_DELIMITER == byte)
+        {
+            if ((0u == g_bin_code) && (CLI_FALSE == g_b_bin_discard))
+            {
+                continue;
+            }
+
+            g_bin_result = ((CLI_TRUE == g_b_bin_discard) || (0u != g_bin_remaining)) ?
+                           CLI_BIN_STATUS_FRAME : cli_bin_parse_frame();
+        }
+        else if (CLI_TRUE == g_b_bin_discard)
+        {
+            /* Dropping an oversized frame up to its delimiter */
+        }
+        else if (0u == g_bin_remaining)
+        {
+            /* Code byte: the previous block ended in an implied zero */
+            if ((0u != g_bin_code) && (CLI_BIN_MAX_CODE != g_bin_code))
+            {
+                if (g_bin_length >= CLI_BIN_FRAME_SIZE)
+                {
+                    g_b_bin_discard = CLI_TRUE;
+                    continue;
+                }
+
+                g_bin_frame[g_bin_length] = 0u;
+                g_bin_length++;
+            }
+
+            g_bin_code = byte;
+            g_bin_remaining = (uint8_t)(byte - 1u);
+        }
+        else if (g_bin_length < CLI_BIN_FRAME_SIZE)
+        {
+            g_bin_frame[g_bin_length] = byte;
+            g_bin_length++;
+            g_bin_remaining--;
+        }
+        else
+        {
+            g_b_bin_discard = CLI_TRUE;
+        }
+    }
+
+    *p_consumed = used;
+
+    if (CLI_BIN_RESULT_PENDING == g_bin_result)
+    {
+        return CLI_BIN_FEED_MORE;
+    }
+
+    return (CLI_BIN_RESULT_OK == g_bin_result) ? CLI_BIN_FEED_DONE
+                                               : CLI_BIN_FEED_ERROR;
+}
+
+
+/*!
+ * @brief Produce the response frame for the received request.
+ *
+ * Call once cli_bin_feed() has returned DONE or ERROR and, like
+ * cli_process_command(), again while it returns CLI_TRUE.
+ *
+ * @param[in,out] p_output Output for one response frame.
+ *
+ * @return CLI_FALSE when the response is complete, CLI_TRUE if more output pending.
+ */
+base_type
+cli_bin_process_command (cli_output_t * p_output)
+{
+    int32_t start = 0;
+    int32_t result = g_bin_result;
+    int32_t command_index = 0;
+    int8_t status = CLI_BIN_STATUS_OK;
+    size_t name_length = 0u;
+    cli_output_t payload;
+
+    if ((NULL == p_output) || (NULL == p_output->p_buffer))
+    {
+        return CLI_FALSE;
+    }
+
+    /* Too short to carry seq and id: answer with zeros */
+    if (g_bin_length < CLI_BIN_REQUEST_HEADER)
+    {
+        g_bin_frame[0] = 0u;
+        g_bin_frame[1] = 0u;
+    }
+
+    start = cli_bin_open_frame(p_output);
+
+    if (start < 0)
+    {
+        return CLI_FALSE;
+    }
+
+    if (CLI_BIN_RESULT_OK != result)
+    {
+        cli_bin_close_frame(p_output, (size_t)start, (int8_t)result);
+        return CLI_FALSE;
+    }
+
+    if (CLI_BIN_ID_LOOKUP == g_bin_frame[1])
+    {
+        command_index = (2 == g_bin_args.argc) ?
+                        cli_lookup_command(g_bin_args.argv[1], g_bin_args.arglen[1]) : -1;
+
+        /* Commands past the reserved ids have no binary id */
+        if ((command_index >= 0) && (command_index < (int32_t)CLI_BIN_ID_LOOKUP))
+        {
+            p_output->p_buffer[p_output->length] = (char)command_index;
+            p_output->length++;
+        }
+        else
+        {
+            status = CLI_BIN_STATUS_NOT_FOUND;
+        }
+
+        cli_bin_close_frame(p_output, (size_t)start, status);
+        return CLI_FALSE;
+    }
+
+    g_bin_args.argv[0] = cli_get_command_name((int32_t)g_bin_frame[1], &name_length);
+    g_bin_args.arglen[0] = (uint16_t)name_length;
+
+    if (NULL == g_bin_args.argv[0])
+    {
+        cli_bin_close_frame(p_output, (size_t)start, CLI_BIN_STATUS_NOT_FOUND);
+        return CLI_FALSE;
+    }
+
+    /* Handler payload goes straight behind the header, trailer kept free */
+    payload.p_buffer = p_output->p_buffer;
+    payload.size = p_output->size - CLI_BIN_TRAILER;
+    payload.length = p_output->length;
+
+    result = cli_execute(&g_bin_args, NULL, &payload, &g_b_bin_in_progress);
+    p_output->length = payload.length;
+
+    if (CLI_STATUS_NOT_FOUND == result)
+    {
+        status = CLI_BIN_STATUS_NOT_FOUND;
+    }
+    else if (CLI_STATUS_BAD_PARAMS == result)
+    {
+        status = CLI_BIN_STATUS_BAD_PARAMS;
+    }
+    else if (CLI_STATUS_OK != result)
+    {
+        status = CLI_BIN_STATUS_UNSUPPORTED;
+    }
+    else
+    {
+        status = (CLI_TRUE == g_b_bin_in_progress) ? CLI_BIN_STATUS_MORE
+                                                   : CLI_BIN_STATUS_OK;
+    }
+
+    cli_bin_close_frame(p_output, (size_t)start, status);
+
+    return g_b_bin_in_progress;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
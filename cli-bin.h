@@ -0,0 +1,77 @@
+/** @file cli-bin.h
+ *
+ * @brief Binary framed command mode for the CLI.
+ *
+ * Entered and left with the "proto" command ("proto bin", "proto text").
+ * Every request and response is one COBS-encoded frame terminated by a
+ * zero byte, so frames resynchronize on the next zero after line noise.
+ * Decoded, a frame is:
+ *
+ *   request:  seq | id | { len | bytes } ... | crc16 (LE)
+ *   response: seq | id | status | payload ... | crc16 (LE)
+ *
+ * seq is echoed back so a host can pipeline requests. id is the index of
+ * the command in the name-sorted command table; CLI_BIN_ID_LOOKUP with the command name
+ * as its argument returns that index as a one-byte payload. Each argument
+ * field starts with a length byte. Below CLI_BIN_FIELD_NUMBER it is the
+ * length of a byte field (up to 127) handed to the handler unchanged. With
+ * CLI_BIN_FIELD_NUMBER set, the low bits give 1 to 4 bytes of an unsigned
+ * little-endian number, which reaches the handler as decimal text, so
+ * numeric arguments need no digits on the wire and every handler parses
+ * them as usual. Results are not converted: the payload is the handler's
+ * text output as-is, and a streaming handler produces one frame per chunk
+ * with status CLI_BIN_STATUS_MORE on all but the last.
+ * The CRC is CRC-16 (crc16.h) over everything before it.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef CLI_BIN_H
+#define CLI_BIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "em-cli.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest decoded request frame in bytes */
+#ifndef CLI_BIN_FRAME_SIZE
+#define CLI_BIN_FRAME_SIZE      256u
+#endif
+
+/* Argument length byte flag: little-endian unsigned number (1..4 bytes) */
+#define CLI_BIN_FIELD_NUMBER    0x80u
+
+/* Reserved command id: resolve a command name to its id */
+#define CLI_BIN_ID_LOOKUP       0xFEu
+
+/* Response status byte */
+#define CLI_BIN_STATUS_OK         ((int8_t)0)     /* Complete */
+#define CLI_BIN_STATUS_MORE       ((int8_t)1)     /* Further frames follow */
+#define CLI_BIN_STATUS_NOT_FOUND  ((int8_t)-1)    /* No such command id */
+#define CLI_BIN_STATUS_BAD_PARAMS ((int8_t)-2)    /* Wrong argument count */
+#define CLI_BIN_STATUS_UNSUPPORTED ((int8_t)-3)   /* Raw-line handler */
+#define CLI_BIN_STATUS_CRC        ((int8_t)-4)    /* Checksum mismatch */
+#define CLI_BIN_STATUS_FRAME      ((int8_t)-5)    /* Malformed or too long */
+
+/* cli_bin_feed() results */
+#define CLI_BIN_FEED_MORE       ((int32_t)0)    /* Frame still incomplete */
+#define CLI_BIN_FEED_DONE       ((int32_t)1)    /* Frame complete and valid */
+#define CLI_BIN_FEED_ERROR      ((int32_t)-1)   /* Bad frame, reply pending */
+
+/* Public API functions */
+void cli_bin_begin(void);
+int32_t cli_bin_feed(char const * p_data, size_t len, size_t * p_consumed);
+base_type cli_bin_process_command(cli_output_t * p_output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLI_BIN_H */
+
+/*** end of file ***/
@@ -0,0 +1,285 @@
+/** @file cli-fmt.c
+ *
+ * @brief Small bounded formatter for CLI responses.
+ *
+ * Output is truncated at the buffer size and is NOT null-terminated; the
+ * return value is the number of bytes written. That matches cli_output_t,
+ * which tracks a length rather than a terminator.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include "cli-fmt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Enough digits for a 32-bit value in decimal (10) or hex (8) */
+#define CLI_FMT_DIGITS_MAX    10u
+
+static char const CLI_FMT_HEX_DIGITS[] = "0123456789abcdef";
+
+/**
+ * @brief Bounded output cursor.
+ */
+typedef struct cli_fmt_sink
+{
+    char * p_buffer;            /**< Destination */
+    size_t size;                /**< Capacity in bytes */
+    size_t length;              /**< Bytes written */
+} cli_fmt_sink_t;
+
+
+/*!
+ * @brief Append one byte if there is room.
+ */
+static void
+cli_fmt_put (cli_fmt_sink_t * p_sink, char c)
+{
+    if (p_sink->length < p_sink->size)
+    {
+        p_sink->p_buffer[p_sink->length] = c;
+        p_sink->length++;
+    }
+}
+
+
+/*!
+ * @brief Append len bytes, truncating at the capacity.
+ */
+static void
+cli_fmt_put_run (cli_fmt_sink_t * p_sink, char const * p_data, size_t len)
+{
+    while ((len > 0u) && (p_sink->length < p_sink->size))
+    {
+        p_sink->p_buffer[p_sink->length] = *p_data;
+        p_sink->length++;
+        p_data++;
+        len--;
+    }
+}
+
+
+/*!
+ * @brief Append an unsigned value in the given base, padded to width.
+ *
+ * @param[in,out] p_sink Output cursor.
+ * @param[in] value Magnitude to print.
+ * @param[in] base 10 or 16.
+ * @param[in] b_negative Prefix with '-'.
+ * @param[in] width Minimum field width.
+ * @param[in] pad '0' or ' '.
+ */
+static void
+cli_fmt_put_number (cli_fmt_sink_t * p_sink, uint32_t value, uint32_t base,
+                    uint32_t b_negative, uint32_t width, char pad)
+{
+    char digits[CLI_FMT_DIGITS_MAX];
+    uint32_t count = 0u;
+    uint32_t total = 0u;
+
+    /* Digits come out least significant first */
+    do
+    {
+        digits[count] = CLI_FMT_HEX_DIGITS[value % base];
+        count++;
+        value /= base;
+    } while (0u != value);
+
+    total = count + b_negative;
+
+    /* Sign goes before zero padding, after space padding */
+    if (b_negative && ('0' == pad))
+    {
+        cli_fmt_put(p_sink, '-');
+    }
+
+    while (width > total)
+    {
+        cli_fmt_put(p_sink, pad);
+        width--;
+    }
+
+    if (b_negative && ('0' != pad))
+    {
+        cli_fmt_put(p_sink, '-');
+    }
+
+    while (count > 0u)
+    {
+        count--;
+        cli_fmt_put(p_sink, digits[count]);
+    }
+}
+
+
+/*!
+ * @brief Format into a bounded buffer from a va_list.
+ *
+ * @param[out] p_buffer Destination (not null-terminated).
+ * @param[in] size Destination capacity.
+ * @param[in] p_format Format string (%s %.*s %c %d %u %x %%, '0' flag, width).
+ * @param[in] args Arguments matching the format.
+ *
+ * @return Number of bytes written (at most size).
+ */
+size_t
+cli_vfmt (char * p_buffer, size_t size, char const * p_format, va_list args)
+{
+    cli_fmt_sink_t sink;
+    char const * p_str = NULL;
+    char pad = ' ';
+    uint32_t width = 0u;
+    int32_t precision = -1;
+    int32_t signed_value = 0;
+    size_t str_len = 0u;
+
+    sink.p_buffer = p_buffer;
+    sink.size = (NULL != p_buffer) ? size : 0u;
+    sink.length = 0u;
+
+    if (NULL == p_format)
+    {
+        return 0u;
+    }
+
+    while ('\0' != *p_format)
+    {
+        if ('%' != *p_format)
+        {
+            cli_fmt_put(&sink, *p_format);
+            p_format++;
+            continue;
+        }
+
+        p_format++;
+        pad = ' ';
+        width = 0u;
+        precision = -1;
+
+        if ('0' == *p_format)
+        {
+            pad = '0';
+            p_format++;
+        }
+
+        while ((*p_format >= '0') && (*p_format <= '9'))
+        {
+            width = (width * 10u) + (uint32_t)(*p_format - '0');
+            p_format++;
+        }
+
+        /* Only the ".*" precision form is supported, for length strings */
+        if (('.' == p_format[0]) && ('*' == p_format[1]))
+        {
+            precision = (int32_t)va_arg(args, int);
+            p_format += 2;
+        }
+
+        switch (*p_format)
+        {
+            case 's':
+            {
+                p_str = va_arg(args, char const *);
+
+                if (NULL == p_str)
+                {
+                    p_str = "(null)";
+                }
+
+                /* Bounded by the precision, so the text need not be terminated */
+                for (str_len = 0u;
+                     ((precision < 0) || (str_len < (size_t)precision)) &&
+                     ('\0' != p_str[str_len]);
+                     str_len++)
+                {
+                }
+
+                cli_fmt_put_run(&sink, p_str, str_len);
+                break;
+            }
+
+            case 'c':
+            {
+                cli_fmt_put(&sink, (char)va_arg(args, int));
+                break;
+            }
+
+            case 'd':
+            {
+                signed_value = (int32_t)va_arg(args, int);
+
+                /* Negate in unsigned arithmetic so INT32_MIN is safe */
+                cli_fmt_put_number(&sink,
+                                   (signed_value < 0) ? (0u - (uint32_t)signed_value)
+                                                      : (uint32_t)signed_value,
+                                   10u, (signed_value < 0) ? 1u : 0u, width, pad);
+                break;
+            }
+
+            case 'u':
+            {
+                cli_fmt_put_number(&sink, (uint32_t)va_arg(args, unsigned int),
+                                   10u, 0u, width, pad);
+                break;
+            }
+
+            case 'x':
+            {
+                cli_fmt_put_number(&sink, (uint32_t)va_arg(args, unsigned int),
+                                   16u, 0u, width, pad);
+                break;
+            }
+
+            case '%':
+            {
+                cli_fmt_put(&sink, '%');
+                break;
+            }
+
+            default:
+            {
+                /* Unsupported conversion - stop rather than misread args */
+                return sink.length;
+            }
+        }
+
+        p_format++;
+    }
+
+    return sink.length;
+}
+
+
+/*!
+ * @brief Format into a bounded buffer.
+ *
+ * @param[out] p_buffer Destination (not null-terminated).
+ * @param[in] size Destination capacity.
+ * @param[in] p_format Format string, see cli_vfmt().
+ *
+ * @return Number of bytes written (at most size).
+ */
+size_t
+cli_fmt (char * p_buffer, size_t size, char const * p_format, ...)
+{
+    va_list args;
+    size_t length = 0u;
+
+    va_start(args, p_format);
+    length = cli_vfmt(p_buffer, size, p_format, args);
+    va_end(args);
+
+    return length;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
@@ -0,0 +1,36 @@
+/** @file cli-fmt.h
+ *
+ * @brief Small bounded formatter for CLI responses.
+ *
+ * Replaces newlib's printf family in the command handlers. Supports only
+ * what responses need: %s, %.*s, %c, %d, %u, %x and %%, with an optional
+ * '0' flag and field width for the integer conversions. Integer arguments
+ * are 32-bit (int / unsigned int on Cortex-M0+). Reentrant, no heap, and a
+ * fixed small stack footprint.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef CLI_FMT_H
+#define CLI_FMT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Public API functions */
+size_t cli_fmt(char * p_buffer, size_t size, char const * p_format, ...);
+size_t cli_vfmt(char * p_buffer, size_t size, char const * p_format, va_list args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLI_FMT_H */
+
+/*** end of file ***/
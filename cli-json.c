@@ -0,0 +1,477 @@
+/** @file cli-json.c
+ *
+ * @brief JSON command mode for the CLI.
+ *
+ * Request bytes are appended to a document buffer and jsmn resumes from
+ * its saved position after every chunk, using a statically sized token
+ * pool. Input is fed up to each closing brace at a time, so the parser
+ * notices the end of the document before it sees any byte that follows.
+ *
+ * The finished token list is mapped onto a cli_args_t view that points
+ * into the document, so the registered handlers run unchanged. Member
+ * values are passed as they appear in the document; JSON escape sequences
+ * inside strings are not decoded.
+ *
+ * The handler formats its text response in place, right behind the JSON
+ * prefix, and the text is then escaped backwards in place, so no second
+ * buffer is needed. Handlers get half the room left for the text, so even
+ * a chunk that escapes every byte fits whole.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "cli-json.h"
+#include "startup.h"
+#include "arena.h"
+#include "jsmn.h"
+#include "jsmn-path.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(JSMN_COMPACT_TOKENS) && (CLI_JSON_DOCUMENT_SIZE > JSMN_MAX_DOCUMENT_SIZE)
+#error "CLI_JSON_DOCUMENT_SIZE exceeds the compact jsmn token range"
+#endif
+
+/* Response framing */
+static char const CLI_JSON_OK_PREFIX[] = "{\"ok\":true,\"out\":\"";
+static char const CLI_JSON_MORE_PREFIX[] = "{\"ok\":true,\"more\":true,\"out\":\"";
+static char const CLI_JSON_OK_SUFFIX[] = "\"}\r\n";
+
+/* Error responses */
+static char const CLI_JSON_ERR_PARSE[] = "{\"ok\":false,\"error\":\"invalid json\"}\r\n";
+static char const CLI_JSON_ERR_NO_CMD[] = "{\"ok\":false,\"error\":\"missing cmd\"}\r\n";
+static char const CLI_JSON_ERR_VALUE[] = "{\"ok\":false,\"error\":\"unsupported value\"}\r\n";
+static char const CLI_JSON_ERR_NOT_FOUND[] = "{\"ok\":false,\"error\":\"unknown command\"}\r\n";
+static char const CLI_JSON_ERR_PARAMS[] = "{\"ok\":false,\"error\":\"bad parameters\"}\r\n";
+static char const CLI_JSON_ERR_TOO_LARGE[] = "{\"ok\":false,\"error\":\"request too large\"}\r\n";
+
+/* Member holding the command word, found by jsmn_path_extract() */
+typedef struct cli_json_request
+{
+    jsmn_path_string_t cmd;
+} cli_json_request_t;
+
+static jsmn_path_field_t const g_json_request_fields[] = {
+    { "cmd", JSMN_PATH_STRING, offsetof(cli_json_request_t, cmd) },
+};
+
+/* Parse result codes */
+#define CLI_JSON_PARSE_OK       0
+#define CLI_JSON_PARSE_INVALID  (-1)
+#define CLI_JSON_PARSE_NO_CMD   (-2)
+#define CLI_JSON_PARSE_VALUE    (-3)
+#define CLI_JSON_PARSE_TOO_LARGE (-4)
+#define CLI_JSON_PARSE_PENDING  (-5)    /* Document still arriving */
+
+/* Request document and the resumable parser working on it */
+static char g_json_document[CLI_JSON_DOCUMENT_SIZE] STARTUP_NOINIT;
+static size_t g_json_length = 0u;
+static jsmn_parser_t g_json_parser;
+static int32_t g_json_result = CLI_JSON_PARSE_PENDING;
+
+/* Token pool and argv view, kept across continuation calls */
+static arena_pool_t g_json_token_pool;
+static jsmntok_t * g_json_tokens = NULL;    /* Carved by cli_json_init() */
+static cli_args_t g_json_args;
+static base_type g_b_json_in_progress = CLI_FALSE;
+
+
+/*!
+ * @brief Map a parsed JSON request onto the argv view.
+ *
+ * @param[in] p_document Request text the tokens refer to.
+ * @param[in] token_count Tokens produced by jsmn.
+ * @param[out] p_args View to fill: cmd first, other values in order.
+ *
+ * @return CLI_JSON_PARSE_OK or a CLI_JSON_PARSE_* error.
+ */
+static int32_t
+cli_json_map_args (char const * p_document, int32_t token_count,
+                   cli_args_t * p_args)
+{
+    int32_t index = 0;
+    int32_t argc = 1;
+    int32_t found = 0;
+    jsmntok_t const * p_name = NULL;
+    jsmntok_t const * p_value = NULL;
+    cli_json_request_t request;
+
+    if ((token_count < 1) || (JSMN_OBJECT != g_json_tokens[0].type))
+    {
+        return CLI_JSON_PARSE_INVALID;
+    }
+
+    found = jsmn_path_extract(p_document, g_json_tokens, token_count,
+                              g_json_request_fields,
+                              (uint32_t)(sizeof(g_json_request_fields) /
+                                         sizeof(g_json_request_fields[0])),
+                              &request);
+
+    if (found <= 0)
+    {
+        /* Reported once the members are known to be flat */
+        request.cmd.p_data = NULL;
+    }
+
+    /* Flat object: members are name/value token pairs after the object */
+    for (index = 1; (index + 1) < token_count; index += 2)
+    {
+        p_name = &g_json_tokens[index];
+        p_value = &g_json_tokens[index + 1];
+
+        if ((JSMN_STRING != p_name->type) ||
+            ((JSMN_STRING != p_value->type) && (JSMN_PRIMITIVE != p_value->type)))
+        {
+            return CLI_JSON_PARSE_VALUE;
+        }
+
+        if (&p_document[p_value->start] == request.cmd.p_data)
+        {
+            /* The command word, already in argv[0] */
+        }
+        else if ((uint32_t)argc < CLI_MAX_ARGS)
+        {
+            p_args->argv[argc] = &p_document[p_value->start];
+            p_args->arglen[argc] = (uint16_t)(p_value->end - p_value->start);
+            argc++;
+        }
+        else
+        {
+            return CLI_JSON_PARSE_VALUE;
+        }
+    }
+
+    if (NULL == request.cmd.p_data)
+    {
+        return CLI_JSON_PARSE_NO_CMD;
+    }
+
+    p_args->argv[0] = request.cmd.p_data;
+    p_args->arglen[0] = request.cmd.length;
+    p_args->argc = argc;
+
+    return CLI_JSON_PARSE_OK;
+}
+
+
+/*!
+ * @brief Get the escape letter for a character that needs one in JSON.
+ *
+ * @param[in] c Character from the response text.
+ *
+ * @return Letter to follow the backslash, or '\0' if c is copied as is.
+ */
+static char
+cli_json_escape_char (char c)
+{
+    char escape = '\0';
+
+    switch (c)
+    {
+        case '"':  escape = '"';  break;
+        case '\\': escape = '\\'; break;
+        case '\r': escape = 'r';  break;
+        case '\n': escape = 'n';  break;
+        case '\t': escape = 't';  break;
+        default:   break;
+    }
+
+    return escape;
+}
+
+
+/*!
+ * @brief Escape output text in place for use inside a JSON string.
+ *
+ * The text at p_output->p_buffer[start .. length) is expanded backwards so
+ * reads always stay ahead of writes. Text that would not fit in limit
+ * bytes once escaped is dropped from the end.
+ *
+ * @param[in,out] p_output Output holding the raw text.
+ * @param[in] start Offset of the raw text.
+ * @param[in] limit Highest output length allowed after escaping.
+ */
+static void
+cli_json_escape_in_place (cli_output_t * p_output, size_t start, size_t limit)
+{
+    char * p_buffer = p_output->p_buffer;
+    size_t read = start;
+    size_t escaped = start;
+    size_t write = 0u;
+    char c = '\0';
+
+    /* Measure, dropping characters that would overflow once escaped */
+    while (read < p_output->length)
+    {
+        write = ('\0' != cli_json_escape_char(p_buffer[read])) ? 2u : 1u;
+
+        if ((escaped + write) > limit)
+        {
+            break;
+        }
+
+        escaped += write;
+        read++;
+    }
+
+    /* Expand from the end towards the front */
+    write = escaped;
+
+    while (read > start)
+    {
+        read--;
+        c = p_buffer[read];
+
+        if ('\0' != cli_json_escape_char(c))
+        {
+            write -= 2u;
+            p_buffer[write + 1u] = cli_json_escape_char(c);
+            p_buffer[write] = '\\';
+        }
+        else
+        {
+            /* Other control characters cannot appear raw in JSON */
+            write--;
+            p_buffer[write] = ((unsigned char)c < 0x20u) ? ' ' : c;
+        }
+    }
+
+    p_output->length = escaped;
+}
+
+
+/*!
+ * @brief Carve the token pool from the arena.
+ *
+ * @return 0 on success, -1 if the arena is too small (every request is
+ *         then refused as too large).
+ */
+int32_t
+cli_json_init (void)
+{
+    g_json_tokens = (jsmntok_t *)arena_pool_init(&g_json_token_pool, "json-tokens",
+                                                 (uint32_t)sizeof(jsmntok_t),
+                                                 CLI_JSON_MAX_TOKENS);
+    cli_json_begin();
+
+    return (NULL == g_json_tokens) ? -1 : 0;
+}
+
+
+/*!
+ * @brief Start receiving a new JSON request.
+ */
+void
+cli_json_begin (void)
+{
+    jsmn_init(&g_json_parser);
+    g_json_length = 0u;
+    g_json_result = CLI_JSON_PARSE_PENDING;
+    g_b_json_in_progress = CLI_FALSE;
+}
+
+
+/*!
+ * @brief Feed received bytes into the request parser.
+ *
+ * Consumes bytes only up to the end of the request, so anything that
+ * follows stays with the caller. Parsing resumes where the previous chunk
+ * stopped; a string or primitive split across chunks is re-scanned from
+ * its start once more bytes are available.
+ *
+ * @param[in] p_data Received bytes.
+ * @param[in] len Number of bytes offered.
+ * @param[out] p_consumed Number of bytes taken from p_data.
+ *
+ * @return CLI_JSON_FEED_MORE, CLI_JSON_FEED_DONE or CLI_JSON_FEED_ERROR;
+ *         after DONE or ERROR call cli_json_process_command() for the reply.
+ */
+int32_t
+cli_json_feed (char const * p_data, size_t len, size_t * p_consumed)
+{
+    size_t used = 0u;
+    size_t run = 0u;
+    int32_t token_count = 0;
+
+    *p_consumed = 0u;
+
+    if (NULL == g_json_tokens)
+    {
+        g_json_result = CLI_JSON_PARSE_TOO_LARGE;
+    }
+
+    while ((CLI_JSON_PARSE_PENDING == g_json_result) && (used < len))
+    {
+        /* Take bytes through the next closing brace, or all of them */
+        run = 0u;
+
+        while (((used + run) < len) && ('}' != p_data[used + run]))
+        {
+            run++;
+        }
+
+        if ((used + run) < len)
+        {
+            run++;
+        }
+
+        if ((g_json_length + run) > CLI_JSON_DOCUMENT_SIZE)
+        {
+            g_json_result = CLI_JSON_PARSE_TOO_LARGE;
+            break;
+        }
+
+        (void)memcpy(&g_json_document[g_json_length], &p_data[used], run);
+        g_json_length += run;
+        used += run;
+
+        token_count = jsmn_parse(&g_json_parser, g_json_document, g_json_length,
+                                 g_json_tokens, CLI_JSON_MAX_TOKENS);
+
+        if (JSMN_ERROR_PART == token_count)
+        {
+            continue;
+        }
+
+        if ((token_count < 0) || (JSMN_OFFSET_UNSET == g_json_tokens[0].end))
+        {
+            g_json_result = CLI_JSON_PARSE_INVALID;
+        }
+        else
+        {
+            arena_pool_use(&g_json_token_pool, (uint32_t)token_count);
+            g_json_result = cli_json_map_args(g_json_document, token_count,
+                                              &g_json_args);
+        }
+    }
+
+    *p_consumed = used;
+
+    if (CLI_JSON_PARSE_PENDING == g_json_result)
+    {
+        return CLI_JSON_FEED_MORE;
+    }
+
+    return (CLI_JSON_PARSE_OK == g_json_result) ? CLI_JSON_FEED_DONE
+                                                : CLI_JSON_FEED_ERROR;
+}
+
+
+/*!
+ * @brief Produce the JSON response chunk for the received request.
+ *
+ * Call once cli_json_feed() has returned DONE or ERROR and, like
+ * cli_process_command(), again while it returns CLI_TRUE.
+ *
+ * @param[in,out] p_output Output for one response object.
+ *
+ * @return CLI_FALSE when the response is complete, CLI_TRUE if more output pending.
+ */
+base_type
+cli_json_process_command (cli_output_t * p_output)
+{
+    int32_t result = g_json_result;
+    size_t start = 0u;
+    size_t limit = 0u;
+    cli_output_t text;
+
+    if ((NULL == p_output) || (NULL == p_output->p_buffer))
+    {
+        return CLI_FALSE;
+    }
+
+    if (CLI_JSON_PARSE_OK != result)
+    {
+        if (CLI_JSON_PARSE_NO_CMD == result)
+        {
+            cli_output_write(p_output, CLI_JSON_ERR_NO_CMD,
+                             sizeof(CLI_JSON_ERR_NO_CMD) - 1u);
+        }
+        else if (CLI_JSON_PARSE_VALUE == result)
+        {
+            cli_output_write(p_output, CLI_JSON_ERR_VALUE,
+                             sizeof(CLI_JSON_ERR_VALUE) - 1u);
+        }
+        else if (CLI_JSON_PARSE_TOO_LARGE == result)
+        {
+            cli_output_write(p_output, CLI_JSON_ERR_TOO_LARGE,
+                             sizeof(CLI_JSON_ERR_TOO_LARGE) - 1u);
+        }
+        else
+        {
+            cli_output_write(p_output, CLI_JSON_ERR_PARSE,
+                             sizeof(CLI_JSON_ERR_PARSE) - 1u);
+        }
+
+        return CLI_FALSE;
+    }
+
+    /* Handler writes its text behind the longest prefix, before the suffix */
+    start = p_output->length + (sizeof(CLI_JSON_MORE_PREFIX) - 1u);
+    limit = p_output->size - (sizeof(CLI_JSON_OK_SUFFIX) - 1u);
+
+    if (start >= limit)
+    {
+        return CLI_FALSE;
+    }
+
+    /* At most half the room: escaping can double every byte and a handler
+       that fills its chunk has already moved its resume state past it */
+    text.p_buffer = p_output->p_buffer;
+    text.size = start + ((limit - start) / 2u);
+    text.length = start;
+
+    result = cli_execute(&g_json_args, NULL, &text, &g_b_json_in_progress);
+
+    if (CLI_STATUS_OK != result)
+    {
+        if (CLI_STATUS_NOT_FOUND == result)
+        {
+            cli_output_write(p_output, CLI_JSON_ERR_NOT_FOUND,
+                             sizeof(CLI_JSON_ERR_NOT_FOUND) - 1u);
+        }
+        else
+        {
+            cli_output_write(p_output, CLI_JSON_ERR_PARAMS,
+                             sizeof(CLI_JSON_ERR_PARAMS) - 1u);
+        }
+
+        return CLI_FALSE;
+    }
+
+    /* Frame the response: prefix, escaped text, suffix */
+    if (CLI_TRUE == g_b_json_in_progress)
+    {
+        cli_output_write(p_output, CLI_JSON_MORE_PREFIX,
+                         sizeof(CLI_JSON_MORE_PREFIX) - 1u);
+    }
+    else
+    {
+        cli_output_write(p_output, CLI_JSON_OK_PREFIX,
+                         sizeof(CLI_JSON_OK_PREFIX) - 1u);
+    }
+
+    (void)memmove(&p_output->p_buffer[p_output->length], &text.p_buffer[start],
+                  text.length - start);
+    text.length = p_output->length + (text.length - start);
+    start = p_output->length;
+
+    cli_json_escape_in_place(&text, start, limit);
+    p_output->length = text.length;
+
+    cli_output_write(p_output, CLI_JSON_OK_SUFFIX, sizeof(CLI_JSON_OK_SUFFIX) - 1u);
+
+    return g_b_json_in_progress;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
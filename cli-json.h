@@ -0,0 +1,66 @@
+/** @file cli-json.h
+ *
+ * @brief JSON command mode for the CLI.
+ *
+ * A line starting with '{' is parsed with jsmn and dispatched to the same
+ * registered handlers as text commands:
+ *
+ *   {"cmd":"set","key":"led","val":"on"}   ->  argv = set led on
+ *
+ * "cmd" becomes argv[0], every other member value becomes the next argv
+ * entry in document order (member names are not interpreted). Values must
+ * be strings or primitives. Responses come back as one JSON object per
+ * line:
+ *
+ *   {"ok":true,"out":"Set led = on\r\n"}
+ *   {"ok":false,"error":"unknown command"}
+ *
+ * A streaming handler produces one object per chunk, with "more":true on
+ * every object but the last.
+ *
+ * Requests are not limited to the text line buffer: bytes are fed into the
+ * parser as they arrive (cli_json_feed) and parsing resumes where the last
+ * chunk ended, so it overlaps with reception. The request is complete when
+ * its top-level object closes; no line terminator is needed.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef CLI_JSON_H
+#define CLI_JSON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "em-cli.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Token pool: the object plus a name and a value per argv entry */
+#define CLI_JSON_MAX_TOKENS   (1u + (2u * CLI_MAX_ARGS))
+
+/* Largest request document in bytes */
+#ifndef CLI_JSON_DOCUMENT_SIZE
+#define CLI_JSON_DOCUMENT_SIZE  512u
+#endif
+
+/* cli_json_feed() results */
+#define CLI_JSON_FEED_MORE    ((int32_t)0)    /* Document still incomplete */
+#define CLI_JSON_FEED_DONE    ((int32_t)1)    /* Document complete and valid */
+#define CLI_JSON_FEED_ERROR   ((int32_t)-1)   /* Invalid or too large */
+
+/* Public API functions */
+int32_t cli_json_init(void);
+void cli_json_begin(void);
+int32_t cli_json_feed(char const * p_data, size_t len, size_t * p_consumed);
+base_type cli_json_process_command(cli_output_t * p_output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLI_JSON_H */
+
+/*** end of file ***/
@@ -0,0 +1,163 @@
+/** @file clock.c
+ *
+ * @brief STM32G071 system clock setup.
+ *
+ * Raises the flash wait states before switching SYSCLK up to the PLL, as
+ * RM0444 requires. If the PLL does not lock the core simply stays on
+ * HSI16 and clock_get_hz() keeps reporting that frequency, so baud rate
+ * divisors computed from it remain correct.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include "clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Register bit position constants */
+#define RCC_CR_PLLON_BIT           24u
+#define RCC_CR_PLLRDY_BIT          25u
+#define RCC_CFGR_SW_MASK           0x7u
+#define RCC_CFGR_SW_PLLRCLK        0x2u
+#define RCC_CFGR_SWS_SHIFT         3u
+#define RCC_PLLCFGR_SRC_HSI16      0x2u
+#define RCC_PLLCFGR_M_SHIFT        4u
+#define RCC_PLLCFGR_N_SHIFT        8u
+#define RCC_PLLCFGR_REN_BIT        28u
+#define RCC_PLLCFGR_R_SHIFT        29u
+#define FLASH_ACR_LATENCY_MASK     0x7u
+#define FLASH_ACR_PRFTEN_BIT       8u
+#define FLASH_ACR_ICEN_BIT         9u
+
+/* 64 MHz: VCO = 16 MHz / M(1) * N(8) = 128 MHz, R = 2 */
+#define CLOCK_PLL_M                1u
+#define CLOCK_PLL_N                8u
+#define CLOCK_PLL_R                2u
+
+/* Flash wait states for 48 < HCLK <= 64 MHz in voltage range 1 */
+#define CLOCK_FLASH_LATENCY        2u
+
+/* Bounded wait for PLL lock and clock switch */
+#define CLOCK_READY_TIMEOUT        100000u
+
+/* Defining RCC and FLASH Registers used  */
+/*
+
+RCC_CR --> At an Offset of 0x00
+RCC_CFGR --> At an Offset of 0x08
+RCC_PLLCFGR --> At an Offset of 0x0C
+FLASH_ACR --> At an Offset of 0x00 from FLASH base
+
+*/
+/* const: the pointers live in flash, usable before .data is copied */
+volatile uint32_t * const RCC_CR = (uint32_t *) 0x40021000;
+volatile uint32_t * const RCC_CFGR = (uint32_t *) 0x40021008;
+volatile uint32_t * const RCC_PLLCFGR = (uint32_t *) 0x4002100C;
+volatile uint32_t * const FLASH_ACR = (uint32_t *) 0x40022000;
+
+/* Current SYSCLK = HCLK = PCLK frequency */
+static uint32_t g_clock_hz = CLOCK_HSI16_HZ;
+
+
+/*!
+ * @brief Switch SYSCLK from HSI16 to the PLL at 64 MHz.
+ *
+ * Safe to call before .data is initialized and again afterwards: the
+ * switch state is taken from RCC, not from memory.
+ *
+ * @return 0 on success, -1 if the PLL did not lock or the switch timed
+ *         out (the core then stays on HSI16).
+ */
+int32_t
+clock_init (void)
+{
+    uint32_t timeout = CLOCK_READY_TIMEOUT;
+
+    /* Already switched (Reset_Handler runs this before .data is copied) */
+    if (((*RCC_CFGR >> RCC_CFGR_SWS_SHIFT) & RCC_CFGR_SW_MASK) == RCC_CFGR_SW_PLLRCLK)
+    {
+        g_clock_hz = CLOCK_PLL_HZ;
+        return 0;
+    }
+
+    /* Configure and lock the PLL while SYSCLK still runs from HSI16 (also
+       after a STOP wakeup, so a failure below leaves the rate right) */
+    g_clock_hz = CLOCK_HSI16_HZ;
+    *RCC_CR &= ~(1u << RCC_CR_PLLON_BIT);
+
+    while (((*RCC_CR & (1u << RCC_CR_PLLRDY_BIT)) != 0u) && (0u != timeout))
+    {
+        timeout--;
+    }
+
+    *RCC_PLLCFGR = (RCC_PLLCFGR_SRC_HSI16 |
+                    ((CLOCK_PLL_M - 1u) << RCC_PLLCFGR_M_SHIFT) |
+                    (CLOCK_PLL_N << RCC_PLLCFGR_N_SHIFT) |
+                    (1u << RCC_PLLCFGR_REN_BIT) |
+                    ((CLOCK_PLL_R - 1u) << RCC_PLLCFGR_R_SHIFT));
+    *RCC_CR |= (1u << RCC_CR_PLLON_BIT);
+
+    timeout = CLOCK_READY_TIMEOUT;
+
+    while (((*RCC_CR & (1u << RCC_CR_PLLRDY_BIT)) == 0u) && (0u != timeout))
+    {
+        timeout--;
+    }
+
+    if (0u == timeout)
+    {
+        return -1;
+    }
+
+    /* More wait states first; the new latency must be read back */
+    *FLASH_ACR = (*FLASH_ACR & ~FLASH_ACR_LATENCY_MASK) |
+                 CLOCK_FLASH_LATENCY |
+                 (1u << FLASH_ACR_PRFTEN_BIT) |
+                 (1u << FLASH_ACR_ICEN_BIT);
+
+    while ((*FLASH_ACR & FLASH_ACR_LATENCY_MASK) != CLOCK_FLASH_LATENCY)
+    {
+        /* Takes effect within a few cycles */
+    }
+
+    *RCC_CFGR = (*RCC_CFGR & ~RCC_CFGR_SW_MASK) | RCC_CFGR_SW_PLLRCLK;
+
+    timeout = CLOCK_READY_TIMEOUT;
+
+    while ((((*RCC_CFGR >> RCC_CFGR_SWS_SHIFT) & RCC_CFGR_SW_MASK) != RCC_CFGR_SW_PLLRCLK) &&
+           (0u != timeout))
+    {
+        timeout--;
+    }
+
+    if (0u == timeout)
+    {
+        return -1;
+    }
+
+    g_clock_hz = CLOCK_PLL_HZ;
+
+    return 0;
+}
+
+
+/*!
+ * @brief Current system clock frequency.
+ *
+ * @return SYSCLK in Hz (HCLK and PCLK run at the same frequency).
+ */
+uint32_t
+clock_get_hz (void)
+{
+    return g_clock_hz;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
@@ -0,0 +1,35 @@
+/** @file clock.h
+ *
+ * @brief STM32G071 system clock setup.
+ *
+ * Runs SYSCLK from the PLL at 64 MHz (HSI16 / 1 * 8 / 2) with AHB and APB
+ * undivided, so the USART kernel clock (PCLK) is 64 MHz as well.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Clock frequencies */
+#define CLOCK_HSI16_HZ         16000000u
+#define CLOCK_PLL_HZ           64000000u
+
+/* Public API functions */
+int32_t clock_init(void);
+uint32_t clock_get_hz(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOCK_H */
+
+/*** end of file ***/
@@ -0,0 +1,58 @@
+/** @file crc16.c
+ *
+ * @brief CRC-16/CCITT-FALSE checksum (poly 0x1021, init 0xFFFF).
+ *
+ * Nibble-wise table: 32 bytes of flash instead of 512 for a full table,
+ * at two lookups per byte.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crc16.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CRC of each 4-bit value, poly 0x1021 */
+static uint16_t const g_crc16_nibble_table[16] = {
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu
+};
+
+
+/*!
+ * @brief Continue a CRC over more data.
+ *
+ * @param[in] crc Running CRC (CRC16_INIT for a new checksum).
+ * @param[in] p_data Data to add.
+ * @param[in] len Number of bytes.
+ *
+ * @return Updated CRC.
+ */
+uint16_t
+crc16_update (uint16_t crc, void const * p_data, size_t len)
+{
+    uint8_t const * p_byte = (uint8_t const *)p_data;
+
+    while (len > 0u)
+    {
+        crc = (uint16_t)((crc << 4) ^
+                         g_crc16_nibble_table[((crc >> 12) ^ (*p_byte >> 4)) & 0x0Fu]);
+        crc = (uint16_t)((crc << 4) ^
+                         g_crc16_nibble_table[((crc >> 12) ^ (*p_byte & 0x0Fu)) & 0x0Fu]);
+        p_byte++;
+        len--;
+    }
+
+    return crc;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
@@ -0,0 +1,31 @@
+/** @file crc16.h
+ *
+ * @brief CRC-16/CCITT-FALSE checksum for stored and framed data.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Initial value for a new checksum */
+#define CRC16_INIT            0xFFFFu
+
+/* Public API functions */
+uint16_t crc16_update(uint16_t crc, void const * p_data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRC16_H */
+
+/*** end of file ***/
@@ -10,8 +10,11 @@
  */
 
 #include "em-cli.h"
+#include "kv-store.h"
+#include "cli-fmt.h"
+#include "prof.h"
 #include <string.h>
-#include <stdio.h>
+#include <stdarg.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +27,8 @@ static char const CLI_MSG_NOT_RECOGNIZED[] =
     "Command not recognized. Enter 'help' to view commands.\r\n\r\n";
 static char const CLI_MSG_HELP_HEADER[] = "Available commands:\r\n";
 static char const CLI_MSG_MISSING_PARAM[] = "Error: Missing parameter\r\n";
+static char const CLI_MSG_STORE_FULL[] = "Error: Key-value store full\r\n";
+static char const CLI_MSG_INVALID_PAIR[] = "Error: Key or value too long\r\n";
 
 /* Character constants for parsing */
 #define CHAR_SPACE          ' '
@@ -31,211 +36,533 @@ static char const CLI_MSG_MISSING_PARAM[] = "Error: Missing parameter\r\n";
 #define CHAR_CARRIAGE_RET   '\r'
 #define CHAR_NEWLINE        '\n'
 
-/* Command registry globals */
-cli_command_definition_t g_commands_array[CLI_MAX_COMMANDS];
-int32_t g_command_count = 0;
-char g_cli_write_buffer[CLI_WRITE_BUFFER_SIZE];
-
-/* Built-in command definitions */
-const cli_command_definition_t g_help_command = {
-    "help",
-    "\r\nhelp:\r\nLists all registered commands\r\n",
-    cli_help_interpreter,
-    -1
-};
-
-const cli_command_definition_t g_set_command = {
-    "set",
-    "\r\nset <key> <value>:\r\nSets a key-value pair\r\n",
-    cli_set_interpreter,
-    2
-};
-
-const cli_command_definition_t g_get_command = {
-    "get",
-    "\r\nget <key>:\r\nGets a value by key\r\n",
-    cli_get_interpreter,
-    1
-};
+/* Marker for "no command matched / in progress" */
+#define CLI_NO_COMMAND      (-1)
+
+/* Command table, sorted by name: the linked .cli_cmds section by default */
+#if (CLI_LINKER_TABLE != 0u)
+extern cli_command_definition_t const __cli_cmds_start[];
+extern cli_command_definition_t const __cli_cmds_end[];
+
+static cli_command_definition_t const * g_p_commands = __cli_cmds_start;
+static cli_command_definition_t const * g_p_commands_end = __cli_cmds_end;
+#else
+static cli_command_definition_t const * g_p_commands = NULL;
+static cli_command_definition_t const * g_p_commands_end = NULL;
+#endif
+
+/* Command whose response is still streaming, and the abort request for it */
+static int32_t g_active_command = CLI_NO_COMMAND;
+static volatile base_type g_b_cancel = CLI_FALSE;
+
+/* Built-in commands */
+CLI_COMMAND(help, "\r\nhelp:\r\nLists all registered commands\r\n",
+            NULL, -1, cli_help_interpreter);
+
+CLI_COMMAND(set, "\r\nset <key> <value>:\r\nSets a key-value pair\r\n",
+            NULL, 2, cli_set_interpreter);
+
+CLI_COMMAND(get, "\r\nget <key>:\r\nGets a value by key\r\n",
+            NULL, 1, cli_get_interpreter);
 
 
 /*!
- * @brief Register a new command in the CLI system.
+ * @brief Compare a length-delimited name with a command name.
  *
- * @param[in] p_command_to_register Pointer to command definition structure.
+ * Orders like strcmp(), which is also how the linker sorts the table, so
+ * no name lengths need storing: the command name's terminator ends it.
  *
- * @return CLI_TRUE on success, CLI_FALSE if registry is full or NULL pointer.
+ * @param[in] p_name Name to compare (not necessarily null-terminated).
+ * @param[in] name_length Length of p_name.
+ * @param[in] p_command Null-terminated command name.
+ *
+ * @return <0, 0 or >0 like strcmp().
  */
-base_type
-cli_register_command (cli_command_definition_t const * const p_command_to_register)
+static int32_t
+cli_compare_command (char const * p_name, size_t name_length,
+                     char const * p_command)
 {
-    base_type is_registered = CLI_FALSE;
+    size_t i = 0u;
+    int32_t result = 0;
 
-    if ((NULL != p_command_to_register) &&
-        (g_command_count < CLI_MAX_COMMANDS))
+    for (i = 0u; i < name_length; i++)
     {
-        g_commands_array[g_command_count] = *p_command_to_register;
-        g_command_count++;
-        is_registered = CLI_TRUE;
+        /* A shorter command name reads as its terminator here */
+        result = (int32_t)(uint8_t)p_name[i] - (int32_t)(uint8_t)p_command[i];
+
+        if ((0 != result) || (CHAR_NULL == p_command[i]))
+        {
+            return (0 != result) ? result : 1;
+        }
     }
 
-    return is_registered;
+    return (CHAR_NULL == p_command[name_length]) ? 0 : -1;
 }
 
 
 /*!
- * @brief Process a received command string.
+ * @brief Binary search the command table for a command name.
  *
- * Parses command input, validates parameters, and calls registered handler.
+ * @param[in] p_name Name to look up (not necessarily null-terminated).
+ * @param[in] name_length Length of p_name.
  *
- * @param[in] p_command_input Pointer to null-terminated command string.
- * @param[out] p_write_buffer Buffer for command response output.
- * @param[in] write_buffer_len Size of write buffer in bytes.
+ * @return Table index of the command, or CLI_NO_COMMAND.
+ */
+static int32_t
+cli_find_command (char const * p_name, size_t name_length)
+{
+    int32_t low = 0;
+    int32_t high = (int32_t)(g_p_commands_end - g_p_commands);
+    int32_t middle = 0;
+    int32_t result = 0;
+
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        result = cli_compare_command(p_name, name_length,
+                                     g_p_commands[middle].p_command);
+
+        if (0 == result)
+        {
+            return middle;
+        }
+        else if (result < 0)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+
+    return CLI_NO_COMMAND;
+}
+
+
+/*!
+ * @brief Dispatch from a caller-built command table instead.
  *
- * @return CLI_FALSE when command processing is complete, CLI_TRUE if more output pending.
+ * For builds without the linker section (host tools). The table is used
+ * in place, so it must stay valid while commands run.
+ *
+ * @param[in] p_table Commands sorted by name (strcmp() order).
+ * @param[in] count Number of commands.
+ *
+ * @return CLI_TRUE if the table was taken, CLI_FALSE on a NULL entry, an
+ *         entry without a handler, or names out of order or repeated.
  */
 base_type
-cli_process_command (char const * const p_command_input,
-                     char * p_write_buffer,
-                     size_t write_buffer_len)
+cli_set_command_table (cli_command_definition_t const * p_table, uint32_t count)
 {
-    base_type is_processed = CLI_PASS;
-    char const * p_registered_command = NULL;
-    base_type command_length = 0;
-    static int32_t command_index = 0;
-    base_type param_count = 0;
+    uint32_t i = 0u;
 
-    if ((NULL == p_command_input) || (NULL == p_write_buffer))
+    if ((NULL == p_table) && (0u != count))
     {
         return CLI_FALSE;
     }
 
-    /* Search for matching command on first call */
-    if (0 == command_index)
+    for (i = 0u; i < count; i++)
     {
-        for (command_index = 0; command_index < g_command_count; command_index++)
+        if ((NULL == p_table[i].p_command) ||
+            ((NULL == p_table[i].p_command_interpreter) &&
+             (NULL == p_table[i].p_argv_interpreter)) ||
+            ((i > 0u) && (strcmp(p_table[i - 1u].p_command, p_table[i].p_command) >= 0)))
         {
-            p_registered_command = g_commands_array[command_index].p_command;
-            command_length = (base_type)strlen(p_registered_command);
-
-            /* Check if command matches and has proper delimiter */
-            if ((CHAR_SPACE == p_command_input[command_length]) ||
-                (CHAR_NULL == p_command_input[command_length]) ||
-                (CHAR_CARRIAGE_RET == p_command_input[command_length]) ||
-                (CHAR_NEWLINE == p_command_input[command_length]))
-            {
-                if (0 == strncmp(p_command_input,
-                                 p_registered_command,
-                                 (size_t)command_length))
-                {
-                    /* Command found - validate parameter count */
-                    if (g_commands_array[command_index].expected_parameter_count >= 0)
-                    {
-                        param_count = cli_get_parameter_count(p_command_input);
-
-                        if (param_count != g_commands_array[command_index].expected_parameter_count)
-                        {
-                            is_processed = CLI_FALSE;
-                        }
-                    }
-                    break;
-                }
-            }
+            return CLI_FALSE;
         }
     }
 
-    if (CLI_FALSE == is_processed)
+    g_p_commands = p_table;
+    g_p_commands_end = &p_table[count];
+
+    return CLI_TRUE;
+}
+
+
+/*!
+ * @brief Number of commands in the table.
+ *
+ * @return Command count; indices run from 0 to count - 1.
+ */
+int32_t
+cli_get_command_count (void)
+{
+    return (int32_t)(g_p_commands_end - g_p_commands);
+}
+
+
+/*!
+ * @brief Look up the table index of a command name.
+ *
+ * Lets front ends that address commands by number (binary mode) resolve
+ * names once instead of per request. Indices follow name order and are
+ * fixed when the firmware is linked.
+ *
+ * @param[in] p_name Name (not necessarily null-terminated).
+ * @param[in] name_length Length of p_name.
+ *
+ * @return Index into the command table, or -1 if there is no such command.
+ */
+int32_t
+cli_lookup_command (char const * p_name, size_t name_length)
+{
+    if (NULL == p_name)
     {
-        /* Incorrect parameter count */
-        (void)strncpy(p_write_buffer,
-                      CLI_MSG_INCORRECT_PARAMS,
-                      write_buffer_len);
+        return CLI_NO_COMMAND;
     }
-    else if ((CLI_PASS == is_processed) && (command_index < g_command_count))
+
+    return cli_find_command(p_name, name_length);
+}
+
+
+/*!
+ * @brief Get the name of a command.
+ *
+ * @param[in] command_index Index into the command table.
+ * @param[out] p_length Name length.
+ *
+ * @return Name, or NULL if command_index is out of range.
+ */
+char const *
+cli_get_command_name (int32_t command_index, size_t * p_length)
+{
+    if ((command_index < 0) || (command_index >= cli_get_command_count()))
     {
-        /* Call registered command handler */
-        is_processed = g_commands_array[command_index].p_command_interpreter(
-            p_write_buffer,
-            write_buffer_len,
-            p_command_input);
+        return NULL;
+    }
+
+    *p_length = strlen(g_p_commands[command_index].p_command);
+
+    return g_p_commands[command_index].p_command;
+}
+
+
+/*!
+ * @brief Append bytes to a command output, truncating at its capacity.
+ *
+ * @param[in,out] p_output Output being written.
+ * @param[in] p_data Bytes to append.
+ * @param[in] len Number of bytes.
+ */
+void
+cli_output_write (cli_output_t * p_output, char const * p_data, size_t len)
+{
+    size_t space = p_output->size - p_output->length;
+
+    if (len > space)
+    {
+        len = space;
+    }
+
+    (void)memcpy(&p_output->p_buffer[p_output->length], p_data, len);
+    p_output->length += len;
+}
+
+
+/*!
+ * @brief Append formatted text to a command output.
+ *
+ * Uses the cli-fmt formatter and truncates at the output capacity.
+ *
+ * @param[in,out] p_output Output being written.
+ * @param[in] p_format Format string (%s %.*s %c %d %u %x, see cli-fmt.h).
+ */
+void
+cli_output_printf (cli_output_t * p_output, char const * p_format, ...)
+{
+    va_list args;
+
+    va_start(args, p_format);
+    p_output->length += cli_vfmt(&p_output->p_buffer[p_output->length],
+                                 p_output->size - p_output->length,
+                                 p_format, args);
+    va_end(args);
+}
+
+
+/*!
+ * @brief Run the registered handler for an already tokenized command.
+ *
+ * Shared by the text front end (cli_process_command) and structured front
+ * ends such as JSON mode, which build the argv view themselves and report
+ * errors in their own format. Lookup and parameter validation happen on
+ * the first call; while the handler returns CLI_TRUE, further calls resume
+ * the same command with the same view.
+ *
+ * @param[in] p_args Token view; argv[0] is the command name.
+ * @param[in] p_command_input Raw line for legacy handlers, or NULL if the
+ *            view was not produced from a text line.
+ * @param[in,out] p_output Output the handler appends to.
+ * @param[out] p_b_more Set to CLI_TRUE if the handler has more output.
+ *
+ * @return CLI_STATUS_OK, or the reason no handler ran.
+ */
+int32_t
+cli_execute (cli_args_t const * p_args,
+             char const * p_command_input,
+             cli_output_t * p_output,
+             base_type * p_b_more)
+{
+    static uint32_t command_cycles = 0u;
+    uint32_t start = 0u;
+    cli_command_definition_t const * p_command = NULL;
+    char const * p_end = NULL;
+    base_type is_processed = CLI_FALSE;
+
+    *p_b_more = CLI_FALSE;
+
+    /* Look up and validate on the first call; continuation calls reuse it */
+    if (CLI_NO_COMMAND == g_active_command)
+    {
+        /* An abort only ever applies to the command it was raised for */
+        g_b_cancel = CLI_FALSE;
+
+        if (p_args->argc > 0)
+        {
+            g_active_command = cli_find_command(p_args->argv[0],
+                                             p_args->arglen[0]);
+        }
+
+        if (CLI_NO_COMMAND == g_active_command)
+        {
+            return CLI_STATUS_NOT_FOUND;
+        }
+
+        p_command = &g_p_commands[g_active_command];
+
+        if ((p_command->expected_parameter_count >= 0) &&
+            ((p_args->argc - 1) != p_command->expected_parameter_count))
+        {
+            g_active_command = CLI_NO_COMMAND;
+            return CLI_STATUS_BAD_PARAMS;
+        }
 
-        /* Reset for next command if processing complete */
-        if (CLI_FALSE == is_processed)
+        if ((NULL == p_command->p_argv_interpreter) && (NULL == p_command_input))
         {
-            command_index = 0;
+            g_active_command = CLI_NO_COMMAND;
+            return CLI_STATUS_UNSUPPORTED;
         }
     }
+
+    p_command = &g_p_commands[g_active_command];
+
+    /* Call registered command handler; raw-line handlers get the line */
+    PROF_BEGIN(start);
+    if (NULL != p_command->p_argv_interpreter)
+    {
+        is_processed = p_command->p_argv_interpreter(p_output, p_args);
+    }
+    else if (p_output->length < p_output->size)
+    {
+        /* Legacy handlers produce a null-terminated string */
+        p_output->p_buffer[p_output->length] = CHAR_NULL;
+        is_processed = p_command->p_command_interpreter(
+            &p_output->p_buffer[p_output->length],
+            p_output->size - p_output->length,
+            p_command_input);
+        p_end = memchr(&p_output->p_buffer[p_output->length], CHAR_NULL,
+                       p_output->size - p_output->length);
+        p_output->length = (NULL != p_end) ?
+                           (size_t)(p_end - p_output->p_buffer) : p_output->size;
+    }
+    else
+    {
+        /* No room for even the terminator - nothing to do */
+    }
+
+    /* A streamed response counts as one execution: sum all its chunks */
+    command_cycles += PROF_ELAPSED(start);
+
+    /* Reset for next command if processing complete */
+    if (CLI_FALSE == is_processed)
+    {
+        /* Commands past the last profiling slot are not timed */
+        PROF_RECORD(PROF_SLOT_COMMAND + (uint32_t)g_active_command, command_cycles);
+        command_cycles = 0u;
+        g_active_command = CLI_NO_COMMAND;
+        g_b_cancel = CLI_FALSE;
+    }
+
+    *p_b_more = is_processed;
+
+    return CLI_STATUS_OK;
+}
+
+
+/*!
+ * @brief Ask the command whose response is streaming to stop early.
+ *
+ * Streaming handlers poll cli_cancel_requested() on every call and end
+ * their output there; handlers that finish in one call never see it.
+ *
+ * @return CLI_TRUE if a command was in progress.
+ */
+base_type
+cli_cancel (void)
+{
+    if (CLI_NO_COMMAND == g_active_command)
+    {
+        return CLI_FALSE;
+    }
+
+    g_b_cancel = CLI_TRUE;
+
+    return CLI_TRUE;
+}
+
+
+/*!
+ * @brief Check from a streaming handler whether it should stop.
+ *
+ * A handler that sees CLI_TRUE resets its own state and returns CLI_FALSE.
+ *
+ * @return CLI_TRUE if cli_cancel() was called for the running command.
+ */
+base_type
+cli_cancel_requested (void)
+{
+    return g_b_cancel;
+}
+
+
+/*!
+ * @brief Table index of the command whose response is still streaming.
+ *
+ * @return Index into the command table, or -1 between commands.
+ */
+int32_t
+cli_get_active_command (void)
+{
+    return g_active_command;
+}
+
+
+/*!
+ * @brief Process a received command string.
+ *
+ * Tokenizes the input once, validates parameters, and calls the registered
+ * handler. The command word is resolved by binary search over the command
+ * table, which the linker has already sorted by name.
+ *
+ * @param[in] p_command_input Pointer to null-terminated command string.
+ * @param[in,out] p_output Output to write the response into; the handler
+ *                appends to p_output->length.
+ *
+ * @return CLI_FALSE when command processing is complete, CLI_TRUE if more output pending.
+ */
+base_type
+cli_process_command (char const * const p_command_input,
+                     cli_output_t * p_output)
+{
+    static cli_args_t args;
+    static base_type b_in_progress = CLI_FALSE;
+    int32_t status = CLI_STATUS_OK;
+
+    if ((NULL == p_command_input) || (NULL == p_output) ||
+        (NULL == p_output->p_buffer))
+    {
+        return CLI_FALSE;
+    }
+
+    /* Tokenize on first call; continuation calls reuse the view */
+    if ((CLI_FALSE == b_in_progress) && (cli_tokenize(p_command_input, &args) < 0))
+    {
+        /* Too many tokens for the argv view */
+        status = CLI_STATUS_BAD_PARAMS;
+    }
     else
     {
-        /* Command not found */
-        (void)strncpy(p_write_buffer,
-                      CLI_MSG_NOT_RECOGNIZED,
-                      write_buffer_len);
-        is_processed = CLI_FALSE;
+        status = cli_execute(&args, p_command_input, p_output, &b_in_progress);
     }
 
-    return is_processed;
+    if (CLI_STATUS_NOT_FOUND == status)
+    {
+        cli_output_write(p_output, CLI_MSG_NOT_RECOGNIZED,
+                         sizeof(CLI_MSG_NOT_RECOGNIZED) - 1u);
+    }
+    else if (CLI_STATUS_OK != status)
+    {
+        cli_output_write(p_output, CLI_MSG_INCORRECT_PARAMS,
+                         sizeof(CLI_MSG_INCORRECT_PARAMS) - 1u);
+    }
+    else
+    {
+        /* Handler output already in place */
+    }
+
+    return b_in_progress;
 }
 
 
 /*!
  * @brief Help command handler - lists all registered commands.
  *
- * @param[out] p_write_buffer Output buffer for help text.
- * @param[in] write_buffer_len Size of output buffer.
- * @param[in] p_command_string Original command string (unused).
+ * Works as a generator: each call fills the output with as many entries as
+ * fit and returns CLI_TRUE while entries remain, so the listing streams
+ * through an output of any size that holds one entry.
  *
- * @return CLI_FALSE (command complete).
+ * @param[in,out] p_output Output for help text.
+ * @param[in] p_args Tokenized command line (unused).
+ *
+ * @return CLI_FALSE when the listing is complete, CLI_TRUE if more output pending.
  */
 base_type
-cli_help_interpreter (char * p_write_buffer,
-                      size_t write_buffer_len,
-                      char const * const p_command_string)
+cli_help_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
 {
-    int32_t cmd_index = 0;
-    size_t current_len = 0u;
+    static int32_t cmd_index = CLI_NO_COMMAND;
     size_t cmd_name_len = 0u;
-    char const * p_cmd_name = NULL;
+    size_t start_length = p_output->length;
 
-    (void)p_command_string; /* Unused parameter */
+    (void)p_args; /* Unused parameter */
 
-    if (NULL == p_write_buffer)
+    if (CLI_TRUE == cli_cancel_requested())
     {
+        cmd_index = CLI_NO_COMMAND;
         return CLI_FALSE;
     }
 
-    /* Initialize buffer with header */
-    (void)memset(p_write_buffer, 0, write_buffer_len);
-    (void)strncpy(p_write_buffer, CLI_MSG_HELP_HEADER, write_buffer_len);
-    current_len = strlen(p_write_buffer);
+    /* First chunk starts with the header */
+    if (CLI_NO_COMMAND == cmd_index)
+    {
+        cli_output_write(p_output, CLI_MSG_HELP_HEADER,
+                         sizeof(CLI_MSG_HELP_HEADER) - 1u);
+        cmd_index = 0;
+    }
 
-    /* List all registered commands except help itself */
-    for (cmd_index = 0; cmd_index < g_command_count; cmd_index++)
+    while (cmd_index < cli_get_command_count())
     {
-        if (0 == cmd_index)
+        /* Skip help itself */
+        if (cli_help_interpreter == g_p_commands[cmd_index].p_argv_interpreter)
         {
-            continue; /* Skip help command */
+            cmd_index++;
+            continue;
         }
 
-        p_cmd_name = g_commands_array[cmd_index].p_command;
-        cmd_name_len = strlen(p_cmd_name);
+        cmd_name_len = strlen(g_p_commands[cmd_index].p_command);
 
-        /* Check buffer space before adding (need space for "  \r\n" + null) */
-        if ((current_len + cmd_name_len + 5u) < write_buffer_len)
+        /* Check space for "  " + name + "\r\n" */
+        if ((p_output->length + cmd_name_len + 4u) > p_output->size)
         {
-            (void)strncat(p_write_buffer,
-                          "  ",
-                          write_buffer_len - current_len - 1u);
-            (void)strncat(p_write_buffer,
-                          p_cmd_name,
-                          write_buffer_len - current_len - 1u);
-            (void)strncat(p_write_buffer,
-                          "\r\n",
-                          write_buffer_len - current_len - 1u);
-            current_len = strlen(p_write_buffer);
+            if (start_length == p_output->length)
+            {
+                cmd_index++; /* Entry can never fit - drop it */
+                continue;
+            }
+
+            /* Chunk full - resume here on the next call */
+            return CLI_TRUE;
         }
+
+        cli_output_write(p_output, "  ", 2u);
+        cli_output_write(p_output, g_p_commands[cmd_index].p_command,
+                         cmd_name_len);
+        cli_output_write(p_output, "\r\n", 2u);
+        cmd_index++;
     }
 
+    cmd_index = CLI_NO_COMMAND;
+
     return CLI_FALSE;
 }
 
@@ -243,112 +570,151 @@ cli_help_interpreter (char * p_write_buffer,
 /*!
  * @brief Set command handler - sets a key-value pair.
  *
- * @param[out] p_write_buffer Output buffer for response.
- * @param[in] write_buffer_len Size of output buffer.
- * @param[in] p_command_string Original command string with parameters.
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line (argv[1] key, argv[2] value).
  *
  * @return CLI_FALSE (command complete).
  */
 base_type
-cli_set_interpreter (char * p_write_buffer,
-                     size_t write_buffer_len,
-                     char const * const p_command_string)
+cli_set_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
 {
-    char const * p_param = NULL;
-    base_type param_len = 0;
-    char param1[50];
-    char param2[50];
+    int32_t result = KV_OK;
 
-    if ((NULL == p_write_buffer) || (NULL == p_command_string))
+    if (p_args->argc < 3)
     {
+        cli_output_write(p_output, CLI_MSG_MISSING_PARAM,
+                         sizeof(CLI_MSG_MISSING_PARAM) - 1u);
         return CLI_FALSE;
     }
 
-    (void)memset(p_write_buffer, 0, write_buffer_len);
-
-    /* Extract first parameter (key) */
-    p_param = cli_get_parameter(p_command_string, 1, &param_len);
+    result = kv_set(p_args->argv[1], p_args->arglen[1],
+                    p_args->argv[2], p_args->arglen[2]);
 
-    if ((NULL != p_param) && (param_len < 50))
+    if (KV_OK == result)
     {
-        (void)strncpy(param1, p_param, (size_t)param_len);
-        param1[param_len] = CHAR_NULL;
+        cli_output_printf(p_output, "Set %.*s = %.*s\r\n",
+                          (int)p_args->arglen[1], p_args->argv[1],
+                          (int)p_args->arglen[2], p_args->argv[2]);
+    }
+    else if (KV_ERROR_FULL == result)
+    {
+        cli_output_write(p_output, CLI_MSG_STORE_FULL,
+                         sizeof(CLI_MSG_STORE_FULL) - 1u);
     }
     else
     {
-        (void)strncpy(p_write_buffer,
-                      CLI_MSG_MISSING_PARAM,
-                      write_buffer_len);
-        return CLI_FALSE;
+        cli_output_write(p_output, CLI_MSG_INVALID_PAIR,
+                         sizeof(CLI_MSG_INVALID_PAIR) - 1u);
     }
 
-    /* Extract second parameter (value) */
-    p_param = cli_get_parameter(p_command_string, 2, &param_len);
+    return CLI_FALSE;
+}
+
+
+/*!
+ * @brief Get command handler - retrieves a value by key.
+ *
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line (argv[1] key).
+ *
+ * @return CLI_FALSE (command complete).
+ */
+base_type
+cli_get_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    char const * p_value = NULL;
+    size_t value_len = 0u;
+
+    if (p_args->argc < 2)
+    {
+        cli_output_write(p_output, CLI_MSG_MISSING_PARAM,
+                         sizeof(CLI_MSG_MISSING_PARAM) - 1u);
+        return CLI_FALSE;
+    }
 
-    if ((NULL != p_param) && (param_len < 50))
+    if (KV_OK == kv_get(p_args->argv[1], p_args->arglen[1], &p_value, &value_len))
     {
-        (void)strncpy(param2, p_param, (size_t)param_len);
-        param2[param_len] = CHAR_NULL;
+        cli_output_printf(p_output, "Get %.*s: %.*s\r\n",
+                          (int)p_args->arglen[1], p_args->argv[1],
+                          (int)value_len, p_value);
     }
     else
     {
-        (void)strncpy(p_write_buffer,
-                      CLI_MSG_MISSING_PARAM,
-                      write_buffer_len);
-        return CLI_FALSE;
+        cli_output_printf(p_output, "Get %.*s: [not found]\r\n",
+                          (int)p_args->arglen[1], p_args->argv[1]);
     }
 
-    /* Format response */
-    (void)sprintf(p_write_buffer, "Set %s = %s\r\n", param1, param2);
-
     return CLI_FALSE;
 }
 
 
 /*!
- * @brief Get command handler - retrieves a value by key.
+ * @brief Split a command line into tokens in a single pass.
  *
- * @param[out] p_write_buffer Output buffer for response.
- * @param[in] write_buffer_len Size of output buffer.
- * @param[in] p_command_string Original command string with parameters.
+ * Tokens are space-delimited and the line ends at the first null, carriage
+ * return or newline. The view points into p_command_string, nothing is
+ * copied or modified.
  *
- * @return CLI_FALSE (command complete).
+ * @param[in] p_command_string Pointer to command string.
+ * @param[out] p_args Token view of the line.
+ *
+ * @return Number of tokens, or -1 if the line has more than CLI_MAX_ARGS
+ *         (p_args then holds the first CLI_MAX_ARGS tokens).
  */
 base_type
-cli_get_interpreter (char * p_write_buffer,
-                     size_t write_buffer_len,
-                     char const * const p_command_string)
+cli_tokenize (char const * p_command_string, cli_args_t * p_args)
 {
-    char const * p_param = NULL;
-    base_type param_len = 0;
-    char param[50];
+    char const * p_token = NULL;
 
-    if ((NULL == p_write_buffer) || (NULL == p_command_string))
+    if (NULL == p_args)
     {
-        return CLI_FALSE;
+        return -1;
     }
 
-    (void)memset(p_write_buffer, 0, write_buffer_len);
+    p_args->argc = 0;
 
-    /* Extract parameter (key) */
-    p_param = cli_get_parameter(p_command_string, 1, &param_len);
-
-    if ((NULL != p_param) && (param_len < 50))
+    if (NULL == p_command_string)
     {
-        (void)strncpy(param, p_param, (size_t)param_len);
-        param[param_len] = CHAR_NULL;
-        (void)sprintf(p_write_buffer,
-                      "Get %s: [value not implemented]\r\n",
-                      param);
+        return 0;
     }
-    else
+
+    for (;;)
     {
-        (void)strncpy(p_write_buffer,
-                      CLI_MSG_MISSING_PARAM,
-                      write_buffer_len);
+        /* Skip spaces */
+        while (CHAR_SPACE == *p_command_string)
+        {
+            p_command_string++;
+        }
+
+        if ((CHAR_NULL == *p_command_string) ||
+            (CHAR_CARRIAGE_RET == *p_command_string) ||
+            (CHAR_NEWLINE == *p_command_string))
+        {
+            break;
+        }
+
+        if (p_args->argc >= (int32_t)CLI_MAX_ARGS)
+        {
+            return -1;
+        }
+
+        /* Measure the token */
+        p_token = p_command_string;
+
+        while ((CHAR_NULL != *p_command_string) &&
+               (CHAR_SPACE != *p_command_string) &&
+               (CHAR_CARRIAGE_RET != *p_command_string) &&
+               (CHAR_NEWLINE != *p_command_string))
+        {
+            p_command_string++;
+        }
+
+        p_args->argv[p_args->argc] = p_token;
+        p_args->arglen[p_args->argc] = (uint16_t)(p_command_string - p_token);
+        p_args->argc++;
     }
 
-    return CLI_FALSE;
+    return p_args->argc;
 }
 
 
@@ -481,6 +847,50 @@ cli_get_parameter (char const * p_command_string,
     return p_return_param;
 }
 
+
+/*!
+ * @brief Parse a decimal argument.
+ *
+ * @param[in] p_text Digits (not necessarily null-terminated).
+ * @param[in] length Number of characters.
+ * @param[out] p_value Parsed value.
+ *
+ * @return CLI_TRUE if p_text is a decimal number that fits 32 bits.
+ */
+base_type
+cli_parse_uint (char const * p_text, size_t length, uint32_t * p_value)
+{
+    uint32_t value = 0u;
+    uint32_t digit = 0u;
+    size_t index = 0u;
+
+    if ((NULL == p_text) || (NULL == p_value) || (0u == length))
+    {
+        return CLI_FALSE;
+    }
+
+    for (index = 0u; index < length; index++)
+    {
+        if ((p_text[index] < '0') || (p_text[index] > '9'))
+        {
+            return CLI_FALSE;
+        }
+
+        digit = (uint32_t)(p_text[index] - '0');
+
+        if (value > ((UINT32_MAX - digit) / 10u))
+        {
+            return CLI_FALSE;
+        }
+
+        value = (value * 10u) + digit;
+    }
+
+    *p_value = value;
+
+    return CLI_TRUE;
+}
+
 #ifdef __cplusplus
 }
 #endif
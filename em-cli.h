@@ -27,35 +27,89 @@ typedef int32_t base_type;
 #define CLI_TRUE              ((base_type)1)
 #define CLI_PASS              ((base_type)1)
 
-/* Maximum number of commands that can be registered */
-#define CLI_MAX_COMMANDS      10u
+/* cli_execute() status codes */
+#define CLI_STATUS_OK           ((int32_t)0)
+#define CLI_STATUS_NOT_FOUND    ((int32_t)-1)   /* No such command */
+#define CLI_STATUS_BAD_PARAMS   ((int32_t)-2)   /* Wrong parameter count */
+#define CLI_STATUS_UNSUPPORTED  ((int32_t)-3)   /* Raw-line handler without a line */
 
-/* Maximum buffer size for command responses */
-#define CLI_WRITE_BUFFER_SIZE 512u
+/* Dispatch from the linked .cli_cmds section (0: cli_set_command_table()) */
+#ifndef CLI_LINKER_TABLE
+#define CLI_LINKER_TABLE      1u
+#endif
+
+/* Maximum number of tokens per line (command word + parameters) */
+#define CLI_MAX_ARGS          8u
+
+/* Size of one response chunk; longer output streams via CLI_TRUE */
+#define CLI_WRITE_BUFFER_SIZE 128u
 
 /* CRITICAL: Use array-based registration (no dynamic allocation) */
 #define CLI_ARRAY_BASED_REGISTER
 
+/**
+ * @brief Tokenized command line.
+ *
+ * Produced in one pass over the input line. Tokens point into the original
+ * line and are NOT null-terminated; use the matching length.
+ */
+typedef struct cli_args
+{
+    int32_t argc;                           /**< Tokens stored, argv[0] is the command */
+    char const * argv[CLI_MAX_ARGS];        /**< Token start pointers */
+    uint16_t arglen[CLI_MAX_ARGS];          /**< Token lengths in bytes */
+} cli_args_t;
+
+/**
+ * @brief Destination for command output.
+ *
+ * Usually a reservation straight in the UART TX ring. Handlers append to
+ * length and never write past size; the text is not null-terminated.
+ */
+typedef struct cli_output
+{
+    char * p_buffer;                        /**< Output bytes */
+    size_t size;                            /**< Capacity in bytes */
+    size_t length;                          /**< Bytes written so far */
+} cli_output_t;
+
 /**
  * @brief Command definition structure.
  *
  * Defines a single CLI command with its handler function and metadata.
+ * A command provides either p_argv_interpreter, which receives the
+ * tokenized line, or the original p_command_interpreter, which receives
+ * the raw line and extracts parameters with cli_get_parameter().
  */
 typedef struct command_line_input
 {
     char const * p_command;                 /**< Command string (e.g., "set") */
     char const * p_help_string;             /**< Help text for this command */
-    base_type (*p_command_interpreter)(     /**< Command handler function */
+    base_type (*p_command_interpreter)(     /**< Raw-line handler (legacy, may be NULL) */
         char * p_write_buffer,
         size_t write_buffer_len,
         char const * const p_command_string);
     int8_t expected_parameter_count;        /**< Required parameter count (-1 = variable) */
+    base_type (*p_argv_interpreter)(        /**< Tokenized handler (preferred, may be NULL) */
+        cli_output_t * p_output,
+        cli_args_t const * p_args);
 } cli_command_definition_t;
 
-/* Global command registry array */
-extern cli_command_definition_t g_commands_array[CLI_MAX_COMMANDS];
-extern int32_t g_command_count;
-extern char g_cli_write_buffer[CLI_WRITE_BUFFER_SIZE];
+/*!
+ * @brief Define a command in the flash command table.
+ *
+ * The definition lands in its own .cli_cmds.<name> input section; the
+ * linker script keeps those sorted by section name, which turns them
+ * into one name-sorted array that dispatch binary searches in place.
+ * Nothing is registered or copied at startup. name must be an identifier
+ * and is also the command word; defining it twice fails to link.
+ *
+ * Usage: CLI_COMMAND(name, "help text", NULL, 1, name_interpreter);
+ */
+#define CLI_COMMAND(name, help, line_interpreter, parameter_count, argv_interpreter) \
+    __attribute__((used, section(".cli_cmds." #name)))                               \
+    cli_command_definition_t const g_##name##_command =                              \
+    { #name, (help), (line_interpreter), (parameter_count), (argv_interpreter) }
 
 /* Built-in command definitions */
 extern const cli_command_definition_t g_help_command;
@@ -65,26 +119,120 @@ extern const cli_command_definition_t g_get_command;
 /* Public API functions */
 
 /*!
- * @brief Register a new command in the CLI system.
+ * @brief Dispatch from a caller-built command table instead.
+ *
+ * For builds without the linker section (host tools).
  *
- * @param[in] p_command_to_register Pointer to command definition structure.
+ * @param[in] p_table Commands sorted by name (strcmp() order).
+ * @param[in] count Number of commands.
  *
- * @return CLI_TRUE on success, CLI_FALSE if registry is full.
+ * @return CLI_TRUE if the table was taken, CLI_FALSE if it is invalid or
+ *         its names are out of order or repeated.
  */
-base_type cli_register_command(cli_command_definition_t const * const p_command_to_register);
+base_type cli_set_command_table(cli_command_definition_t const * p_table, uint32_t count);
+
+/*!
+ * @brief Number of commands in the table.
+ *
+ * @return Command count; indices run from 0 to count - 1.
+ */
+int32_t cli_get_command_count(void);
 
 /*!
  * @brief Process a received command string.
  *
  * @param[in] p_command_input Pointer to null-terminated command string.
- * @param[out] p_write_buffer Buffer for command response output.
- * @param[in] write_buffer_len Size of write buffer in bytes.
+ * @param[in,out] p_output Output to append the response to.
  *
  * @return CLI_FALSE when command processing is complete, CLI_TRUE if more output pending.
  */
 base_type cli_process_command(char const * const p_command_input,
-                               char * p_write_buffer,
-                               size_t write_buffer_len);
+                               cli_output_t * p_output);
+
+/*!
+ * @brief Run the registered handler for an already tokenized command.
+ *
+ * @param[in] p_args Token view; argv[0] is the command name.
+ * @param[in] p_command_input Raw line for legacy handlers, or NULL.
+ * @param[in,out] p_output Output the handler appends to.
+ * @param[out] p_b_more Set to CLI_TRUE if the handler has more output.
+ *
+ * @return CLI_STATUS_OK, or the reason no handler ran.
+ */
+int32_t cli_execute(cli_args_t const * p_args,
+                    char const * p_command_input,
+                    cli_output_t * p_output,
+                    base_type * p_b_more);
+
+/*!
+ * @brief Ask the command whose response is streaming to stop early.
+ *
+ * @return CLI_TRUE if a command was in progress.
+ */
+base_type cli_cancel(void);
+
+/*!
+ * @brief Check from a streaming handler whether it should stop.
+ *
+ * A handler that sees CLI_TRUE resets its own state and returns CLI_FALSE.
+ *
+ * @return CLI_TRUE if cli_cancel() was called for the running command.
+ */
+base_type cli_cancel_requested(void);
+
+/*!
+ * @brief Table index of the command whose response is still streaming.
+ *
+ * @return Index into the command table, or -1 between commands.
+ */
+int32_t cli_get_active_command(void);
+
+/*!
+ * @brief Look up the table index of a command name.
+ *
+ * @param[in] p_name Name (not necessarily null-terminated).
+ * @param[in] name_length Length of p_name.
+ *
+ * @return Index into the command table, or -1 if there is no such command.
+ */
+int32_t cli_lookup_command(char const * p_name, size_t name_length);
+
+/*!
+ * @brief Get the name of a command.
+ *
+ * @param[in] command_index Index into the command table.
+ * @param[out] p_length Name length.
+ *
+ * @return Name, or NULL if command_index is out of range.
+ */
+char const * cli_get_command_name(int32_t command_index, size_t * p_length);
+
+/*!
+ * @brief Append bytes to a command output, truncating at its capacity.
+ *
+ * @param[in,out] p_output Output being written.
+ * @param[in] p_data Bytes to append.
+ * @param[in] len Number of bytes.
+ */
+void cli_output_write(cli_output_t * p_output, char const * p_data, size_t len);
+
+/*!
+ * @brief Append formatted text to a command output.
+ *
+ * @param[in,out] p_output Output being written.
+ * @param[in] p_format Format string (%s %.*s %c %d %u %x, see cli-fmt.h).
+ */
+void cli_output_printf(cli_output_t * p_output, char const * p_format, ...);
+
+/*!
+ * @brief Split a command line into tokens in a single pass.
+ *
+ * @param[in] p_command_string Pointer to command string.
+ * @param[out] p_args Token view of the line.
+ *
+ * @return Number of tokens, or -1 if the line has more than CLI_MAX_ARGS.
+ */
+base_type cli_tokenize(char const * p_command_string, cli_args_t * p_args);
 
 /*!
  * @brief Count parameters in a command string.
@@ -108,46 +256,51 @@ char const * cli_get_parameter(char const * p_command_string,
                                 base_type wanted_parameter,
                                 base_type * p_parameter_length);
 
+/*!
+ * @brief Parse a decimal argument.
+ *
+ * @param[in] p_text Digits (not necessarily null-terminated).
+ * @param[in] length Number of characters.
+ * @param[out] p_value Parsed value.
+ *
+ * @return CLI_TRUE if p_text is a decimal number that fits 32 bits.
+ */
+base_type cli_parse_uint(char const * p_text, size_t length, uint32_t * p_value);
+
 /* Built-in command handler prototypes */
 
 /*!
  * @brief Help command handler - lists all registered commands.
  *
- * @param[out] p_write_buffer Output buffer for help text.
- * @param[in] write_buffer_len Size of output buffer.
- * @param[in] p_command_string Original command string (unused).
+ * @param[in,out] p_output Output for help text.
+ * @param[in] p_args Tokenized command line (unused).
  *
- * @return CLI_FALSE (command complete).
+ * @return CLI_FALSE when the listing is complete, CLI_TRUE if more output pending.
  */
-base_type cli_help_interpreter(char * p_write_buffer,
-                                size_t write_buffer_len,
-                                char const * const p_command_string);
+base_type cli_help_interpreter(cli_output_t * p_output,
+                                cli_args_t const * p_args);
 
 /*!
  * @brief Set command handler - sets a key-value pair.
  *
- * @param[out] p_write_buffer Output buffer for response.
- * @param[in] write_buffer_len Size of output buffer.
- * @param[in] p_command_string Original command string with parameters.
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line (argv[1] key, argv[2] value).
  *
  * @return CLI_FALSE (command complete).
  */
-base_type cli_set_interpreter(char * p_write_buffer,
-                               size_t write_buffer_len,
-                               char const * const p_command_string);
+base_type cli_set_interpreter(cli_output_t * p_output,
+                               cli_args_t const * p_args);
 
 /*!
  * @brief Get command handler - retrieves a value by key.
  *
- * @param[out] p_write_buffer Output buffer for response.
- * @param[in] write_buffer_len Size of output buffer.
- * @param[in] p_command_string Original command string with parameters.
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line (argv[1] key).
  *
  * @return CLI_FALSE (command complete).
  */
-base_type cli_get_interpreter(char * p_write_buffer,
-                               size_t write_buffer_len,
-                               char const * const p_command_string);
+base_type cli_get_interpreter(cli_output_t * p_output,
+                               cli_args_t const * p_args);
 
 #ifdef __cplusplus
 }
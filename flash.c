@@ -0,0 +1,190 @@
+/** @file flash.c
+ *
+ * @brief STM32G0 internal flash erase/program driver.
+ *
+ * Single-bank page erase and double-word programming. The CPU stalls on
+ * flash accesses while an operation is running; DMA transfers to RAM keep
+ * going, so UART reception is not lost during an erase.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "flash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Register bit position constants */
+#define FLASH_SR_EOP_BIT           0u
+#define FLASH_SR_BSY1_BIT          16u
+#define FLASH_SR_ERROR_MASK        0x000003FAu    /* OPERR..FASTERR */
+#define FLASH_CR_PG_BIT            0u
+#define FLASH_CR_PER_BIT           1u
+#define FLASH_CR_PNB_SHIFT         3u
+#define FLASH_CR_PNB_MASK          0x3Fu
+#define FLASH_CR_STRT_BIT          16u
+#define FLASH_CR_LOCK_BIT          31u
+
+/* Unlock key sequence */
+#define FLASH_KEY1                 0x45670123u
+#define FLASH_KEY2                 0xCDEF89ABu
+
+/* Defining FLASH Registers used  */
+/*
+
+FLASH_KEYR --> At an Offset of 0x08
+FLASH_SR --> At an Offset of 0x10
+FLASH_CR --> At an Offset of 0x14
+
+*/
+volatile uint32_t * FLASH_KEYR = (uint32_t *) 0x40022008;
+volatile uint32_t * FLASH_SR = (uint32_t *) 0x40022010;
+volatile uint32_t * FLASH_CR = (uint32_t *) 0x40022014;
+
+
+/*!
+ * @brief Wait for the running operation and collect its error flags.
+ *
+ * @return 0 on success, -1 if the controller reported an error.
+ */
+static int32_t
+flash_wait (void)
+{
+    uint32_t errors = 0u;
+
+    while ((*FLASH_SR & (1u << FLASH_SR_BSY1_BIT)) != 0u)
+    {
+        /* Busy wait */
+    }
+
+    errors = *FLASH_SR & FLASH_SR_ERROR_MASK;
+
+    /* Clear EOP and any error flags (write 1 to clear) */
+    *FLASH_SR = (errors | (1u << FLASH_SR_EOP_BIT));
+
+    return (0u == errors) ? 0 : -1;
+}
+
+
+/*!
+ * @brief Unlock the flash control register.
+ */
+static void
+flash_unlock (void)
+{
+    if ((*FLASH_CR & (1u << FLASH_CR_LOCK_BIT)) != 0u)
+    {
+        *FLASH_KEYR = FLASH_KEY1;
+        *FLASH_KEYR = FLASH_KEY2;
+    }
+}
+
+
+/*!
+ * @brief Lock the flash control register again.
+ */
+static void
+flash_lock (void)
+{
+    *FLASH_CR |= (1u << FLASH_CR_LOCK_BIT);
+}
+
+
+/*!
+ * @brief Erase one flash page.
+ *
+ * @param[in] page_address Any address inside the page.
+ *
+ * @return 0 on success, -1 on controller error or invalid address.
+ */
+int32_t
+flash_erase_page (uint32_t page_address)
+{
+    uint32_t page = 0u;
+    int32_t result = 0;
+
+    if (page_address < FLASH_BASE_ADDRESS)
+    {
+        return -1;
+    }
+
+    page = (page_address - FLASH_BASE_ADDRESS) / FLASH_PAGE_SIZE;
+
+    flash_unlock();
+    (void)flash_wait();
+
+    *FLASH_CR = (*FLASH_CR & ~(FLASH_CR_PNB_MASK << FLASH_CR_PNB_SHIFT)) |
+                ((page & FLASH_CR_PNB_MASK) << FLASH_CR_PNB_SHIFT) |
+                (1u << FLASH_CR_PER_BIT);
+    *FLASH_CR |= (1u << FLASH_CR_STRT_BIT);
+
+    result = flash_wait();
+
+    *FLASH_CR &= ~(1u << FLASH_CR_PER_BIT);
+    flash_lock();
+
+    return result;
+}
+
+
+/*!
+ * @brief Program erased flash one double word at a time.
+ *
+ * @param[in] address Destination, aligned to FLASH_PROGRAM_UNIT.
+ * @param[in] p_data Source data (any alignment).
+ * @param[in] len Number of bytes, a multiple of FLASH_PROGRAM_UNIT.
+ *
+ * @return 0 on success, -1 on controller error or invalid arguments.
+ */
+int32_t
+flash_program (uint32_t address, void const * p_data, uint32_t len)
+{
+    uint8_t const * p_src = (uint8_t const *)p_data;
+    volatile uint32_t * p_dst = NULL;
+    uint32_t words[2];
+    int32_t result = 0;
+
+    if ((NULL == p_data) ||
+        (0u != (address % FLASH_PROGRAM_UNIT)) ||
+        (0u != (len % FLASH_PROGRAM_UNIT)))
+    {
+        return -1;
+    }
+
+    flash_unlock();
+    (void)flash_wait();
+
+    *FLASH_CR |= (1u << FLASH_CR_PG_BIT);
+
+    while ((len > 0u) && (0 == result))
+    {
+        (void)memcpy(words, p_src, sizeof(words));
+
+        /* Both words of the double word must be written back to back */
+        p_dst = (volatile uint32_t *)(uintptr_t)address;
+        p_dst[0] = words[0];
+        p_dst[1] = words[1];
+
+        result = flash_wait();
+
+        address += FLASH_PROGRAM_UNIT;
+        p_src += FLASH_PROGRAM_UNIT;
+        len -= FLASH_PROGRAM_UNIT;
+    }
+
+    *FLASH_CR &= ~(1u << FLASH_CR_PG_BIT);
+    flash_lock();
+
+    return result;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
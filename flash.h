@@ -0,0 +1,35 @@
+/** @file flash.h
+ *
+ * @brief STM32G0 internal flash erase/program driver.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Flash geometry (STM32G071RB: 64 pages of 2 KB) */
+#define FLASH_BASE_ADDRESS     0x08000000u
+#define FLASH_PAGE_SIZE        2048u
+
+/* Smallest programmable unit (one double word) */
+#define FLASH_PROGRAM_UNIT     8u
+
+/* Public API functions */
+int32_t flash_erase_page(uint32_t page_address);
+int32_t flash_program(uint32_t address, void const * p_data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_H */
+
+/*** end of file ***/
@@ -0,0 +1,734 @@
+/** @file host-bench.c
+ *
+ * @brief Host benchmark and regression check of the parser and dispatcher.
+ *
+ * Built natively with "make host-bench" (no target hardware), this times
+ * cli_process_command(), cli_tokenize(), cli_get_parameter() and
+ * jsmn_parse() over a small and a full command table, long parameter
+ * lists and representative JSON payloads, times jsmn_path_extract() after
+ * checking nested paths, arrays and number limits, and checks that a response
+ * streamed over several JSON chunks arrives whole. Every case first checks its
+ * result, so a functional regression fails the run (exit status 1) before
+ * any timing is reported. Allocations are counted by wrapping malloc and
+ * friends at link time; the firmware modules are expected to make none.
+ *
+ * Usage: ./host-bench [iterations]
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "em-cli.h"
+#include "jsmn.h"
+#include "jsmn-path.h"
+#include "cli-json.h"
+#include "kv-store.h"
+
+/* Default iterations per case */
+#define BENCH_DEFAULT_ITERATIONS   200000u
+
+/* Filler commands for the full-table cases ("cmd000" sorts first) */
+#define BENCH_TABLE_COMMANDS       128u
+#define BENCH_BUILTIN_COMMANDS     3u
+#define BENCH_NAME_SIZE            8u
+
+/* Token pool for the JSON cases */
+#define BENCH_MAX_TOKENS           256u
+
+/* Output capacity handed to handlers, as on target */
+#define BENCH_OUTPUT_SIZE          CLI_WRITE_BUFFER_SIZE
+
+/* Lines the streaming command produces, several JSON chunks' worth */
+#define BENCH_STREAM_LINES         12u
+#define BENCH_STREAM_LINE_LEN      9u      /* "line NN\r\n" */
+
+/* Allocation counters, bumped by the --wrap'ed allocator entry points */
+static unsigned long g_alloc_count = 0u;
+
+/* Results the optimizer must not discard */
+static volatile uint32_t g_sink = 0u;
+
+/* Command table the dispatcher runs from: fillers, then the built-ins */
+static char g_filler_names[BENCH_TABLE_COMMANDS][BENCH_NAME_SIZE];
+static cli_command_definition_t g_bench_commands[BENCH_TABLE_COMMANDS];
+
+/* Representative JSON payloads */
+static char const BENCH_JSON_REQUEST[] =
+    "{\"cmd\":\"set\",\"key\":\"led\",\"val\":\"on\"}";
+static char const BENCH_JSON_NESTED[] =
+    "{\"id\":42,\"cmd\":\"cfg\",\"args\":{\"uart\":{\"baud\":115200,"
+    "\"parity\":\"none\",\"stop\":1},\"leds\":[true,false,true,false],"
+    "\"name\":\"bench \\\"node\\\" \\u00e9\"},\"seq\":-17}";
+static char const BENCH_JSON_LIMITS[] =
+    "{\"min\":-2147483648,\"over\":2147483648,\"under\":-2147483649,"
+    "\"umax\":4294967295,\"uover\":4294967296}";
+
+/**
+ * @brief Destination of the key path cases.
+ */
+typedef struct bench_path_result
+{
+    jsmn_path_string_t cmd;
+    uint32_t baud;
+    uint32_t stop;
+    int32_t seq;
+    uint8_t b_led;
+    jsmn_path_string_t name;
+    uint32_t missing;
+    int32_t min;
+    int32_t over;
+    int32_t under;
+    uint32_t umax;
+    uint32_t uover;
+} bench_path_result_t;
+
+/* Paths into BENCH_JSON_NESTED: "args.leds" is an array, never a value */
+static jsmn_path_field_t const BENCH_PATH_NESTED[] = {
+    { "cmd",               JSMN_PATH_STRING, offsetof(bench_path_result_t, cmd)     },
+    { "args.uart.baud",    JSMN_PATH_UINT,   offsetof(bench_path_result_t, baud)    },
+    { "args.uart.stop",    JSMN_PATH_UINT,   offsetof(bench_path_result_t, stop)    },
+    { "seq",               JSMN_PATH_INT,    offsetof(bench_path_result_t, seq)     },
+    { "args.leds",         JSMN_PATH_BOOL,   offsetof(bench_path_result_t, b_led)   },
+    { "args.name",         JSMN_PATH_STRING, offsetof(bench_path_result_t, name)    },
+    { "args.uart.missing", JSMN_PATH_UINT,   offsetof(bench_path_result_t, missing) },
+};
+#define BENCH_PATH_NESTED_FOUND  0x2Fu   /* All but "args.leds" and "missing" */
+
+/* Paths into BENCH_JSON_LIMITS: only the in-range values convert */
+static jsmn_path_field_t const BENCH_PATH_LIMITS[] = {
+    { "min",   JSMN_PATH_INT,  offsetof(bench_path_result_t, min)   },
+    { "over",  JSMN_PATH_INT,  offsetof(bench_path_result_t, over)  },
+    { "under", JSMN_PATH_INT,  offsetof(bench_path_result_t, under) },
+    { "umax",  JSMN_PATH_UINT, offsetof(bench_path_result_t, umax)  },
+    { "uover", JSMN_PATH_UINT, offsetof(bench_path_result_t, uover) },
+};
+#define BENCH_PATH_LIMITS_FOUND  0x09u   /* "min" and "umax" */
+
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t count, size_t size);
+void * __real_realloc(void * p_old, size_t size);
+
+void * __wrap_malloc(size_t size);
+void * __wrap_calloc(size_t count, size_t size);
+void * __wrap_realloc(void * p_old, size_t size);
+
+
+void *
+__wrap_malloc (size_t size)
+{
+    g_alloc_count++;
+    return __real_malloc(size);
+}
+
+
+void *
+__wrap_calloc (size_t count, size_t size)
+{
+    g_alloc_count++;
+    return __real_calloc(count, size);
+}
+
+
+void *
+__wrap_realloc (void * p_old, size_t size)
+{
+    g_alloc_count++;
+    return __real_realloc(p_old, size);
+}
+
+
+/*!
+ * @brief Monotonic time stamp.
+ *
+ * @return Nanoseconds since an arbitrary epoch.
+ */
+static uint64_t
+bench_now_ns (void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+
+/*!
+ * @brief Print one result line.
+ *
+ * @param[in] p_name Case name.
+ * @param[in] iterations Operations timed.
+ * @param[in] bytes Input bytes per operation (0 if not meaningful).
+ * @param[in] elapsed_ns Total time.
+ * @param[in] allocs Allocations made during the timed loop.
+ */
+static void
+bench_report (char const * p_name, uint32_t iterations, size_t bytes,
+              uint64_t elapsed_ns, unsigned long allocs)
+{
+    double per_op = (double)elapsed_ns / (double)iterations;
+
+    if (0u != bytes)
+    {
+        printf("%-30s %10.1f ns/op %8.2f ns/byte %6lu allocs\n",
+               p_name, per_op, per_op / (double)bytes, allocs);
+    }
+    else
+    {
+        printf("%-30s %10.1f ns/op %16s %6lu allocs\n",
+               p_name, per_op, "", allocs);
+    }
+}
+
+
+/*!
+ * @brief Fail the run with a message.
+ *
+ * @param[in] p_name Case name.
+ * @param[in] p_what What did not match.
+ */
+static void
+bench_fail (char const * p_name, char const * p_what)
+{
+    printf("FAIL %s: %s\n", p_name, p_what);
+    exit(1);
+}
+
+
+/*!
+ * @brief Trivial tokenized handler for the filler commands.
+ */
+static base_type
+bench_nop_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    cli_output_write(p_output, "ok\r\n", 4u);
+    g_sink += (uint32_t)p_args->argc;
+
+    return CLI_FALSE;
+}
+
+
+/*!
+ * @brief Streaming handler: as many "line NN" lines per chunk as fit.
+ */
+static base_type
+bench_stream_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    static uint32_t line = 0u;
+    size_t const start_length = p_output->length;
+
+    (void)p_args;
+
+    while (line < BENCH_STREAM_LINES)
+    {
+        if (((p_output->length + BENCH_STREAM_LINE_LEN) > p_output->size) &&
+            (start_length != p_output->length))
+        {
+            return CLI_TRUE;
+        }
+
+        cli_output_printf(p_output, "line %u%u\r\n",
+                          (unsigned)(line / 10u), (unsigned)(line % 10u));
+        line++;
+    }
+
+    line = 0u;
+
+    return CLI_FALSE;
+}
+
+
+/*!
+ * @brief Run one command line to completion into a scratch output.
+ *
+ * @param[in] p_line Null-terminated command line.
+ * @param[out] p_buffer Output storage of BENCH_OUTPUT_SIZE bytes.
+ *
+ * @return Length of the last chunk produced.
+ */
+static size_t
+bench_dispatch_once (char const * p_line, char * p_buffer)
+{
+    cli_output_t output;
+    base_type b_more = CLI_TRUE;
+
+    while (CLI_TRUE == b_more)
+    {
+        output.p_buffer = p_buffer;
+        output.size = BENCH_OUTPUT_SIZE;
+        output.length = 0u;
+        b_more = cli_process_command(p_line, &output);
+    }
+
+    return output.length;
+}
+
+
+/*!
+ * @brief Time cli_process_command() on one line, after checking its reply.
+ *
+ * @param[in] p_name Case name.
+ * @param[in] p_line Null-terminated command line.
+ * @param[in] p_expect Text the reply must contain.
+ * @param[in] iterations Operations to time.
+ */
+static void
+bench_dispatch (char const * p_name, char const * p_line,
+                char const * p_expect, uint32_t iterations)
+{
+    char buffer[BENCH_OUTPUT_SIZE + 1u];
+    size_t length = bench_dispatch_once(p_line, buffer);
+    unsigned long allocs = 0u;
+    uint64_t start = 0u;
+    uint32_t i = 0u;
+
+    buffer[length] = '\0';
+
+    if (NULL == strstr(buffer, p_expect))
+    {
+        bench_fail(p_name, buffer);
+    }
+
+    allocs = g_alloc_count;
+    start = bench_now_ns();
+
+    for (i = 0u; i < iterations; i++)
+    {
+        g_sink += (uint32_t)bench_dispatch_once(p_line, buffer);
+    }
+
+    bench_report(p_name, iterations, strlen(p_line),
+                 bench_now_ns() - start, g_alloc_count - allocs);
+}
+
+
+/*!
+ * @brief Time cli_tokenize() on a line using every argument slot.
+ *
+ * @param[in] iterations Operations to time.
+ */
+static void
+bench_tokenize (uint32_t iterations)
+{
+    static char const line[] = "set alpha bravo charlie delta echo foxtrot golf\r\n";
+    cli_args_t args;
+    unsigned long allocs = 0u;
+    uint64_t start = 0u;
+    uint32_t i = 0u;
+
+    if (((base_type)CLI_MAX_ARGS != cli_tokenize(line, &args)) ||
+        (4u != args.arglen[7]) || (0 != strncmp(args.argv[7], "golf", 4u)))
+    {
+        bench_fail("tokenize/max-args", "wrong tokens");
+    }
+
+    allocs = g_alloc_count;
+    start = bench_now_ns();
+
+    for (i = 0u; i < iterations; i++)
+    {
+        g_sink += (uint32_t)cli_tokenize(line, &args);
+    }
+
+    bench_report("tokenize/max-args", iterations, sizeof(line) - 1u,
+                 bench_now_ns() - start, g_alloc_count - allocs);
+}
+
+
+/*!
+ * @brief Time the legacy parameter walk over a long parameter list.
+ *
+ * A raw-line handler calls cli_get_parameter() once per parameter, each
+ * rescanning the line from the start; this fetches all of them.
+ *
+ * @param[in] iterations Operations to time.
+ */
+static void
+bench_get_parameter (uint32_t iterations)
+{
+    char line[256];
+    size_t used = 0u;
+    base_type count = 0;
+    base_type index = 0;
+    base_type length = 0;
+    char const * p_param = NULL;
+    unsigned long allocs = 0u;
+    uint64_t start = 0u;
+    uint32_t i = 0u;
+
+    used = (size_t)snprintf(line, sizeof(line), "cfg");
+
+    for (index = 0; index < 32; index++)
+    {
+        used += (size_t)snprintf(&line[used], sizeof(line) - used, " p%d", (int)index);
+    }
+
+    count = cli_get_parameter_count(line);
+    p_param = cli_get_parameter(line, 32, &length);
+
+    if ((32 != count) || (NULL == p_param) || (3 != length) ||
+        (0 != strncmp(p_param, "p31", 3u)))
+    {
+        bench_fail("get_parameter/32-params", "wrong parameter");
+    }
+
+    allocs = g_alloc_count;
+    start = bench_now_ns();
+
+    for (i = 0u; i < iterations; i++)
+    {
+        count = cli_get_parameter_count(line);
+
+        for (index = 1; index <= count; index++)
+        {
+            p_param = cli_get_parameter(line, index, &length);
+            g_sink += (uint32_t)length;
+        }
+    }
+
+    bench_report("get_parameter/32-params", iterations, used,
+                 bench_now_ns() - start, g_alloc_count - allocs);
+}
+
+
+/*!
+ * @brief Time jsmn_parse() on a payload, after checking the token count.
+ *
+ * @param[in] p_name Case name.
+ * @param[in] p_json Payload.
+ * @param[in] length Payload length.
+ * @param[in] expected_tokens Token count the payload must produce.
+ * @param[in] iterations Operations to time.
+ */
+static void
+bench_json (char const * p_name, char const * p_json, size_t length,
+            int32_t expected_tokens, uint32_t iterations)
+{
+    static jsmntok_t tokens[BENCH_MAX_TOKENS];
+    jsmn_parser_t parser;
+    int32_t result = 0;
+    unsigned long allocs = 0u;
+    uint64_t start = 0u;
+    uint32_t i = 0u;
+
+    jsmn_init(&parser);
+    result = jsmn_parse(&parser, p_json, length, tokens, BENCH_MAX_TOKENS);
+
+    if ((expected_tokens != result) ||
+        (expected_tokens != jsmn_count_tokens(p_json, length)))
+    {
+        bench_fail(p_name, "wrong token count");
+    }
+
+    allocs = g_alloc_count;
+    start = bench_now_ns();
+
+    for (i = 0u; i < iterations; i++)
+    {
+        jsmn_init(&parser);
+        g_sink += (uint32_t)jsmn_parse(&parser, p_json, length,
+                                       tokens, BENCH_MAX_TOKENS);
+    }
+
+    bench_report(p_name, iterations, length,
+                 bench_now_ns() - start, g_alloc_count - allocs);
+}
+
+
+/*!
+ * @brief Check that a JSON response streamed over several chunks is whole.
+ *
+ * Every escaped "out" string is decoded and appended; the result has to
+ * match what the handler wrote, line for line.
+ */
+static void
+bench_json_stream (void)
+{
+    static cli_command_definition_t const stream_command = {
+        "stream", "", NULL, 0, bench_stream_interpreter
+    };
+    static char const request[] = "{\"cmd\":\"stream\"}";
+    static char const out_key[] = "\"out\":\"";
+    char buffer[BENCH_OUTPUT_SIZE + 1u];
+    char expected[(BENCH_STREAM_LINES * BENCH_STREAM_LINE_LEN) + 1u];
+    char received[sizeof(expected)];
+    size_t received_length = 0u;
+    size_t consumed = 0u;
+    cli_output_t output;
+    base_type b_more = CLI_TRUE;
+    uint32_t chunks = 0u;
+    char const * p_text = NULL;
+    uint32_t line = 0u;
+
+    for (line = 0u; line < BENCH_STREAM_LINES; line++)
+    {
+        (void)snprintf(&expected[line * BENCH_STREAM_LINE_LEN], BENCH_STREAM_LINE_LEN + 1u,
+                       "line %02u\r\n", (unsigned)line);
+    }
+
+    (void)cli_set_command_table(&stream_command, 1u);
+    (void)cli_json_init();
+
+    if (CLI_JSON_FEED_DONE != cli_json_feed(request, sizeof(request) - 1u, &consumed))
+    {
+        bench_fail("json/stream", "request not accepted");
+    }
+
+    while (CLI_TRUE == b_more)
+    {
+        output.p_buffer = buffer;
+        output.size = BENCH_OUTPUT_SIZE;
+        output.length = 0u;
+        b_more = cli_json_process_command(&output);
+        buffer[output.length] = '\0';
+        chunks++;
+
+        p_text = strstr(buffer, out_key);
+
+        if (NULL == p_text)
+        {
+            bench_fail("json/stream", buffer);
+        }
+
+        /* Decode the escaped string up to its closing quote */
+        for (p_text += sizeof(out_key) - 1u; ('"' != *p_text) && ('\0' != *p_text); p_text++)
+        {
+            if ('\\' == *p_text)
+            {
+                p_text++;
+                received[received_length] = ('r' == *p_text) ? '\r' :
+                                            ('n' == *p_text) ? '\n' : *p_text;
+            }
+            else
+            {
+                received[received_length] = *p_text;
+            }
+
+            if (++received_length >= sizeof(received))
+            {
+                bench_fail("json/stream", "response too long");
+            }
+        }
+    }
+
+    received[received_length] = '\0';
+
+    if ((chunks < 2u) || (0 != strcmp(received, expected)))
+    {
+        bench_fail("json/stream", received);
+    }
+
+    printf("%-30s %u chunks, %u bytes intact\n", "json/stream",
+           (unsigned)chunks, (unsigned)received_length);
+}
+
+
+/*!
+ * @brief Time jsmn_path_extract(), after checking its results.
+ *
+ * Nested paths have to resolve, a path ending at an array and an absent
+ * key must not, and numbers at and just past the 32-bit limits must
+ * convert or be rejected exactly at the boundary.
+ *
+ * @param[in] iterations Operations to time.
+ */
+static void
+bench_json_path (uint32_t iterations)
+{
+    static jsmntok_t tokens[BENCH_MAX_TOKENS];
+    uint32_t const nested_count = (uint32_t)(sizeof(BENCH_PATH_NESTED) / sizeof(BENCH_PATH_NESTED[0]));
+    uint32_t const limits_count = (uint32_t)(sizeof(BENCH_PATH_LIMITS) / sizeof(BENCH_PATH_LIMITS[0]));
+    bench_path_result_t result;
+    jsmn_parser_t parser;
+    int32_t token_count = 0;
+    int32_t found = 0;
+    unsigned long allocs = 0u;
+    uint64_t start = 0u;
+    uint32_t i = 0u;
+
+    (void)memset(&result, 0, sizeof(result));
+    jsmn_init(&parser);
+    token_count = jsmn_parse(&parser, BENCH_JSON_LIMITS, sizeof(BENCH_JSON_LIMITS) - 1u,
+                             tokens, BENCH_MAX_TOKENS);
+    found = jsmn_path_extract(BENCH_JSON_LIMITS, tokens, token_count,
+                              BENCH_PATH_LIMITS, limits_count, &result);
+
+    if ((BENCH_PATH_LIMITS_FOUND != found) || (INT32_MIN != result.min) ||
+        (UINT32_MAX != result.umax))
+    {
+        bench_fail("jsmn/path-limits", "wrong limits");
+    }
+
+    jsmn_init(&parser);
+    token_count = jsmn_parse(&parser, BENCH_JSON_NESTED, sizeof(BENCH_JSON_NESTED) - 1u,
+                             tokens, BENCH_MAX_TOKENS);
+    found = jsmn_path_extract(BENCH_JSON_NESTED, tokens, token_count,
+                              BENCH_PATH_NESTED, nested_count, &result);
+
+    if ((BENCH_PATH_NESTED_FOUND != found) || (115200u != result.baud) ||
+        (1u != result.stop) || (-17 != result.seq) ||
+        (3u != result.cmd.length) || (0 != memcmp(result.cmd.p_data, "cfg", 3u)) ||
+        (0 != memcmp(result.name.p_data, "bench ", 6u)))
+    {
+        bench_fail("jsmn/path-nested", "wrong fields");
+    }
+
+    allocs = g_alloc_count;
+    start = bench_now_ns();
+
+    for (i = 0u; i < iterations; i++)
+    {
+        g_sink += (uint32_t)jsmn_path_extract(BENCH_JSON_NESTED, tokens, token_count,
+                                              BENCH_PATH_NESTED, nested_count, &result);
+    }
+
+    bench_report("jsmn/path-nested", iterations, sizeof(BENCH_JSON_NESTED) - 1u,
+                 bench_now_ns() - start, g_alloc_count - allocs);
+}
+
+
+/*!
+ * @brief Fill the command table with filler commands ahead of the built-ins.
+ *
+ * "cmdNNN" sorts before "get", "help" and "set", so the table stays in
+ * name order with the built-ins appended unchanged.
+ *
+ * @return Number of filler commands.
+ */
+static uint32_t
+bench_fill_command_table (void)
+{
+    uint32_t const fillers = BENCH_TABLE_COMMANDS - BENCH_BUILTIN_COMMANDS;
+    uint32_t added = 0u;
+
+    for (added = 0u; added < fillers; added++)
+    {
+        (void)snprintf(g_filler_names[added], BENCH_NAME_SIZE, "cmd%03u",
+                       (unsigned)added);
+        g_bench_commands[added].p_command = g_filler_names[added];
+        g_bench_commands[added].p_help_string = "";
+        g_bench_commands[added].p_command_interpreter = NULL;
+        g_bench_commands[added].expected_parameter_count = -1;
+        g_bench_commands[added].p_argv_interpreter = bench_nop_interpreter;
+    }
+
+    g_bench_commands[added] = g_get_command;
+    g_bench_commands[added + 1u] = g_help_command;
+    g_bench_commands[added + 2u] = g_set_command;
+
+    if (CLI_TRUE != cli_set_command_table(g_bench_commands, BENCH_TABLE_COMMANDS))
+    {
+        bench_fail("table/fill", g_filler_names[0]);
+    }
+
+    return added;
+}
+
+
+/*!
+ * @brief Array payload of n small objects, as a bulk reply would carry.
+ *
+ * @param[out] p_buffer Destination.
+ * @param[in] size Destination capacity.
+ * @param[in] count Array elements.
+ *
+ * @return Payload length.
+ */
+static size_t
+bench_make_array (char * p_buffer, size_t size, uint32_t count)
+{
+    size_t used = 0u;
+    uint32_t i = 0u;
+
+    used = (size_t)snprintf(p_buffer, size, "[");
+
+    for (i = 0u; i < count; i++)
+    {
+        used += (size_t)snprintf(&p_buffer[used], size - used,
+                                 "%s{\"k\":\"key%u\",\"v\":%u}",
+                                 (0u == i) ? "" : ",", (unsigned)i, (unsigned)(i * 7u));
+    }
+
+    used += (size_t)snprintf(&p_buffer[used], size - used, "]");
+
+    return used;
+}
+
+
+/*!
+ * @brief Benchmark entry point.
+ *
+ * @param[in] argc Argument count.
+ * @param[in] argv argv[1] optionally overrides the iteration count.
+ *
+ * @return 0 if every case produced the expected result, 1 otherwise.
+ */
+int
+main (int argc, char ** argv)
+{
+    static char array_json[4096];
+    uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+    size_t array_length = 0u;
+    char last_command[32];
+
+    if (argc > 1)
+    {
+        iterations = (uint32_t)strtoul(argv[1], NULL, 10);
+
+        if (0u == iterations)
+        {
+            iterations = 1u;
+        }
+    }
+
+    printf("host-bench: %u iterations per case, %u-command table\n",
+           (unsigned)iterations, (unsigned)BENCH_TABLE_COMMANDS);
+
+    /* Small table: the built-in commands only, in name order */
+    g_bench_commands[0] = g_get_command;
+    g_bench_commands[1] = g_help_command;
+    g_bench_commands[2] = g_set_command;
+    (void)cli_set_command_table(g_bench_commands, BENCH_BUILTIN_COMMANDS);
+    (void)kv_init();
+    (void)kv_set("led", 3u, "on", 2u);
+
+    bench_dispatch("dispatch/3-cmds/get", "get led\r\n", "Get led: on", iterations);
+    bench_dispatch("dispatch/3-cmds/set", "set led on\r\n", "led", iterations);
+    bench_dispatch("dispatch/3-cmds/unknown", "nosuch\r\n", "not recognized", iterations);
+
+    /* Full table: lookups have to search every registered name */
+    (void)snprintf(last_command, sizeof(last_command), "cmd%03u a b c\r\n",
+                   (unsigned)(bench_fill_command_table() - 1u));
+
+    bench_dispatch("dispatch/full/get", "get led\r\n", "Get led: on", iterations);
+    bench_dispatch("dispatch/full/last", last_command, "ok", iterations);
+    bench_dispatch("dispatch/full/unknown", "zzz\r\n", "not recognized", iterations);
+
+    /* Argument handling */
+    bench_tokenize(iterations);
+    bench_get_parameter(iterations / 10u + 1u);
+
+    /* JSON payloads */
+    bench_json("jsmn/request", BENCH_JSON_REQUEST, sizeof(BENCH_JSON_REQUEST) - 1u,
+               7, iterations);
+    bench_json("jsmn/nested", BENCH_JSON_NESTED, sizeof(BENCH_JSON_NESTED) - 1u,
+               25, iterations);
+    array_length = bench_make_array(array_json, sizeof(array_json), 50u);
+    bench_json("jsmn/array-50", array_json, array_length, 251, iterations / 10u + 1u);
+    bench_json_path(iterations);
+
+    /* Chunked JSON responses */
+    bench_json_stream();
+
+    return 0;
+}
+
+/*** end of file ***/
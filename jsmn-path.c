@@ -0,0 +1,325 @@
+/** @file jsmn-path.c
+ *
+ * @brief Extract fields from a jsmn token list by key path in one pass.
+ *
+ * jsmn stores tokens in document order and gives every container its
+ * child count, so a stack of "children left" counters is enough to know
+ * the nesting of each token without parent links. For every requested
+ * field the walk keeps the number of leading path segments matched by the
+ * current chain of keys; a key is only compared against fields whose
+ * prefix already matches at its level.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "jsmn-path.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JSMN_PATH_SEPARATOR     '.'
+
+/**
+ * @brief Open container during the walk.
+ */
+typedef struct jsmn_path_frame
+{
+    int32_t remaining;          /**< Children not visited yet */
+    uint8_t b_object;           /**< Children are key/value pairs */
+} jsmn_path_frame_t;
+
+
+/*!
+ * @brief Locate segment `index` of a dotted path.
+ *
+ * @param[in] p_path Dotted path.
+ * @param[in] index Zero-based segment number.
+ * @param[out] p_length Segment length.
+ *
+ * @return Segment start, or NULL if the path has fewer segments.
+ */
+static char const *
+jsmn_path_segment (char const * p_path, uint32_t index, size_t * p_length)
+{
+    char const * p_end = NULL;
+
+    while (0u != index)
+    {
+        p_path = strchr(p_path, JSMN_PATH_SEPARATOR);
+
+        if (NULL == p_path)
+        {
+            return NULL;
+        }
+
+        p_path++;
+        index--;
+    }
+
+    p_end = strchr(p_path, JSMN_PATH_SEPARATOR);
+    *p_length = (NULL != p_end) ? (size_t)(p_end - p_path) : strlen(p_path);
+
+    return p_path;
+}
+
+
+/*!
+ * @brief Convert decimal text in place.
+ *
+ * @param[in] p_text Digits (optional leading '-' when b_signed).
+ * @param[in] length Text length.
+ * @param[in] b_signed Accept a sign and the int32_t range.
+ * @param[out] p_value Result, as uint32_t bits.
+ *
+ * @return 0 on success, -1 on bad syntax or overflow.
+ */
+static int32_t
+jsmn_path_parse_number (char const * p_text, size_t length,
+                        uint8_t b_signed, uint32_t * p_value)
+{
+    uint32_t value = 0u;
+    uint32_t limit = UINT32_MAX;
+    uint8_t b_negative = 0u;
+    size_t index = 0u;
+    uint32_t digit = 0u;
+
+    if (b_signed && (length > 0u) && ('-' == p_text[0]))
+    {
+        b_negative = 1u;
+        index = 1u;
+    }
+
+    if (b_signed)
+    {
+        limit = b_negative ? 0x80000000u : 0x7FFFFFFFu;
+    }
+
+    if (index == length)
+    {
+        return -1;
+    }
+
+    for (; index < length; index++)
+    {
+        if ((p_text[index] < '0') || (p_text[index] > '9'))
+        {
+            return -1;
+        }
+
+        digit = (uint32_t)(p_text[index] - '0');
+
+        if (value > ((limit - digit) / 10u))
+        {
+            return -1;
+        }
+
+        value = (value * 10u) + digit;
+    }
+
+    *p_value = b_negative ? (0u - value) : value;
+
+    return 0;
+}
+
+
+/*!
+ * @brief Convert a matched value token into its destination member.
+ *
+ * @return 0 if stored, -1 if the value does not convert.
+ */
+static int32_t
+jsmn_path_store (char const * p_js, jsmntok_t const * p_token,
+                 jsmn_path_field_t const * p_field, void * p_dest)
+{
+    char const * p_text = &p_js[p_token->start];
+    size_t length = (size_t)(p_token->end - p_token->start);
+    uint8_t * p_member = (uint8_t *)p_dest + p_field->offset;
+    jsmn_path_string_t text;
+    uint32_t number = 0u;
+    uint8_t flag = 0u;
+
+    if ((JSMN_STRING != p_token->type) && (JSMN_PRIMITIVE != p_token->type))
+    {
+        return -1;
+    }
+
+    switch (p_field->kind)
+    {
+        case JSMN_PATH_STRING:
+        {
+            text.p_data = p_text;
+            text.length = (uint16_t)length;
+            (void)memcpy(p_member, &text, sizeof(text));
+            break;
+        }
+
+        case JSMN_PATH_INT:
+        case JSMN_PATH_UINT:
+        {
+            if (0 != jsmn_path_parse_number(p_text, length,
+                                            (JSMN_PATH_INT == p_field->kind) ? 1u : 0u,
+                                            &number))
+            {
+                return -1;
+            }
+
+            (void)memcpy(p_member, &number, sizeof(number));
+            break;
+        }
+
+        case JSMN_PATH_BOOL:
+        default:
+        {
+            if ((4u == length) && (0 == memcmp(p_text, "true", 4u)))
+            {
+                flag = 1u;
+            }
+            else if ((5u != length) || (0 != memcmp(p_text, "false", 5u)))
+            {
+                return -1;
+            }
+
+            *p_member = flag;
+            break;
+        }
+    }
+
+    return 0;
+}
+
+
+/*!
+ * @brief Resolve a set of key paths in one pass over the tokens.
+ *
+ * @param[in] p_js Document the tokens refer to.
+ * @param[in] p_tokens Tokens from jsmn_parse(); the first must be an object.
+ * @param[in] token_count Number of tokens.
+ * @param[in] p_fields Requested fields (at most JSMN_PATH_MAX_FIELDS).
+ * @param[in] field_count Number of requested fields.
+ * @param[out] p_dest Struct the field offsets refer to.
+ *
+ * @return Bit mask of the fields found and converted (bit n = p_fields[n]),
+ *         or a negative JSMN_PATH_ERROR_* code.
+ */
+int32_t
+jsmn_path_extract (char const * p_js,
+                   jsmntok_t const * p_tokens,
+                   int32_t token_count,
+                   jsmn_path_field_t const * p_fields,
+                   uint32_t field_count,
+                   void * p_dest)
+{
+    jsmn_path_frame_t frames[JSMN_PATH_MAX_DEPTH];
+    uint8_t matched[JSMN_PATH_MAX_FIELDS];
+    uint32_t level = 0u;
+    uint32_t field = 0u;
+    uint32_t found = 0u;
+    int32_t index = 1;
+    int32_t key = -1;
+    jsmntok_t const * p_value = NULL;
+    jsmn_path_frame_t * p_top = NULL;
+    char const * p_segment = NULL;
+    size_t segment_length = 0u;
+    size_t dummy_length = 0u;
+
+    if ((NULL == p_js) || (NULL == p_tokens) || (NULL == p_fields) ||
+        (NULL == p_dest) || (token_count < 1) ||
+        (field_count > JSMN_PATH_MAX_FIELDS) || (JSMN_OBJECT != p_tokens[0].type))
+    {
+        return JSMN_PATH_ERROR_INVAL;
+    }
+
+    (void)memset(matched, 0, sizeof(matched));
+    frames[0].remaining = (int32_t)p_tokens[0].size;
+    frames[0].b_object = 1u;
+    level = 1u;
+
+    while ((index < token_count) && (level > 0u))
+    {
+        p_top = &frames[level - 1u];
+
+        if (0 == p_top->remaining)
+        {
+            /* Container finished */
+            level--;
+            continue;
+        }
+
+        p_top->remaining--;
+        key = -1;
+
+        if (p_top->b_object)
+        {
+            /* Key at this level: drop the sibling's match, then try this key */
+            key = index;
+
+            for (field = 0u; field < field_count; field++)
+            {
+                if (matched[field] >= level)
+                {
+                    matched[field] = (uint8_t)(level - 1u);
+                }
+
+                if (matched[field] == (level - 1u))
+                {
+                    p_segment = jsmn_path_segment(p_fields[field].p_path,
+                                                  level - 1u, &segment_length);
+
+                    if ((NULL != p_segment) &&
+                        (segment_length == (size_t)(p_tokens[key].end - p_tokens[key].start)) &&
+                        (0 == memcmp(p_segment, &p_js[p_tokens[key].start], segment_length)))
+                    {
+                        matched[field] = (uint8_t)level;
+                    }
+                }
+            }
+
+            index++;
+
+            if (index >= token_count)
+            {
+                break;
+            }
+        }
+
+        p_value = &p_tokens[index];
+        index++;
+
+        if ((JSMN_OBJECT == p_value->type) || (JSMN_ARRAY == p_value->type))
+        {
+            if (level >= JSMN_PATH_MAX_DEPTH)
+            {
+                return JSMN_PATH_ERROR_DEPTH;
+            }
+
+            frames[level].remaining = (int32_t)p_value->size;
+            frames[level].b_object = (JSMN_OBJECT == p_value->type) ? 1u : 0u;
+            level++;
+            continue;
+        }
+
+        /* Scalar under a key: store it for every fully matched path */
+        for (field = 0u; (key >= 0) && (field < field_count); field++)
+        {
+            if ((matched[field] == level) &&
+                (NULL == jsmn_path_segment(p_fields[field].p_path, level, &dummy_length)) &&
+                (0 == jsmn_path_store(p_js, p_value, &p_fields[field], p_dest)))
+            {
+                found |= (1u << field);
+            }
+        }
+    }
+
+    return (int32_t)found;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
@@ -0,0 +1,87 @@
+/** @file jsmn-path.h
+ *
+ * @brief Extract fields from a jsmn token list by key path in one pass.
+ *
+ * The caller describes the wanted fields with dotted key paths and the
+ * offset of each destination member inside its own struct:
+ *
+ *   typedef struct { jsmn_path_string_t cmd; uint32_t baud; } request_t;
+ *
+ *   static jsmn_path_field_t const fields[] = {
+ *       { "cmd",           JSMN_PATH_STRING, offsetof(request_t, cmd)  },
+ *       { "cfg.uart.baud", JSMN_PATH_UINT,   offsetof(request_t, baud) },
+ *   };
+ *
+ * jsmn_path_extract() walks the tokens once, tracking for every field how
+ * much of its path the current key nesting matches, and stores each value
+ * as it passes. Numbers are converted straight from the document text.
+ * Paths run through objects only; array contents are skipped.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef JSMN_PATH_H
+#define JSMN_PATH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "jsmn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Limits (fields per call, object nesting followed) */
+#define JSMN_PATH_MAX_FIELDS     16u
+#define JSMN_PATH_MAX_DEPTH      8u
+
+/* Return codes */
+#define JSMN_PATH_ERROR_INVAL    ((int32_t)-1)   /* Bad arguments or root not an object */
+#define JSMN_PATH_ERROR_DEPTH    ((int32_t)-2)   /* Nesting deeper than JSMN_PATH_MAX_DEPTH */
+
+/**
+ * @brief Conversion applied to a matched value.
+ */
+typedef enum
+{
+    JSMN_PATH_STRING = 0,       /**< jsmn_path_string_t view of the text */
+    JSMN_PATH_INT,              /**< int32_t, decimal with optional '-' */
+    JSMN_PATH_UINT,             /**< uint32_t, decimal */
+    JSMN_PATH_BOOL              /**< uint8_t, from true / false */
+} jsmn_path_kind_t;
+
+/**
+ * @brief String result: points into the document, not null-terminated.
+ */
+typedef struct jsmn_path_string
+{
+    char const * p_data;
+    uint16_t length;
+} jsmn_path_string_t;
+
+/**
+ * @brief One requested field.
+ */
+typedef struct jsmn_path_field
+{
+    char const * p_path;        /**< Dotted key path, e.g. "cfg.uart.baud" */
+    jsmn_path_kind_t kind;      /**< Destination type */
+    size_t offset;              /**< offsetof() the destination member */
+} jsmn_path_field_t;
+
+/* Public API functions */
+int32_t jsmn_path_extract(char const * p_js,
+                          jsmntok_t const * p_tokens,
+                          int32_t token_count,
+                          jsmn_path_field_t const * p_fields,
+                          uint32_t field_count,
+                          void * p_dest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSMN_PATH_H */
+
+/*** end of file ***/
@@ -82,8 +82,8 @@ jsmn_alloc_token (jsmn_parser_t * p_parser, jsmntok_t * p_tokens,
         p_tok = &p_tokens[p_parser->toknext];
         p_parser->toknext++;
         
-        p_tok->start = -1;
-        p_tok->end = -1;
+        p_tok->start = JSMN_OFFSET_UNSET;
+        p_tok->end = JSMN_OFFSET_UNSET;
         p_tok->size = 0;
 #ifdef JSMN_PARENT_LINKS
         p_tok->parent = -1;
@@ -107,8 +107,8 @@ jsmn_fill_token (jsmntok_t * p_token, jsmntype_t const type,
                  int32_t const start, int32_t const end)
 {
     p_token->type = type;
-    p_token->start = start;
-    p_token->end = end;
+    p_token->start = (jsmn_offset_t)start;
+    p_token->end = (jsmn_offset_t)end;
     p_token->size = 0;
 }
 
@@ -181,6 +181,14 @@ jsmn_parse_primitive (jsmn_parser_t * p_parser, char const * const p_js,
         p_parser->pos = start;
         return JSMN_ERROR_PART;
     }
+#else
+    /* Input ended inside a nested primitive: more may arrive in the next
+     * chunk, so report a partial parse rather than cut the token short */
+    if ((!b_found) && (p_parser->pos >= len) && (-1 != p_parser->toksuper))
+    {
+        p_parser->pos = start;
+        return JSMN_ERROR_PART;
+    }
 #endif
 
     if (NULL == p_tokens)
@@ -201,7 +209,7 @@ jsmn_parse_primitive (jsmn_parser_t * p_parser, char const * const p_js,
                     (int32_t)p_parser->pos);
                     
 #ifdef JSMN_PARENT_LINKS
-    p_token->parent = p_parser->toksuper;
+    p_token->parent = (jsmn_index_t)p_parser->toksuper;
 #endif
     
     p_parser->pos--;
@@ -257,7 +265,7 @@ jsmn_parse_string (jsmn_parser_t * p_parser, char const * const p_js,
                            (int32_t)p_parser->pos);
                            
 #ifdef JSMN_PARENT_LINKS
-            p_token->parent = p_parser->toksuper;
+            p_token->parent = (jsmn_index_t)p_parser->toksuper;
 #endif
             return 0;
         }
@@ -350,6 +358,14 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
     int32_t count = (int32_t)p_parser->toknext;
     jsmntype_t type;
 
+#ifdef JSMN_COMPACT_TOKENS
+    /* Offsets must fit in 16 bits, with the unset marker reserved */
+    if (len > JSMN_MAX_DOCUMENT_SIZE)
+    {
+        return JSMN_ERROR_INVAL;
+    }
+#endif
+
     for (; (p_parser->pos < len) && (CHAR_NULL != p_js[p_parser->pos]); 
          p_parser->pos++)
     {
@@ -388,12 +404,12 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
                     p_t->size++;
                     
 #ifdef JSMN_PARENT_LINKS
-                    p_token->parent = p_parser->toksuper;
+                    p_token->parent = (jsmn_index_t)p_parser->toksuper;
 #endif
                 }
                 
                 p_token->type = (CHAR_BRACE_OPEN == c) ? JSMN_OBJECT : JSMN_ARRAY;
-                p_token->start = (int32_t)p_parser->pos;
+                p_token->start = (jsmn_offset_t)p_parser->pos;
                 p_parser->toksuper = (int32_t)(p_parser->toknext - 1u);
                 break;
             }
@@ -418,14 +434,14 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
                 
                 for (;;)
                 {
-                    if ((-1 != p_token->start) && (-1 == p_token->end))
+                    if ((JSMN_OFFSET_UNSET != p_token->start) && (JSMN_OFFSET_UNSET == p_token->end))
                     {
                         if (type != p_token->type)
                         {
                             return JSMN_ERROR_INVAL;
                         }
                         
-                        p_token->end = (int32_t)(p_parser->pos + 1u);
+                        p_token->end = (jsmn_offset_t)(p_parser->pos + 1u);
                         p_parser->toksuper = p_token->parent;
                         break;
                     }
@@ -446,7 +462,7 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
                 {
                     p_token = &p_tokens[i];
                     
-                    if ((-1 != p_token->start) && (-1 == p_token->end))
+                    if ((JSMN_OFFSET_UNSET != p_token->start) && (JSMN_OFFSET_UNSET == p_token->end))
                     {
                         if (type != p_token->type)
                         {
@@ -454,7 +470,7 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
                         }
                         
                         p_parser->toksuper = -1;
-                        p_token->end = (int32_t)(p_parser->pos + 1u);
+                        p_token->end = (jsmn_offset_t)(p_parser->pos + 1u);
                         break;
                     }
                 }
@@ -469,7 +485,7 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
                 {
                     p_token = &p_tokens[i];
                     
-                    if ((-1 != p_token->start) && (-1 == p_token->end))
+                    if ((JSMN_OFFSET_UNSET != p_token->start) && (JSMN_OFFSET_UNSET == p_token->end))
                     {
                         p_parser->toksuper = i;
                         break;
@@ -526,8 +542,8 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
                         if ((JSMN_ARRAY == p_tokens[i].type) || 
                             (JSMN_OBJECT == p_tokens[i].type))
                         {
-                            if ((-1 != p_tokens[i].start) && 
-                                (-1 == p_tokens[i].end))
+                            if ((JSMN_OFFSET_UNSET != p_tokens[i].start) && 
+                                (JSMN_OFFSET_UNSET == p_tokens[i].end))
                             {
                                 p_parser->toksuper = i;
                                 break;
@@ -603,7 +619,7 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
         for (i = (int32_t)(p_parser->toknext - 1u); i >= 0; i--)
         {
             /* Unmatched opened object or array */
-            if ((-1 != p_tokens[i].start) && (-1 == p_tokens[i].end))
+            if ((JSMN_OFFSET_UNSET != p_tokens[i].start) && (JSMN_OFFSET_UNSET == p_tokens[i].end))
             {
                 return JSMN_ERROR_PART;
             }
@@ -614,6 +630,29 @@ jsmn_parse (jsmn_parser_t * p_parser, char const * const p_js,
 }
 
 
+/*!
+ * @brief Count the tokens in a complete JSON document.
+ *
+ * Runs the parser without a token array, which only counts. The result is
+ * the exact pool size jsmn_parse() needs for the same document, so a pool
+ * can be taken from an arena instead of being over-allocated.
+ *
+ * @param[in] p_js Pointer to JSON string.
+ * @param[in] len Length of JSON string.
+ *
+ * @return Number of tokens, or a negative error code.
+ */
+JSMN_API int32_t
+jsmn_count_tokens (char const * const p_js, size_t const len)
+{
+    jsmn_parser_t parser;
+
+    jsmn_init(&parser);
+
+    return jsmn_parse(&parser, p_js, len, NULL, 0u);
+}
+
+
 /*!
  * @brief Initialize JSMN parser to default state.
  *
@@ -71,6 +71,25 @@ enum jsmnerr
     JSMN_ERROR_PART = -3    /* The string is not a full JSON packet */
 };
 
+/**
+ * Token field types. With JSMN_COMPACT_TOKENS offsets and sizes are 16 bits
+ * and the type 8 bits, so a token takes 8 bytes instead of 16 (10 instead
+ * of 20 with JSMN_PARENT_LINKS); documents are then limited to
+ * JSMN_MAX_DOCUMENT_SIZE bytes. An unset offset is JSMN_OFFSET_UNSET.
+ */
+#ifdef JSMN_COMPACT_TOKENS
+typedef uint16_t jsmn_offset_t;
+typedef int16_t jsmn_index_t;
+typedef uint8_t jsmn_type_field_t;
+#define JSMN_OFFSET_UNSET       ((jsmn_offset_t)0xFFFFu)
+#define JSMN_MAX_DOCUMENT_SIZE  0xFFFEu
+#else
+typedef int32_t jsmn_offset_t;
+typedef int32_t jsmn_index_t;
+typedef jsmntype_t jsmn_type_field_t;
+#define JSMN_OFFSET_UNSET       ((jsmn_offset_t)-1)
+#endif
+
 /**
  * JSON token description.
  * type     type (object, array, string etc.)
@@ -80,12 +99,12 @@ enum jsmnerr
  */
 typedef struct jsmntok
 {
-    jsmntype_t type;
-    int32_t start;
-    int32_t end;
-    int32_t size;
+    jsmn_type_field_t type;
+    jsmn_offset_t start;
+    jsmn_offset_t end;
+    jsmn_offset_t size;
 #ifdef JSMN_PARENT_LINKS
-    int32_t parent;
+    jsmn_index_t parent;
 #endif
 } jsmntok_t;
 
@@ -115,6 +134,12 @@ JSMN_API int32_t jsmn_parse(jsmn_parser_t * p_parser,
                             jsmntok_t * p_tokens, 
                             uint32_t const num_tokens);
 
+/**
+ * Count the tokens of a complete document without storing any, so a pool
+ * of exactly the right size can be allocated before jsmn_parse().
+ */
+JSMN_API int32_t jsmn_count_tokens(char const * const p_js, size_t const len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,394 @@
+/** @file kv-flash.c
+ *
+ * @brief Wear-levelled flash snapshots of the key-value store.
+ *
+ * Snapshots are appended as records to a log spread over the pages of the
+ * kvflash region (see Linker.ld). Each record carries a sequence number
+ * and a CRC; the valid record with the highest sequence number wins. A new
+ * record goes right after the newest one, and only when a page is full,
+ * or a torn record blocks the slot, is the next page (round robin) erased,
+ * so every page wears equally and the newest record is never erased
+ * before its successor is complete.
+ *
+ * Record layout (8-byte aligned):
+ *   header  magic, sequence, payload length, CRC16 over sequence..payload
+ *   payload per entry: key length, value length, key bytes, value bytes
+ *
+ * The payload is programmed before the header, so a record interrupted by
+ * a reset never looks valid.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "kv-flash.h"
+#include "kv-store.h"
+#include "flash.h"
+#include "crc16.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Record constants */
+#define KV_FLASH_MAGIC          0x3153564Bu     /* "KVS1" */
+#define KV_FLASH_ERASED         0xFFu
+#define KV_FLASH_ENTRY_OVERHEAD 2u              /* key length + value length */
+
+/* Linker Script Symbol Declarations (kvflash region) */
+extern uint32_t _kv_flash_start;
+extern uint32_t _kv_flash_end;
+
+/**
+ * @brief Snapshot record header.
+ */
+typedef struct kv_flash_header
+{
+    uint32_t magic;             /**< KV_FLASH_MAGIC */
+    uint32_t sequence;          /**< Incremented per snapshot */
+    uint16_t length;            /**< Payload bytes */
+    uint16_t crc;               /**< CRC16 over sequence, length and payload */
+    uint32_t reserved;          /**< Pads the header to two double words */
+} kv_flash_header_t;
+
+/**
+ * @brief Streaming payload programmer (one double word staged in RAM).
+ */
+typedef struct kv_flash_writer
+{
+    uint32_t address;           /**< Next flash address to program */
+    uint8_t staging[FLASH_PROGRAM_UNIT];
+    uint32_t fill;              /**< Bytes in staging */
+    int32_t result;             /**< First programming error, 0 if none */
+} kv_flash_writer_t;
+
+/**
+ * @brief Result of scanning the snapshot log.
+ */
+typedef struct kv_flash_scan
+{
+    kv_flash_header_t const * p_newest;   /**< Newest valid record or NULL */
+    uint32_t append_address;              /**< First byte after p_newest */
+} kv_flash_scan_t;
+
+
+/*!
+ * @brief Round a payload length up to whole double words.
+ */
+static uint32_t
+kv_flash_align (uint32_t length)
+{
+    return ((length + (FLASH_PROGRAM_UNIT - 1u)) / FLASH_PROGRAM_UNIT) *
+           FLASH_PROGRAM_UNIT;
+}
+
+
+/*!
+ * @brief CRC of a record as stored (header fields plus payload).
+ */
+static uint16_t
+kv_flash_record_crc (kv_flash_header_t const * p_header, void const * p_payload)
+{
+    uint16_t crc = crc16_update(CRC16_INIT, &p_header->sequence,
+                                sizeof(p_header->sequence));
+
+    crc = crc16_update(crc, &p_header->length, sizeof(p_header->length));
+
+    return crc16_update(crc, p_payload, p_header->length);
+}
+
+
+/*!
+ * @brief Find the newest valid record in the log.
+ *
+ * @param[out] p_scan Newest record and the address following it.
+ */
+static void
+kv_flash_scan_log (kv_flash_scan_t * p_scan)
+{
+    uint32_t const start = (uint32_t)(uintptr_t)&_kv_flash_start;
+    uint32_t const end = (uint32_t)(uintptr_t)&_kv_flash_end;
+    uint32_t page = 0u;
+    uint32_t address = 0u;
+    kv_flash_header_t const * p_header = NULL;
+
+    p_scan->p_newest = NULL;
+    p_scan->append_address = start;
+
+    for (page = start; page < end; page += FLASH_PAGE_SIZE)
+    {
+        address = page;
+
+        while ((address + sizeof(kv_flash_header_t)) <= (page + FLASH_PAGE_SIZE))
+        {
+            p_header = (kv_flash_header_t const *)(uintptr_t)address;
+
+            if ((KV_FLASH_MAGIC != p_header->magic) ||
+                ((address + sizeof(kv_flash_header_t) + p_header->length) >
+                 (page + FLASH_PAGE_SIZE)) ||
+                (p_header->crc != kv_flash_record_crc(p_header, &p_header[1])))
+            {
+                break;
+            }
+
+            address += (uint32_t)sizeof(kv_flash_header_t) +
+                       kv_flash_align(p_header->length);
+
+            if ((NULL == p_scan->p_newest) ||
+                (p_header->sequence > p_scan->p_newest->sequence))
+            {
+                p_scan->p_newest = p_header;
+                p_scan->append_address = address;
+            }
+        }
+    }
+}
+
+
+/*!
+ * @brief Check that a flash range is still erased.
+ */
+static int32_t
+kv_flash_is_blank (uint32_t address, uint32_t length)
+{
+    uint8_t const * p_byte = (uint8_t const *)(uintptr_t)address;
+
+    while (length > 0u)
+    {
+        if (KV_FLASH_ERASED != *p_byte)
+        {
+            return 0;
+        }
+
+        p_byte++;
+        length--;
+    }
+
+    return 1;
+}
+
+
+/*!
+ * @brief Add payload bytes to the streaming programmer.
+ */
+static void
+kv_flash_emit (kv_flash_writer_t * p_writer, void const * p_data, uint32_t len)
+{
+    uint8_t const * p_byte = (uint8_t const *)p_data;
+
+    while ((len > 0u) && (0 == p_writer->result))
+    {
+        p_writer->staging[p_writer->fill] = *p_byte;
+        p_writer->fill++;
+        p_byte++;
+        len--;
+
+        if (FLASH_PROGRAM_UNIT == p_writer->fill)
+        {
+            p_writer->result = flash_program(p_writer->address,
+                                             p_writer->staging,
+                                             FLASH_PROGRAM_UNIT);
+            p_writer->address += FLASH_PROGRAM_UNIT;
+            p_writer->fill = 0u;
+        }
+    }
+}
+
+
+/*!
+ * @brief Restore the key-value store from the newest valid snapshot.
+ *
+ * @param[out] p_sequence Sequence number of the loaded snapshot (may be NULL).
+ *
+ * @return KV_FLASH_OK, or KV_FLASH_ERROR_EMPTY if no valid snapshot exists.
+ */
+int32_t
+kv_flash_load (uint32_t * p_sequence)
+{
+    kv_flash_scan_t scan;
+    uint8_t const * p_payload = NULL;
+    uint32_t offset = 0u;
+    uint32_t key_len = 0u;
+    uint32_t value_len = 0u;
+
+    kv_flash_scan_log(&scan);
+
+    if (NULL == scan.p_newest)
+    {
+        return KV_FLASH_ERROR_EMPTY;
+    }
+
+    kv_clear();
+    p_payload = (uint8_t const *)&scan.p_newest[1];
+
+    while ((offset + KV_FLASH_ENTRY_OVERHEAD) <= scan.p_newest->length)
+    {
+        key_len = p_payload[offset];
+        value_len = p_payload[offset + 1u];
+        offset += KV_FLASH_ENTRY_OVERHEAD;
+
+        if ((offset + key_len + value_len) > scan.p_newest->length)
+        {
+            break;
+        }
+
+        (void)kv_set((char const *)&p_payload[offset], key_len,
+                     (char const *)&p_payload[offset + key_len], value_len);
+        offset += key_len + value_len;
+    }
+
+    if (NULL != p_sequence)
+    {
+        *p_sequence = scan.p_newest->sequence;
+    }
+
+    return KV_FLASH_OK;
+}
+
+
+/*!
+ * @brief Append a snapshot of the key-value store to the flash log.
+ *
+ * @param[out] p_sequence Sequence number of the new snapshot (may be NULL).
+ *
+ * @return KV_FLASH_OK, or KV_FLASH_ERROR_WRITE on erase/program failure.
+ */
+int32_t
+kv_flash_save (uint32_t * p_sequence)
+{
+    uint32_t const start = (uint32_t)(uintptr_t)&_kv_flash_start;
+    uint32_t const end = (uint32_t)(uintptr_t)&_kv_flash_end;
+    kv_flash_scan_t scan;
+    kv_flash_header_t header;
+    kv_flash_writer_t writer;
+    uint32_t index = 0u;
+    uint32_t record_size = 0u;
+    uint32_t page = 0u;
+    uint32_t newest_page = 0u;
+    char const * p_key = NULL;
+    char const * p_value = NULL;
+    size_t key_len = 0u;
+    size_t value_len = 0u;
+    uint8_t lengths[KV_FLASH_ENTRY_OVERHEAD];
+    uint8_t const padding[FLASH_PROGRAM_UNIT] = { 0u };
+
+    kv_flash_scan_log(&scan);
+
+    /* Pass 1: payload length and CRC */
+    (void)memset(&header, 0, sizeof(header));
+    header.magic = KV_FLASH_MAGIC;
+    header.sequence = (NULL != scan.p_newest) ? (scan.p_newest->sequence + 1u) : 1u;
+
+    for (index = 0u;
+         KV_OK == kv_get_entry(index, &p_key, &key_len, &p_value, &value_len);
+         index++)
+    {
+        header.length = (uint16_t)(header.length + KV_FLASH_ENTRY_OVERHEAD +
+                                   key_len + value_len);
+    }
+
+    header.crc = crc16_update(CRC16_INIT, &header.sequence, sizeof(header.sequence));
+    header.crc = crc16_update(header.crc, &header.length, sizeof(header.length));
+
+    for (index = 0u;
+         KV_OK == kv_get_entry(index, &p_key, &key_len, &p_value, &value_len);
+         index++)
+    {
+        lengths[0] = (uint8_t)key_len;
+        lengths[1] = (uint8_t)value_len;
+        header.crc = crc16_update(header.crc, lengths, sizeof(lengths));
+        header.crc = crc16_update(header.crc, p_key, key_len);
+        header.crc = crc16_update(header.crc, p_value, value_len);
+    }
+
+    /* Pick the append position; move to the next page when this one is full */
+    record_size = (uint32_t)sizeof(header) + kv_flash_align(header.length);
+    page = start;
+
+    if (NULL != scan.p_newest)
+    {
+        /* Page holding the newest record (append_address may be its end) */
+        page += ((((uint32_t)(uintptr_t)scan.p_newest) - start) / FLASH_PAGE_SIZE) *
+                FLASH_PAGE_SIZE;
+    }
+
+    newest_page = page;
+
+    if ((NULL != scan.p_newest) &&
+        ((scan.append_address + record_size) > (page + FLASH_PAGE_SIZE)))
+    {
+        page += FLASH_PAGE_SIZE;
+
+        if (page >= end)
+        {
+            page = start;
+        }
+
+        scan.append_address = page;
+    }
+
+    if (!kv_flash_is_blank(scan.append_address, record_size))
+    {
+        /* A torn record behind the newest one: never erase the page that
+           holds the newest, start the next (oldest) page instead */
+        if ((NULL != scan.p_newest) && (page == newest_page))
+        {
+            page += FLASH_PAGE_SIZE;
+
+            if (page >= end)
+            {
+                page = start;
+            }
+        }
+
+        if (0 != flash_erase_page(page))
+        {
+            return KV_FLASH_ERROR_WRITE;
+        }
+
+        scan.append_address = page;
+    }
+
+    /* Pass 2: stream the payload behind the header position */
+    (void)memset(&writer, 0, sizeof(writer));
+    writer.address = scan.append_address + (uint32_t)sizeof(header);
+
+    for (index = 0u;
+         KV_OK == kv_get_entry(index, &p_key, &key_len, &p_value, &value_len);
+         index++)
+    {
+        lengths[0] = (uint8_t)key_len;
+        lengths[1] = (uint8_t)value_len;
+        kv_flash_emit(&writer, lengths, sizeof(lengths));
+        kv_flash_emit(&writer, p_key, (uint32_t)key_len);
+        kv_flash_emit(&writer, p_value, (uint32_t)value_len);
+    }
+
+    if (0u != writer.fill)
+    {
+        kv_flash_emit(&writer, padding, FLASH_PROGRAM_UNIT - writer.fill);
+    }
+
+    /* Header last: the record only becomes valid once it is complete */
+    if ((0 != writer.result) ||
+        (0 != flash_program(scan.append_address, &header, sizeof(header))))
+    {
+        return KV_FLASH_ERROR_WRITE;
+    }
+
+    if (NULL != p_sequence)
+    {
+        *p_sequence = header.sequence;
+    }
+
+    return KV_FLASH_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
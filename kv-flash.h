@@ -0,0 +1,33 @@
+/** @file kv-flash.h
+ *
+ * @brief Wear-levelled flash snapshots of the key-value store.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef KV_FLASH_H
+#define KV_FLASH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Return codes */
+#define KV_FLASH_OK            ((int32_t)0)
+#define KV_FLASH_ERROR_EMPTY   ((int32_t)-1)   /* No valid snapshot stored */
+#define KV_FLASH_ERROR_WRITE   ((int32_t)-2)   /* Erase or program failed */
+
+/* Public API functions */
+int32_t kv_flash_load(uint32_t * p_sequence);
+int32_t kv_flash_save(uint32_t * p_sequence);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KV_FLASH_H */
+
+/*** end of file ***/
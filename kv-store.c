@@ -0,0 +1,526 @@
+/** @file kv-store.c
+ *
+ * @brief Fixed-capacity key-value store backing the CLI set/get commands.
+ *
+ * Entries live in a dense array in insertion order. A power-of-two slot
+ * table maps FNV-1a key hashes to entries with linear probing. Key and
+ * value text is appended to a text arena; an overwritten value reuses its
+ * space when it fits, and the arena is compacted in place when it runs out.
+ * The entry array and the text arena are pools carved by kv_init().
+ * A bit per entry records whether its value changed since a poller last
+ * took it, so repeated telemetry polls only carry what is new.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "kv-store.h"
+#include "arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if ((KV_TABLE_SLOTS & (KV_TABLE_SLOTS - 1u)) != 0u)
+#error "KV_TABLE_SLOTS must be a power of two"
+#endif
+
+/* FNV-1a 32-bit parameters */
+#define KV_FNV_OFFSET_BASIS   2166136261u
+#define KV_FNV_PRIME          16777619u
+
+/* Empty slot marker (slots hold entry index + 1) */
+#define KV_SLOT_EMPTY         0u
+
+/* Changed-entry bitmap words */
+#define KV_CHANGED_BITS       32u
+#define KV_CHANGED_WORDS      ((KV_CAPACITY + (KV_CHANGED_BITS - 1u)) / KV_CHANGED_BITS)
+
+/* Block kinds used while compacting the arena */
+#define KV_BLOCK_KEY          0u
+#define KV_BLOCK_VALUE        1u
+
+/**
+ * @brief Stored entry. Offsets index into g_kv_arena.
+ */
+typedef struct kv_entry
+{
+    uint32_t hash;              /**< Full key hash, compared before the key */
+    uint16_t key_offset;        /**< Key text position */
+    uint16_t value_offset;      /**< Value text position */
+    uint8_t key_len;            /**< Key length */
+    uint8_t value_len;          /**< Current value length */
+    uint8_t value_cap;          /**< Bytes reserved for the value */
+} kv_entry_t;
+
+/**
+ * @brief Arena block reference used by compaction.
+ */
+typedef struct kv_block
+{
+    uint16_t offset;            /**< Block position in the arena */
+    uint8_t entry;              /**< Owning entry index */
+    uint8_t kind;               /**< KV_BLOCK_KEY or KV_BLOCK_VALUE */
+} kv_block_t;
+
+/* Store state; capacity stays 0 (store always full) until kv_init() */
+static arena_pool_t g_kv_entry_pool;
+static arena_pool_t g_kv_text_pool;
+static kv_entry_t * g_kv_entries = NULL;
+static uint8_t g_kv_slots[KV_TABLE_SLOTS];
+static char * g_kv_arena = NULL;
+static uint32_t g_kv_capacity = 0u;
+static uint32_t g_kv_count = 0u;
+static uint32_t g_kv_arena_used = 0u;
+static uint32_t g_kv_changed[KV_CHANGED_WORDS];
+
+
+/*!
+ * @brief FNV-1a hash of a key.
+ *
+ * @param[in] p_key Key text.
+ * @param[in] key_len Key length.
+ *
+ * @return 32-bit hash.
+ */
+static uint32_t
+kv_hash (char const * p_key, size_t key_len)
+{
+    uint32_t hash = KV_FNV_OFFSET_BASIS;
+
+    while (key_len > 0u)
+    {
+        hash ^= (uint8_t)*p_key;
+        hash *= KV_FNV_PRIME;
+        p_key++;
+        key_len--;
+    }
+
+    return hash;
+}
+
+
+/*!
+ * @brief Probe the slot table for a key.
+ *
+ * @param[in] p_key Key text.
+ * @param[in] key_len Key length.
+ * @param[in] hash Hash of the key.
+ * @param[out] p_slot Slot holding the key, or the empty slot ending the probe.
+ *
+ * @return Entry index, or -1 if the key is not stored.
+ */
+static int32_t
+kv_find (char const * p_key, size_t key_len, uint32_t hash, uint32_t * p_slot)
+{
+    uint32_t slot = hash & (KV_TABLE_SLOTS - 1u);
+    kv_entry_t const * p_entry = NULL;
+    uint32_t probes = 0u;
+
+    for (probes = 0u; probes < KV_TABLE_SLOTS; probes++)
+    {
+        if (KV_SLOT_EMPTY == g_kv_slots[slot])
+        {
+            break;
+        }
+
+        p_entry = &g_kv_entries[g_kv_slots[slot] - 1u];
+
+        if ((hash == p_entry->hash) &&
+            (key_len == p_entry->key_len) &&
+            (0 == memcmp(p_key, &g_kv_arena[p_entry->key_offset], key_len)))
+        {
+            *p_slot = slot;
+            return (int32_t)(g_kv_slots[slot] - 1u);
+        }
+
+        slot = (slot + 1u) & (KV_TABLE_SLOTS - 1u);
+    }
+
+    *p_slot = slot;
+    return -1;
+}
+
+
+/*!
+ * @brief Squeeze stale value space out of the arena.
+ *
+ * Slides every live key and value block down in arena order. Values are
+ * trimmed to their current length.
+ */
+static void
+kv_compact (void)
+{
+    kv_block_t blocks[2u * KV_CAPACITY];
+    kv_block_t block;
+    uint32_t block_count = 0u;
+    uint32_t write = 0u;
+    uint32_t i = 0u;
+    uint32_t j = 0u;
+    kv_entry_t * p_entry = NULL;
+    uint32_t length = 0u;
+
+    /* Collect blocks */
+    for (i = 0u; i < g_kv_count; i++)
+    {
+        blocks[block_count].offset = g_kv_entries[i].key_offset;
+        blocks[block_count].entry = (uint8_t)i;
+        blocks[block_count].kind = KV_BLOCK_KEY;
+        block_count++;
+
+        blocks[block_count].offset = g_kv_entries[i].value_offset;
+        blocks[block_count].entry = (uint8_t)i;
+        blocks[block_count].kind = KV_BLOCK_VALUE;
+        block_count++;
+    }
+
+    /* Insertion sort by arena position (small, bounded count) */
+    for (i = 1u; i < block_count; i++)
+    {
+        block = blocks[i];
+
+        for (j = i; (j > 0u) && (blocks[j - 1u].offset > block.offset); j--)
+        {
+            blocks[j] = blocks[j - 1u];
+        }
+
+        blocks[j] = block;
+    }
+
+    /* Slide down; destinations never overtake their sources */
+    for (i = 0u; i < block_count; i++)
+    {
+        p_entry = &g_kv_entries[blocks[i].entry];
+
+        if (KV_BLOCK_KEY == blocks[i].kind)
+        {
+            length = p_entry->key_len;
+            (void)memmove(&g_kv_arena[write], &g_kv_arena[p_entry->key_offset], length);
+            p_entry->key_offset = (uint16_t)write;
+        }
+        else
+        {
+            length = p_entry->value_len;
+            (void)memmove(&g_kv_arena[write], &g_kv_arena[p_entry->value_offset], length);
+            p_entry->value_offset = (uint16_t)write;
+            p_entry->value_cap = p_entry->value_len;
+        }
+
+        write += length;
+    }
+
+    g_kv_arena_used = write;
+}
+
+
+/*!
+ * @brief Reserve arena space, compacting once if needed.
+ *
+ * @param[in] length Bytes needed.
+ * @param[out] p_offset Position of the reserved space.
+ *
+ * @return KV_OK, or KV_ERROR_FULL if the arena cannot hold length bytes.
+ */
+static int32_t
+kv_arena_alloc (uint32_t length, uint16_t * p_offset)
+{
+    if ((g_kv_arena_used + length) > KV_ARENA_SIZE)
+    {
+        kv_compact();
+
+        if ((g_kv_arena_used + length) > KV_ARENA_SIZE)
+        {
+            return KV_ERROR_FULL;
+        }
+    }
+
+    *p_offset = (uint16_t)g_kv_arena_used;
+    g_kv_arena_used += length;
+    arena_pool_use(&g_kv_text_pool, g_kv_arena_used);
+
+    return KV_OK;
+}
+
+
+/*!
+ * @brief Carve the entry array and text arena, then empty the store.
+ *
+ * @return KV_OK, or KV_ERROR_FULL if the arena is too small; every new
+ *         key is then refused with KV_ERROR_FULL.
+ */
+int32_t
+kv_init (void)
+{
+    g_kv_entries = (kv_entry_t *)arena_pool_init(&g_kv_entry_pool, "kv-entries",
+                                                 (uint32_t)sizeof(kv_entry_t), KV_CAPACITY);
+    g_kv_arena = (char *)arena_pool_init(&g_kv_text_pool, "kv-text", 1u, KV_ARENA_SIZE);
+
+    g_kv_capacity = ((NULL == g_kv_entries) || (NULL == g_kv_arena)) ? 0u : KV_CAPACITY;
+    kv_clear();
+
+    return (0u == g_kv_capacity) ? KV_ERROR_FULL : KV_OK;
+}
+
+
+/*!
+ * @brief Remove all entries.
+ */
+void
+kv_clear (void)
+{
+    (void)memset(g_kv_slots, 0, sizeof(g_kv_slots));
+    (void)memset(g_kv_changed, 0, sizeof(g_kv_changed));
+    g_kv_count = 0u;
+    g_kv_arena_used = 0u;
+}
+
+
+/*!
+ * @brief Store or overwrite a value.
+ *
+ * Storing the value a key already has is not a change (see
+ * kv_next_changed()).
+ *
+ * @param[in] p_key Key text (need not be null-terminated).
+ * @param[in] key_len Key length, 1..KV_MAX_KEY_LEN.
+ * @param[in] p_value Value text (need not be null-terminated).
+ * @param[in] value_len Value length, 0..KV_MAX_VALUE_LEN.
+ *
+ * @return KV_OK, KV_ERROR_INVALID or KV_ERROR_FULL.
+ */
+int32_t
+kv_set (char const * p_key, size_t key_len,
+        char const * p_value, size_t value_len)
+{
+    uint32_t hash = 0u;
+    uint32_t slot = 0u;
+    int32_t index = 0;
+    kv_entry_t * p_entry = NULL;
+    uint16_t offset = 0u;
+
+    if ((NULL == p_key) || (0u == key_len) || (key_len > KV_MAX_KEY_LEN) ||
+        ((NULL == p_value) && (0u != value_len)) ||
+        (value_len > KV_MAX_VALUE_LEN))
+    {
+        return KV_ERROR_INVALID;
+    }
+
+    hash = kv_hash(p_key, key_len);
+    index = kv_find(p_key, key_len, hash, &slot);
+
+    if (index >= 0)
+    {
+        /* Existing key - overwrite in place when the value fits */
+        p_entry = &g_kv_entries[index];
+
+        if ((value_len == p_entry->value_len) &&
+            ((0u == value_len) ||
+             (0 == memcmp(&g_kv_arena[p_entry->value_offset], p_value, value_len))))
+        {
+            return KV_OK;
+        }
+
+        if (value_len > p_entry->value_cap)
+        {
+            if (KV_OK != kv_arena_alloc((uint32_t)value_len, &offset))
+            {
+                return KV_ERROR_FULL;
+            }
+
+            p_entry->value_offset = offset;
+            p_entry->value_cap = (uint8_t)value_len;
+        }
+    }
+    else
+    {
+        if (g_kv_count >= g_kv_capacity)
+        {
+            return KV_ERROR_FULL;
+        }
+
+        /* Key and value are allocated together */
+        if (KV_OK != kv_arena_alloc((uint32_t)(key_len + value_len), &offset))
+        {
+            return KV_ERROR_FULL;
+        }
+
+        /* Compaction may have run, but slots and entry indices are stable */
+        p_entry = &g_kv_entries[g_kv_count];
+        p_entry->hash = hash;
+        p_entry->key_offset = offset;
+        p_entry->key_len = (uint8_t)key_len;
+        p_entry->value_offset = (uint16_t)(offset + key_len);
+        p_entry->value_cap = (uint8_t)value_len;
+        (void)memcpy(&g_kv_arena[offset], p_key, key_len);
+
+        g_kv_count++;
+        g_kv_slots[slot] = (uint8_t)g_kv_count;
+        arena_pool_use(&g_kv_entry_pool, g_kv_count);
+    }
+
+    p_entry->value_len = (uint8_t)value_len;
+
+    if (0u != value_len)
+    {
+        (void)memcpy(&g_kv_arena[p_entry->value_offset], p_value, value_len);
+    }
+
+    index = (int32_t)(p_entry - g_kv_entries);
+    g_kv_changed[(uint32_t)index / KV_CHANGED_BITS] |= (1u << ((uint32_t)index % KV_CHANGED_BITS));
+
+    return KV_OK;
+}
+
+
+/*!
+ * @brief Look up a value.
+ *
+ * @param[in] p_key Key text (need not be null-terminated).
+ * @param[in] key_len Key length.
+ * @param[out] pp_value Set to the value text (not null-terminated). Valid
+ *             until the next kv_set().
+ * @param[out] p_value_len Set to the value length.
+ *
+ * @return KV_OK, KV_ERROR_INVALID or KV_ERROR_NOT_FOUND.
+ */
+int32_t
+kv_get (char const * p_key, size_t key_len,
+        char const ** pp_value, size_t * p_value_len)
+{
+    uint32_t slot = 0u;
+    int32_t index = 0;
+
+    if ((NULL == p_key) || (NULL == pp_value) || (NULL == p_value_len) ||
+        (0u == key_len) || (key_len > KV_MAX_KEY_LEN))
+    {
+        return KV_ERROR_INVALID;
+    }
+
+    index = kv_find(p_key, key_len, kv_hash(p_key, key_len), &slot);
+
+    if (index < 0)
+    {
+        return KV_ERROR_NOT_FOUND;
+    }
+
+    *pp_value = &g_kv_arena[g_kv_entries[index].value_offset];
+    *p_value_len = g_kv_entries[index].value_len;
+
+    return KV_OK;
+}
+
+
+/*!
+ * @brief Report capacity and fill level.
+ *
+ * @param[out] p_usage Usage report.
+ */
+void
+kv_get_usage (kv_usage_t * p_usage)
+{
+    if (NULL == p_usage)
+    {
+        return;
+    }
+
+    p_usage->entries = g_kv_count;
+    p_usage->capacity = g_kv_capacity;
+    p_usage->arena_used = g_kv_arena_used;
+    p_usage->arena_size = (0u == g_kv_capacity) ? 0u : KV_ARENA_SIZE;
+}
+
+
+/*!
+ * @brief Access an entry by insertion order (for snapshots and dumps).
+ *
+ * @param[in] index Entry index, 0..entries-1.
+ * @param[out] pp_key Set to the key text.
+ * @param[out] p_key_len Set to the key length.
+ * @param[out] pp_value Set to the value text.
+ * @param[out] p_value_len Set to the value length.
+ *
+ * @return KV_OK, or KV_ERROR_NOT_FOUND past the last entry.
+ */
+int32_t
+kv_get_entry (uint32_t index,
+              char const ** pp_key, size_t * p_key_len,
+              char const ** pp_value, size_t * p_value_len)
+{
+    kv_entry_t const * p_entry = NULL;
+
+    if (index >= g_kv_count)
+    {
+        return KV_ERROR_NOT_FOUND;
+    }
+
+    p_entry = &g_kv_entries[index];
+    *pp_key = &g_kv_arena[p_entry->key_offset];
+    *p_key_len = p_entry->key_len;
+    *pp_value = &g_kv_arena[p_entry->value_offset];
+    *p_value_len = p_entry->value_len;
+
+    return KV_OK;
+}
+
+/*!
+ * @brief Find the next entry whose value changed since it was last taken.
+ *
+ * New keys count as changed. Whole bitmap words are skipped at once, so a
+ * poll that finds nothing costs a few word reads.
+ *
+ * @param[in] start First entry index to look at.
+ *
+ * @return Entry index for kv_get_entry(), or KV_ERROR_NOT_FOUND.
+ */
+int32_t
+kv_next_changed (uint32_t start)
+{
+    uint32_t index = start;
+    uint32_t bits = 0u;
+
+    while (index < g_kv_count)
+    {
+        bits = g_kv_changed[index / KV_CHANGED_BITS] >> (index % KV_CHANGED_BITS);
+
+        if (0u == bits)
+        {
+            /* Rest of this word is clean */
+            index = (index - (index % KV_CHANGED_BITS)) + KV_CHANGED_BITS;
+            continue;
+        }
+
+        while (0u == (bits & 1u))
+        {
+            bits >>= 1;
+            index++;
+        }
+
+        return (index < g_kv_count) ? (int32_t)index : KV_ERROR_NOT_FOUND;
+    }
+
+    return KV_ERROR_NOT_FOUND;
+}
+
+
+/*!
+ * @brief Mark an entry as taken by the poller (unchanged until set again).
+ *
+ * @param[in] index Entry index from kv_next_changed().
+ */
+void
+kv_clear_changed (uint32_t index)
+{
+    if (index < g_kv_count)
+    {
+        g_kv_changed[index / KV_CHANGED_BITS] &= ~(1u << (index % KV_CHANGED_BITS));
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
@@ -0,0 +1,73 @@
+/** @file kv-store.h
+ *
+ * @brief Fixed-capacity key-value store backing the CLI set/get commands.
+ *
+ * Open-addressing hash table over a string arena carved from the static
+ * arena (arena.h) by kv_init(). No dynamic memory allocation; set and get
+ * are constant time on average.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of stored keys */
+#define KV_CAPACITY           32u
+
+/* Hash table slots (power of two, twice the capacity keeps probes short) */
+#define KV_TABLE_SLOTS        (2u * KV_CAPACITY)
+
+/* Bytes of key and value text held in the arena */
+#define KV_ARENA_SIZE         1024u
+
+/* Longest accepted key and value */
+#define KV_MAX_KEY_LEN        32u
+#define KV_MAX_VALUE_LEN      64u
+
+/* Return codes */
+#define KV_OK                 ((int32_t)0)
+#define KV_ERROR_INVALID      ((int32_t)-1)   /* NULL, empty or too long */
+#define KV_ERROR_NOT_FOUND    ((int32_t)-2)
+#define KV_ERROR_FULL         ((int32_t)-3)   /* No free entry or arena space */
+
+/**
+ * @brief Capacity and fill level report.
+ */
+typedef struct kv_usage
+{
+    uint32_t entries;           /**< Keys currently stored */
+    uint32_t capacity;          /**< Maximum number of keys */
+    uint32_t arena_used;        /**< Arena bytes in use (including stale) */
+    uint32_t arena_size;        /**< Total arena bytes */
+} kv_usage_t;
+
+/* Public API functions */
+int32_t kv_init(void);
+void kv_clear(void);
+int32_t kv_set(char const * p_key, size_t key_len,
+               char const * p_value, size_t value_len);
+int32_t kv_get(char const * p_key, size_t key_len,
+               char const ** pp_value, size_t * p_value_len);
+void kv_get_usage(kv_usage_t * p_usage);
+int32_t kv_get_entry(uint32_t index,
+                     char const ** pp_key, size_t * p_key_len,
+                     char const ** pp_value, size_t * p_value_len);
+int32_t kv_next_changed(uint32_t start);
+void kv_clear_changed(uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KV_STORE_H */
+
+/*** end of file ***/
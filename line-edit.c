@@ -0,0 +1,599 @@
+/** @file line-edit.c
+ *
+ * @brief Interactive line editor with command history for the text CLI.
+ *
+ * The line is edited where it will be parsed: insertions and deletions
+ * move the tail inside the caller's buffer, and a finished line is
+ * already null-terminated for cli_process_command(). A feed stops before
+ * a key whose worst-case echo might not fit the remaining echo space, so
+ * nothing is ever half drawn; the rest stays in the RX ring.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "line-edit.h"
+#include "arena.h"
+#include "types.h"  /* For bool_t type */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (LINE_EDIT_HISTORY_ENTRIES > 255u) || (LINE_EDIT_HISTORY_ARENA > 0xFFFFu)
+#error "History indices are 8-bit and arena offsets 16-bit"
+#endif
+
+/* Key codes */
+#define KEY_BACKSPACE       '\b'
+#define KEY_DELETE          '\x7F'
+#define KEY_ESCAPE          '\x1B'
+#define KEY_BELL            '\a'
+#define KEY_CR              '\r'
+#define KEY_LF              '\n'
+
+/* Longest cursor motion sent as characters instead of an escape sequence */
+#define LINE_EDIT_SHORT_MOVE    3u
+
+/* Escape sequence decoder states */
+typedef enum
+{
+    ESC_STATE_NONE = 0,        /* Plain input */
+    ESC_STATE_ESC,             /* ESC received */
+    ESC_STATE_CSI,             /* ESC [ received, collecting a parameter */
+    ESC_STATE_SS3              /* ESC O received (application cursor keys) */
+} line_edit_esc_t;
+
+/* Line being edited (caller storage) */
+static char * g_p_line = NULL;
+static size_t g_line_size = 0u;
+static size_t g_length = 0u;
+static size_t g_cursor = 0u;
+
+/* Input decoder state */
+static line_edit_esc_t g_esc_state = ESC_STATE_NONE;
+static uint32_t g_esc_param = 0u;
+static bool_t g_b_after_cr = FALSE;
+
+/* Echo buffer of the feed in progress */
+static char * g_p_echo = NULL;
+static size_t g_echo_size = 0u;
+static size_t g_echo_length = 0u;
+
+/* History: lines packed in a byte ring carved from the arena, oldest first */
+static arena_pool_t g_history_pool;
+static char * g_history_arena = NULL;     /* NULL: arena full, no history */
+static uint16_t g_history_offset[LINE_EDIT_HISTORY_ENTRIES];
+static uint16_t g_history_length[LINE_EDIT_HISTORY_ENTRIES];
+static uint32_t g_history_first = 0u;      /* Slot of the oldest line */
+static uint32_t g_history_count = 0u;
+static uint32_t g_history_head = 0u;       /* Arena offset for the next line */
+static uint32_t g_history_used = 0u;       /* Arena bytes in use */
+static uint32_t g_history_browse = 0u;     /* 0 = new line, n = n-th newest */
+
+
+/*!
+ * @brief Append bytes to the echo buffer.
+ *
+ * @param[in] p_data Bytes to echo.
+ * @param[in] len Number of bytes (space was checked before the key).
+ */
+static void
+line_edit_echo (char const * p_data, size_t len)
+{
+    (void)memcpy(&g_p_echo[g_echo_length], p_data, len);
+    g_echo_length += len;
+}
+
+
+/*!
+ * @brief Echo "ESC [ <count> <final>".
+ *
+ * @param[in] count Parameter, at least 1.
+ * @param[in] final Final character ('C' right, 'D' left).
+ */
+static void
+line_edit_echo_csi (size_t count, char final)
+{
+    char digits[10];
+    size_t used = 0u;
+
+    g_p_echo[g_echo_length++] = KEY_ESCAPE;
+    g_p_echo[g_echo_length++] = '[';
+
+    do
+    {
+        digits[used++] = (char)('0' + (count % 10u));
+        count /= 10u;
+    } while (0u != count);
+
+    while (0u != used)
+    {
+        g_p_echo[g_echo_length++] = digits[--used];
+    }
+
+    g_p_echo[g_echo_length++] = final;
+}
+
+
+/*!
+ * @brief Move the terminal cursor left, with the fewest bytes.
+ *
+ * @param[in] count Columns to move.
+ */
+static void
+line_edit_move_left (size_t count)
+{
+    if (count <= LINE_EDIT_SHORT_MOVE)
+    {
+        while (0u != count)
+        {
+            g_p_echo[g_echo_length++] = KEY_BACKSPACE;
+            count--;
+        }
+    }
+    else
+    {
+        line_edit_echo_csi(count, 'D');
+    }
+}
+
+
+/*!
+ * @brief Move the terminal cursor right over line text, with the fewest bytes.
+ *
+ * Short moves re-send the characters being passed over.
+ *
+ * @param[in] count Columns to move from g_cursor.
+ */
+static void
+line_edit_move_right (size_t count)
+{
+    if (count <= LINE_EDIT_SHORT_MOVE)
+    {
+        line_edit_echo(&g_p_line[g_cursor], count);
+    }
+    else
+    {
+        line_edit_echo_csi(count, 'C');
+    }
+}
+
+
+/*!
+ * @brief Copy history entry n (0 = newest) into the line and redraw it.
+ *
+ * @param[in] newest_index Entry to recall, or g_history_count for an empty line.
+ */
+static void
+line_edit_recall (uint32_t newest_index)
+{
+    static char const erase_to_end[] = "\x1B[K";
+    size_t old_length = g_length;
+    uint32_t slot = 0u;
+    size_t offset = 0u;
+    size_t first = 0u;
+
+    if (newest_index < g_history_count)
+    {
+        slot = (g_history_first + g_history_count - 1u - newest_index) %
+               LINE_EDIT_HISTORY_ENTRIES;
+        offset = g_history_offset[slot];
+        g_length = g_history_length[slot];
+
+        /* Entries may wrap around the end of the arena */
+        first = LINE_EDIT_HISTORY_ARENA - offset;
+        first = (first > g_length) ? g_length : first;
+        (void)memcpy(g_p_line, &g_history_arena[offset], first);
+        (void)memcpy(&g_p_line[first], g_history_arena, g_length - first);
+    }
+    else
+    {
+        g_length = 0u;
+    }
+
+    /* Back to the start, overwrite, clear what the old line left over */
+    line_edit_move_left(g_cursor);
+    line_edit_echo(g_p_line, g_length);
+
+    if (g_length < old_length)
+    {
+        line_edit_echo(erase_to_end, sizeof(erase_to_end) - 1u);
+    }
+
+    g_cursor = g_length;
+}
+
+
+/*!
+ * @brief Append the finished line to the history, evicting the oldest.
+ *
+ * Empty lines and repeats of the newest entry are not stored.
+ */
+static void
+line_edit_remember (void)
+{
+    uint32_t slot = 0u;
+    size_t first = 0u;
+
+    if ((0u == g_length) || (g_length > LINE_EDIT_HISTORY_ARENA) ||
+        (NULL == g_history_arena))
+    {
+        return;
+    }
+
+    if (0u != g_history_count)
+    {
+        slot = (g_history_first + g_history_count - 1u) % LINE_EDIT_HISTORY_ENTRIES;
+
+        if ((g_history_length[slot] == g_length) &&
+            ((g_history_offset[slot] + g_length) <= LINE_EDIT_HISTORY_ARENA) &&
+            (0 == memcmp(&g_history_arena[g_history_offset[slot]], g_p_line, g_length)))
+        {
+            return;
+        }
+    }
+
+    while ((LINE_EDIT_HISTORY_ENTRIES == g_history_count) ||
+           ((g_history_used + g_length) > LINE_EDIT_HISTORY_ARENA))
+    {
+        g_history_used -= g_history_length[g_history_first];
+        g_history_first = (g_history_first + 1u) % LINE_EDIT_HISTORY_ENTRIES;
+        g_history_count--;
+    }
+
+    slot = (g_history_first + g_history_count) % LINE_EDIT_HISTORY_ENTRIES;
+    g_history_offset[slot] = (uint16_t)g_history_head;
+    g_history_length[slot] = (uint16_t)g_length;
+
+    first = LINE_EDIT_HISTORY_ARENA - g_history_head;
+    first = (first > g_length) ? g_length : first;
+    (void)memcpy(&g_history_arena[g_history_head], g_p_line, first);
+    (void)memcpy(g_history_arena, &g_p_line[first], g_length - first);
+
+    g_history_head = (g_history_head + g_length) % LINE_EDIT_HISTORY_ARENA;
+    g_history_used += g_length;
+    g_history_count++;
+    arena_pool_use(&g_history_pool, (uint32_t)g_history_used);
+}
+
+
+/*!
+ * @brief Insert a printable character at the cursor.
+ *
+ * @param[in] c Character.
+ */
+static void
+line_edit_insert (char c)
+{
+    size_t tail = g_length - g_cursor;
+
+    if ((g_length + 1u) >= g_line_size)
+    {
+        /* Line full */
+        g_p_echo[g_echo_length++] = KEY_BELL;
+        return;
+    }
+
+    (void)memmove(&g_p_line[g_cursor + 1u], &g_p_line[g_cursor], tail);
+    g_p_line[g_cursor] = c;
+    g_length++;
+
+    /* Redraw from the cursor; typing at the end echoes just the character */
+    line_edit_echo(&g_p_line[g_cursor], tail + 1u);
+    g_cursor++;
+    line_edit_move_left(tail);
+}
+
+
+/*!
+ * @brief Remove the character at index from the line and redraw the tail.
+ *
+ * @param[in] index Character to delete; the cursor must already be there.
+ */
+static void
+line_edit_delete_at (size_t index)
+{
+    size_t tail = g_length - index - 1u;
+
+    (void)memmove(&g_p_line[index], &g_p_line[index + 1u], tail);
+    g_length--;
+
+    line_edit_echo(&g_p_line[index], tail);
+    g_p_echo[g_echo_length++] = ' ';
+    line_edit_move_left(tail + 1u);
+}
+
+
+/*!
+ * @brief Act on a decoded cursor/editing key.
+ *
+ * @param[in] final CSI/SS3 final character ('A'..'D', 'H', 'F', '~').
+ * @param[in] param CSI parameter (3 = Delete with '~', 1/7 Home, 4/8 End).
+ */
+static void
+line_edit_key (char final, uint32_t param)
+{
+    if ('~' == final)
+    {
+        final = ((1u == param) || (7u == param)) ? 'H' :
+                ((4u == param) || (8u == param)) ? 'F' :
+                (3u == param) ? 'X' : '\0';
+    }
+
+    switch (final)
+    {
+        case 'A':   /* Up: older history entry */
+        {
+            if (g_history_browse < g_history_count)
+            {
+                g_history_browse++;
+                line_edit_recall(g_history_browse - 1u);
+            }
+            break;
+        }
+
+        case 'B':   /* Down: newer entry, then an empty line */
+        {
+            if (0u != g_history_browse)
+            {
+                g_history_browse--;
+                line_edit_recall((0u == g_history_browse) ?
+                                 g_history_count : (g_history_browse - 1u));
+            }
+            break;
+        }
+
+        case 'C':   /* Right */
+        {
+            if (g_cursor < g_length)
+            {
+                line_edit_move_right(1u);
+                g_cursor++;
+            }
+            break;
+        }
+
+        case 'D':   /* Left */
+        {
+            if (0u != g_cursor)
+            {
+                line_edit_move_left(1u);
+                g_cursor--;
+            }
+            break;
+        }
+
+        case 'H':   /* Home */
+        {
+            line_edit_move_left(g_cursor);
+            g_cursor = 0u;
+            break;
+        }
+
+        case 'F':   /* End */
+        {
+            line_edit_move_right(g_length - g_cursor);
+            g_cursor = g_length;
+            break;
+        }
+
+        case 'X':   /* Delete: character under the cursor */
+        {
+            if (g_cursor < g_length)
+            {
+                line_edit_delete_at(g_cursor);
+            }
+            break;
+        }
+
+        default:
+        {
+            /* Unsupported key - ignore */
+            break;
+        }
+    }
+}
+
+
+/*!
+ * @brief Worst-case echo of the next received byte.
+ *
+ * Sized per key, so a run of typed or pasted characters fills one echo
+ * buffer instead of stopping after the first: typing costs the redrawn
+ * tail plus one, only the last byte of an escape sequence (a history
+ * recall, say) may redraw the whole line.
+ *
+ * @param[in] c Next byte.
+ *
+ * @return Echo bytes the byte may produce.
+ */
+static size_t
+line_edit_echo_need (char c)
+{
+    size_t need = 0u;
+
+    if (ESC_STATE_NONE != g_esc_state)
+    {
+        need = g_line_size + LINE_EDIT_ECHO_SLACK;
+    }
+    else if ((KEY_CR == c) || (KEY_LF == c))
+    {
+        need = 2u;
+    }
+    else
+    {
+        /* Insert or backspace: tail redraw and cursor motions */
+        need = (g_length - g_cursor) + 1u + LINE_EDIT_ECHO_SLACK;
+    }
+
+    return need;
+}
+
+
+/*!
+ * @brief Set the buffer lines are edited in and carve the history ring.
+ *
+ * If the arena has no room for the history ring, editing still works but
+ * no lines are remembered.
+ *
+ * @param[in] p_line Line buffer; a finished line is null-terminated in it.
+ * @param[in] line_size Buffer size, at least 2.
+ */
+void
+line_edit_init (char * p_line, size_t line_size)
+{
+    g_p_line = p_line;
+    g_line_size = line_size;
+    g_history_arena = (char *)arena_pool_init(&g_history_pool, "history",
+                                              1u, LINE_EDIT_HISTORY_ARENA);
+    g_history_first = 0u;
+    g_history_count = 0u;
+    g_history_head = 0u;
+    g_history_used = 0u;
+    line_edit_begin();
+}
+
+
+/*!
+ * @brief Start a new, empty line.
+ */
+void
+line_edit_begin (void)
+{
+    g_length = 0u;
+    g_cursor = 0u;
+    g_esc_state = ESC_STATE_NONE;
+    g_history_browse = 0u;
+}
+
+
+/*!
+ * @brief Feed received bytes into the editor.
+ *
+ * Consumes bytes until Enter completes the line, the input is used up, or
+ * the echo buffer might not hold the next byte's worst-case echo (see
+ * line_edit_echo_need()); an echo buffer of line size +
+ * LINE_EDIT_ECHO_SLACK always takes at least one byte. A LF right after a
+ * CR is swallowed, so CR LF terminals do not produce an extra empty line.
+ *
+ * @param[in] p_data Received bytes.
+ * @param[in] len Number of bytes available.
+ * @param[out] p_consumed Bytes used; the rest belong to later calls.
+ * @param[out] p_echo Buffer for echo and redraw output.
+ * @param[in] echo_size Capacity of p_echo.
+ * @param[out] p_echo_length Echo bytes produced.
+ *
+ * @return LINE_EDIT_DONE when the line is complete (null-terminated in the
+ *         line buffer), otherwise LINE_EDIT_MORE.
+ */
+int32_t
+line_edit_feed (char const * p_data, size_t len, size_t * p_consumed,
+                char * p_echo, size_t echo_size, size_t * p_echo_length)
+{
+    static char const new_line[] = "\r\n";
+    int32_t result = LINE_EDIT_MORE;
+    size_t used = 0u;
+    char c = '\0';
+
+    g_p_echo = p_echo;
+    g_echo_size = echo_size;
+    g_echo_length = 0u;
+
+    while ((used < len) && (LINE_EDIT_MORE == result) &&
+           ((g_echo_size - g_echo_length) >= line_edit_echo_need(p_data[used])))
+    {
+        c = p_data[used];
+        used++;
+
+        if ((KEY_LF == c) && g_b_after_cr)
+        {
+            g_b_after_cr = FALSE;
+            continue;
+        }
+
+        g_b_after_cr = (KEY_CR == c) ? TRUE : FALSE;
+
+        if (ESC_STATE_ESC == g_esc_state)
+        {
+            g_esc_param = 0u;
+            g_esc_state = ('[' == c) ? ESC_STATE_CSI :
+                          ('O' == c) ? ESC_STATE_SS3 : ESC_STATE_NONE;
+        }
+        else if (ESC_STATE_CSI == g_esc_state)
+        {
+            if ((c >= '0') && (c <= '9'))
+            {
+                g_esc_param = (g_esc_param * 10u) + (uint32_t)(c - '0');
+            }
+            else if (';' != c)
+            {
+                g_esc_state = ESC_STATE_NONE;
+                line_edit_key(c, g_esc_param);
+            }
+            else
+            {
+                /* Modifier parameter follows; keep the first */
+            }
+        }
+        else if (ESC_STATE_SS3 == g_esc_state)
+        {
+            g_esc_state = ESC_STATE_NONE;
+            line_edit_key(c, 0u);
+        }
+        else if ((KEY_CR == c) || (KEY_LF == c))
+        {
+            g_p_line[g_length] = '\0';
+            line_edit_echo(new_line, sizeof(new_line) - 1u);
+            line_edit_remember();
+            result = LINE_EDIT_DONE;
+        }
+        else if ((KEY_BACKSPACE == c) || (KEY_DELETE == c))
+        {
+            if (0u != g_cursor)
+            {
+                line_edit_move_left(1u);
+                g_cursor--;
+                line_edit_delete_at(g_cursor);
+            }
+        }
+        else if (KEY_ESCAPE == c)
+        {
+            g_esc_state = ESC_STATE_ESC;
+        }
+        else if ((c >= ' ') && (c < KEY_DELETE))
+        {
+            line_edit_insert(c);
+        }
+        else
+        {
+            /* Other control characters are ignored */
+        }
+    }
+
+    *p_consumed = used;
+    *p_echo_length = g_echo_length;
+
+    return result;
+}
+
+
+/*!
+ * @brief Characters in the line being edited.
+ *
+ * @return Current line length.
+ */
+size_t
+line_edit_length (void)
+{
+    return g_length;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
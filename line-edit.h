@@ -0,0 +1,60 @@
+/** @file line-edit.h
+ *
+ * @brief Interactive line editor with command history for the text CLI.
+ *
+ * Edits the command line in place in the caller's line buffer as bytes
+ * are fed from the RX ring: printable characters insert at the cursor,
+ * Backspace/Delete remove, Left/Right/Home/End move, Up/Down recall
+ * earlier lines. VT100 escape sequences are decoded incrementally, so a
+ * sequence split across two reads is fine. Echo and redraw bytes are
+ * batched into one caller-provided buffer per feed (normally a TX ring
+ * reservation) and use the shortest cursor motion available.
+ *
+ * The last LINE_EDIT_HISTORY_ENTRIES lines are kept packed back to back
+ * in a single LINE_EDIT_HISTORY_ARENA byte ring, carved from the static
+ * arena (arena.h); the oldest lines are evicted when a new one does not
+ * fit.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef LINE_EDIT_H
+#define LINE_EDIT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* History depth and the arena holding the lines */
+#ifndef LINE_EDIT_HISTORY_ENTRIES
+#define LINE_EDIT_HISTORY_ENTRIES   8u
+#endif
+#ifndef LINE_EDIT_HISTORY_ARENA
+#define LINE_EDIT_HISTORY_ARENA     256u
+#endif
+
+/* Echo bytes one key can need beyond the line length (cursor motions) */
+#define LINE_EDIT_ECHO_SLACK        16u
+
+/* line_edit_feed() results */
+#define LINE_EDIT_MORE              ((int32_t)0)    /* Line still being edited */
+#define LINE_EDIT_DONE              ((int32_t)1)    /* Enter: line complete */
+
+/* Public API functions */
+void line_edit_init(char * p_line, size_t line_size);
+void line_edit_begin(void);
+int32_t line_edit_feed(char const * p_data, size_t len, size_t * p_consumed,
+                       char * p_echo, size_t echo_size, size_t * p_echo_length);
+size_t line_edit_length(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINE_EDIT_H */
+
+/*** end of file ***/
@@ -4,7 +4,10 @@
  *
  * Implements command-line interface over UART for interactive control
  * of embedded system. Receives commands, parses them, executes handlers,
- * and transmits responses back via UART.
+ * and transmits responses back via UART. The main loop is event-driven:
+ * it sleeps in WFI until a UART interrupt reports input or freed TX space.
+ * With UART_STOP_WAKEUP it enters STOP instead whenever the console is
+ * idle between commands, and the next start bit wakes it.
  *
  * @par
  * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
@@ -13,27 +16,135 @@
 #include <stdint.h>
 #include <string.h>
 #include "uart.h"
+#include "clock.h"
 #include "em-cli.h"
+#include "cli-json.h"
+#include "cli-bin.h"
+#include "kv-store.h"
+#include "kv-flash.h"
+#include "prof.h"
+#include "line-edit.h"
+#include "startup.h"
+#include "arena.h"
+#include "power.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* NVIC register base address */
-#define NVIC_ISER0_BASE     0xE000E100u
-
-/* USART2 interrupt number */
-#define USART2_IRQ_NUM      28u
-
 /* String constants */
 static char const WELCOME_MSG[] = "\r\nCLI Ready. Type 'help' for commands.\r\n> ";
 static char const PROMPT[] = "> ";
+static char const KV_MSG_USAGE[] = "Usage: kv [list|poll|save|load]\r\n";
+static char const KV_MSG_WRITE_FAILED[] = "Error: Flash write failed\r\n";
+static char const KV_MSG_NO_SNAPSHOT[] = "KV: no snapshot stored\r\n";
+static char const PROTO_MSG_USAGE[] = "Usage: proto [text|bin]\r\n";
+static char const PROTO_MSG_TEXT[] = "Protocol: text\r\n";
+static char const PROTO_MSG_BIN[] = "Protocol: bin\r\n";
+static char const BAUD_MSG_USAGE[] = "Usage: baud [<rate> [x8|x16]]\r\n";
+static char const BAUD_MSG_UNSUPPORTED[] = "Error: Baud rate not reachable\r\n";
+static char const BAUD_MSG_SWITCH_FAILED[] = "Error: Baud rate not reachable, unchanged\r\n> ";
+static char const STATS_MSG_USAGE[] = "Usage: stats [reset]\r\n";
+static char const STATS_MSG_RESET[] = "Stats: reset\r\n";
+static char const SCRIPT_MSG_USAGE[] = "Usage: script begin|end|abort\r\n";
+static char const SCRIPT_MSG_RECORDING[] =
+    "Script: recording, 'script end' runs it, 'script abort' discards it\r\n";
+static char const SCRIPT_MSG_NOT_RECORDING[] = "Error: No script being recorded\r\n";
+static char const SCRIPT_MSG_NESTED[] = "Error: Script already running\r\n";
+static char const SCRIPT_MSG_DISCARDED[] = "Script: discarded\r\n> ";
+static char const SCRIPT_MSG_TOO_LONG[] = "Error: Script too long, discarded\r\n> ";
+static char const CANCEL_MSG_LINE[] = "^C\r\n> ";
+static char const LINE_LOST_MSG[] = "\r\nError: Receive error, line dropped\r\n> ";
+
+/* Commands on one line are separated by ';' */
+#define CLI_BATCH_SEPARATOR    ';'
+
+/* Bytes of recorded script text (lines are stored null-terminated) */
+#ifndef CLI_SCRIPT_SIZE
+#define CLI_SCRIPT_SIZE        1024u
+#endif
+
+/* Longest line of the stats report (name, four counters, separators) */
+#define STATS_LINE_MAX         80u
+
+/* Response chunks are formatted in place inside the TX ring */
+#if (CLI_WRITE_BUFFER_SIZE > UART_TX_RESERVE_MAX)
+#error "CLI_WRITE_BUFFER_SIZE must not exceed UART_TX_RESERVE_MAX"
+#endif
+
+/* CLI scheduler states */
+typedef enum
+{
+    CLI_STATE_RECEIVING = 0,   /* Assembling the next command line */
+    CLI_STATE_RESPONDING,      /* Queuing the command response */
+    CLI_STATE_SWITCHING_BAUD,  /* Waiting for TX to drain before a baud change */
+    CLI_STATE_PROMPTING        /* Queuing the prompt (or welcome message) */
+} cli_state_t;
+
+/* Command line being edited from the UART RX ring (see line-edit.h) */
+static char g_line_buffer[RX_BUFFER_SIZE_BYTES] STARTUP_NOINIT;
+
+/* Echo of one feed goes to a single TX ring reservation */
+#define CLI_ECHO_SIZE          (RX_BUFFER_SIZE_BYTES + LINE_EDIT_ECHO_SLACK)
+
+#if (CLI_ECHO_SIZE > UART_TX_RESERVE_MAX)
+#error "Line echo must fit one UART_TX_RESERVE_MAX reservation"
+#endif
+
+/* Scheduler state and the output continuation it is waiting on */
+static cli_state_t g_cli_state = CLI_STATE_PROMPTING;
+static char const * g_p_pending_output = NULL;
+static uint32_t g_pending_length = 0u;
+
+/* Whether the command handler has another response chunk to produce */
+static base_type g_b_more_output = CLI_FALSE;
 
-/* External UART state variables */
-extern volatile uart_state_t g_tx_state;
-extern volatile uart_state_t g_rx_state;
-extern char * g_p_rx_buffer;
-extern volatile uint32_t g_rx_index;
+/* Current request is a JSON document (a line starting with '{') */
+static base_type g_b_json_line = CLI_FALSE;
+
+/* What to discard from the RX stream after a JSON request */
+typedef enum
+{
+    CLI_SKIP_NONE = 0,         /* Nothing, deliver every byte */
+    CLI_SKIP_BLANKS,           /* Line endings and blanks after a request */
+    CLI_SKIP_LINE              /* Rest of a rejected request, then blanks */
+} cli_skip_t;
+
+static cli_skip_t g_rx_skip = CLI_SKIP_NONE;
+
+/* Wire protocol, switched by the proto command once its reply is queued */
+typedef enum
+{
+    CLI_PROTOCOL_TEXT = 0,     /* Text lines and JSON requests */
+    CLI_PROTOCOL_BINARY        /* COBS frames, see cli-bin.h */
+} cli_protocol_t;
+
+static cli_protocol_t g_protocol = CLI_PROTOCOL_TEXT;
+static cli_protocol_t g_protocol_next = CLI_PROTOCOL_TEXT;
+
+/* Line rate requested by the baud command, applied once its reply is out */
+static uint32_t g_pending_baud = 0u;
+static bool_t g_b_pending_oversample8 = FALSE;
+
+/* Commands of the line or script being executed, each null-terminated */
+static char * g_p_exec = NULL;
+static char const * g_p_exec_end = NULL;
+
+/* Script recorded between "script begin" and "script end" */
+static char g_script_buffer[CLI_SCRIPT_SIZE] STARTUP_NOINIT;
+static uint32_t g_script_length = 0u;
+static bool_t g_b_script_recording = FALSE;
+static bool_t g_b_script_running = FALSE;
+static bool_t g_b_script_summary = FALSE;
+static uint32_t g_script_commands = 0u;
+
+/* Ctrl-C arrived while responding; Ctrl-T reply still to be queued */
+static bool_t g_b_cancelled = FALSE;
+static bool_t g_b_status_pending = FALSE;
+
+/* Cycle count at the latest wakeup, and at the one completing the request */
+static uint32_t g_wake_cycles = 0u;
+static uint32_t g_request_cycles = 0u;
 
 
 /*!
@@ -47,105 +158,1358 @@ enable_global_irq (void)
 
 
 /*!
- * @brief Enable specific NVIC interrupt.
+ * @brief Disable global interrupts.
+ */
+static inline void
+disable_global_irq (void)
+{
+    __asm volatile ("cpsid i" : : : "memory");
+}
+
+
+/*!
+ * @brief Sleep until the next interrupt becomes pending.
  *
- * @param[in] irq_num Interrupt number to enable.
+ * @par
+ * NOTE: Also wakes with interrupts masked; the pending ISR then runs as
+ * soon as they are re-enabled.
  */
 static inline void
-nvic_enable_irq (uint32_t const irq_num)
+wait_for_interrupt (void)
 {
-    volatile uint32_t * p_nvic_iser = (volatile uint32_t *)NVIC_ISER0_BASE;
-    p_nvic_iser[irq_num >> 5u] = (1u << (irq_num & 0x1Fu));
+    __asm volatile ("wfi" : : : "memory");
 }
 
 
 /*!
- * @brief Wait for UART transmitter to become idle.
+ * @brief Start an asynchronous output continuation.
+ *
+ * @param[in] p_data Bytes to transmit; must stay valid until fully queued.
+ * @param[in] len Number of bytes.
+ * @param[in] next_state Scheduler state that drains this output.
  */
 static void
-wait_for_tx_idle (void)
+cli_start_output (char const * p_data, uint32_t len, cli_state_t next_state)
+{
+    g_p_pending_output = p_data;
+    g_pending_length = len;
+    g_cli_state = next_state;
+}
+
+
+/*!
+ * @brief Queue as much pending output as the TX ring accepts.
+ *
+ * @return CLI_TRUE once the whole pending output has been queued.
+ */
+static base_type
+cli_continue_output (void)
+{
+    uint32_t queued = uart_write(g_p_pending_output, g_pending_length);
+
+    g_p_pending_output += queued;
+    g_pending_length -= queued;
+
+    return (0u == g_pending_length) ? CLI_TRUE : CLI_FALSE;
+}
+
+
+/*!
+ * @brief Move g_p_exec to the next command that is not blank.
+ *
+ * @return CLI_TRUE if there is one before g_p_exec_end.
+ */
+static base_type
+cli_batch_skip_blank (void)
 {
-    while (UART_STATE_IDLE != g_tx_state)
+    char const * p_text = NULL;
+
+    while (g_p_exec < g_p_exec_end)
     {
-        /* Busy wait */
+        p_text = g_p_exec;
+
+        while (' ' == *p_text)
+        {
+            p_text++;
+        }
+
+        if ('\0' != *p_text)
+        {
+            return CLI_TRUE;
+        }
+
+        g_p_exec += strlen(g_p_exec) + 1u;
     }
+
+    return CLI_FALSE;
 }
 
 
 /*!
- * @brief Initialize CLI subsystem.
+ * @brief Start executing a block of commands.
+ *
+ * The ';' separators are replaced by terminators in place, so every
+ * command of the block is parsed straight where it was received.
+ *
+ * @param[in,out] p_text First command.
+ * @param[in] p_end One past the terminator of the last command.
+ *
+ * @return CLI_TRUE if the block holds a command to run.
+ */
+static base_type
+cli_batch_begin (char * p_text, char const * p_end)
+{
+    char * p_separator = p_text;
+
+    while (p_separator < p_end)
+    {
+        if (CLI_BATCH_SEPARATOR == *p_separator)
+        {
+            *p_separator = '\0';
+        }
+        p_separator++;
+    }
+
+    g_p_exec = p_text;
+    g_p_exec_end = p_end;
+
+    return cli_batch_skip_blank();
+}
+
+
+/*!
+ * @brief Advance to the next command of the block.
+ *
+ * @return CLI_TRUE if another command follows.
+ */
+static base_type
+cli_batch_next (void)
+{
+    g_p_exec += strlen(g_p_exec) + 1u;
+
+    return cli_batch_skip_blank();
+}
+
+
+/*!
+ * @brief Run the command handler for the next response chunk.
+ *
+ * The handler formats straight into a TX ring reservation, so there is no
+ * intermediate response buffer and no copy or strlen() afterwards. While
+ * earlier chunks are still draining the ring may not have room for a whole
+ * chunk; then nothing is generated and the caller retries after the next
+ * TX_DRAINED event.
+ *
+ * @return CLI_TRUE if a chunk was generated and queued.
+ */
+static base_type
+cli_generate_chunk (void)
+{
+    cli_output_t output;
+
+    output.p_buffer = uart_tx_reserve(CLI_WRITE_BUFFER_SIZE);
+    output.size = CLI_WRITE_BUFFER_SIZE;
+    output.length = 0u;
+
+    if (NULL == output.p_buffer)
+    {
+        return CLI_FALSE;
+    }
+
+    if (CLI_PROTOCOL_BINARY == g_protocol)
+    {
+        g_b_more_output = cli_bin_process_command(&output);
+    }
+    else if (CLI_TRUE == g_b_json_line)
+    {
+        g_b_more_output = cli_json_process_command(&output);
+    }
+    else if (g_b_cancelled && (cli_get_active_command() < 0))
+    {
+        /* The aborted command has stopped: so does the rest of the batch */
+        cli_output_write(&output, "^C\r\n", 4u);
+
+        if (g_b_script_running)
+        {
+            cli_output_printf(&output, "Script: cancelled after %u commands\r\n",
+                              g_script_commands);
+        }
+
+        g_b_cancelled = FALSE;
+        g_b_script_summary = FALSE;
+        g_b_script_running = FALSE;
+        g_b_more_output = CLI_FALSE;
+    }
+    else if (g_b_script_summary)
+    {
+        cli_output_printf(&output, "Script: %u commands run\r\n", g_script_commands);
+        g_b_script_summary = FALSE;
+        g_b_script_running = FALSE;
+        g_b_more_output = CLI_FALSE;
+    }
+    else
+    {
+        g_b_more_output = cli_process_command(g_p_exec, &output);
+
+        /* Next command of the batch or script follows without a prompt */
+        if ((CLI_FALSE == g_b_more_output) && g_b_cancelled)
+        {
+            g_b_more_output = CLI_TRUE;
+        }
+        else if (CLI_FALSE == g_b_more_output)
+        {
+            g_script_commands += g_b_script_running ? 1u : 0u;
+            g_b_more_output = cli_batch_next();
+            g_b_script_summary = (g_b_script_running && (CLI_FALSE == g_b_more_output));
+            g_b_more_output = (g_b_more_output || g_b_script_summary) ? CLI_TRUE : CLI_FALSE;
+        }
+    }
+
+    uart_tx_commit((uint32_t)output.length);
+
+    return CLI_TRUE;
+}
+
+
+/*!
+ * @brief Queue the one-line reply to a Ctrl-T status query.
+ *
+ * Goes out between response chunks, so it answers even while a long
+ * command is streaming.
+ *
+ * @return CLI_TRUE if queued, CLI_FALSE if the TX ring has no room yet.
+ */
+static base_type
+cli_report_status (void)
+{
+    cli_output_t output;
+    char const * p_name = NULL;
+    size_t name_length = 0u;
+
+    output.p_buffer = uart_tx_reserve(STATS_LINE_MAX);
+    output.size = STATS_LINE_MAX;
+    output.length = 0u;
+
+    if (NULL == output.p_buffer)
+    {
+        return CLI_FALSE;
+    }
+
+    p_name = cli_get_command_name(cli_get_active_command(), &name_length);
+
+    if (NULL != p_name)
+    {
+        cli_output_printf(&output, "\r\n[busy: %.*s, ", (int)name_length, p_name);
+    }
+    else
+    {
+        cli_output_printf(&output, "\r\n[idle, ");
+    }
+
+    cli_output_printf(&output, "%u bytes queued%s]\r\n",
+                      UART_TX_RING_SIZE - uart_tx_space(),
+                      uart_tx_paused() ? ", paused" : "");
+    uart_tx_commit((uint32_t)output.length);
+
+    return CLI_TRUE;
+}
+
+
+/*!
+ * @brief Act on the Ctrl-C and Ctrl-T requests taken by the RX interrupt.
  *
- * Configures UART peripheral, registers built-in commands,
- * enables interrupts, and displays welcome message.
+ * Ctrl-C stops a streaming command at its next chunk, together with the
+ * rest of its batch or script; while a line is being typed it drops the
+ * line (and a script being recorded) and prompts again. A line the driver
+ * dropped after a receive error is thrown away here as well, so a noisy
+ * link costs that one line and nothing else.
  */
 static void
-cli_init (void)
+cli_service_oob (void)
 {
-    /* Initialize UART peripheral */
-    (void)uart_init();
+    uint32_t const requests = uart_take_oob();
+    char const * p_data = NULL;
+    uint32_t available = 0u;
+
+    if (uart_take_line_lost() && (CLI_STATE_RECEIVING == g_cli_state) &&
+        (CLI_PROTOCOL_TEXT == g_protocol))
+    {
+        /* The start of the line is already in the editor */
+        g_b_json_line = FALSE;
+        line_edit_begin();
+        cli_start_output(LINE_LOST_MSG, sizeof(LINE_LOST_MSG) - 1u,
+                         CLI_STATE_PROMPTING);
+    }
+
+    if (0u != (requests & UART_OOB_STATUS))
+    {
+        g_b_status_pending = TRUE;
+    }
 
-    /* Register built-in commands */
-    (void)cli_register_command(&g_help_command);
-    (void)cli_register_command(&g_set_command);
-    (void)cli_register_command(&g_get_command);
+    if (g_b_status_pending && (CLI_TRUE == cli_report_status()))
+    {
+        g_b_status_pending = FALSE;
+    }
 
-    /* Enable USART2 interrupt in NVIC */
-    nvic_enable_irq(USART2_IRQ_NUM);
-    enable_global_irq();
+    if (0u == (requests & UART_OOB_CANCEL))
+    {
+        return;
+    }
+
+    if (CLI_STATE_RESPONDING == g_cli_state)
+    {
+        g_b_cancelled = TRUE;
+        (void)cli_cancel();
+    }
+    else if ((CLI_STATE_RECEIVING == g_cli_state) && (CLI_PROTOCOL_TEXT == g_protocol))
+    {
+        /* Whatever is still queued was typed into the dropped line */
+        available = uart_rx_peek(&p_data);
 
-    /* Transmit welcome message */
-    wait_for_tx_idle();
-    (void)uart_transmit_buffer(WELCOME_MSG);
+        while (0u != available)
+        {
+            uart_rx_consume(available);
+            available = uart_rx_peek(&p_data);
+        }
 
-    /* Start listening for first command */
-    (void)uart_receive_buffer();
+        g_b_script_recording = FALSE;
+        g_b_json_line = FALSE;
+        line_edit_begin();
+        cli_start_output(CANCEL_MSG_LINE, sizeof(CANCEL_MSG_LINE) - 1u,
+                         CLI_STATE_PROMPTING);
+    }
+    else
+    {
+        /* Prompt or baud switch in progress - nothing to abort */
+    }
 }
 
 
 /*!
- * @brief Process received CLI commands.
+ * @brief Drop input that follows a JSON request, as set up in g_rx_skip.
  *
- * Called continuously in main loop. When a complete command has been
- * received via UART, parses it, executes the handler, transmits the
- * response, and restarts reception.
+ * JSON requests end at their closing brace, so the line ending the host
+ * sends after it must not reach the text line assembler as an empty line.
  */
 static void
-cli_process (void)
+cli_skip_input (void)
+{
+    char const * p_data = NULL;
+    uint32_t available = uart_rx_peek(&p_data);
+    uint32_t used = 0u;
+    char c = '\0';
+
+    while ((CLI_SKIP_NONE != g_rx_skip) && (0u != available))
+    {
+        used = 0u;
+
+        while ((used < available) && (CLI_SKIP_NONE != g_rx_skip))
+        {
+            c = p_data[used];
+
+            if (CLI_SKIP_LINE == g_rx_skip)
+            {
+                if (('\n' == c) || ('\r' == c))
+                {
+                    g_rx_skip = CLI_SKIP_BLANKS;
+                }
+                used++;
+            }
+            else if ((' ' == c) || ('\t' == c) || ('\n' == c) || ('\r' == c))
+            {
+                used++;
+            }
+            else
+            {
+                /* Start of the next request - leave it in the ring */
+                g_rx_skip = CLI_SKIP_NONE;
+            }
+        }
+
+        uart_rx_consume(used);
+        available = uart_rx_peek(&p_data);
+    }
+}
+
+
+/*!
+ * @brief Feed waiting RX bytes into the JSON request parser.
+ *
+ * Bytes go straight from the RX ring into the parser, which stops at the
+ * end of the request; anything after it stays in the ring.
+ *
+ * @return CLI_TRUE once the request is complete (or was rejected).
+ */
+static base_type
+cli_receive_json (void)
+{
+    char const * p_data = NULL;
+    uint32_t available = uart_rx_peek(&p_data);
+    size_t consumed = 0u;
+    int32_t result = CLI_JSON_FEED_MORE;
+
+    while ((0u != available) && (CLI_JSON_FEED_MORE == result))
+    {
+        result = cli_json_feed(p_data, available, &consumed);
+        uart_rx_consume((uint32_t)consumed);
+        available = uart_rx_peek(&p_data);
+    }
+
+    if (CLI_JSON_FEED_MORE == result)
+    {
+        return CLI_FALSE;
+    }
+
+    g_rx_skip = (CLI_JSON_FEED_DONE == result) ? CLI_SKIP_BLANKS : CLI_SKIP_LINE;
+
+    return CLI_TRUE;
+}
+
+
+/*!
+ * @brief Feed waiting RX bytes into the binary frame decoder.
+ *
+ * @return CLI_TRUE once a frame is complete (or was rejected).
+ */
+static base_type
+cli_receive_frame (void)
+{
+    char const * p_data = NULL;
+    uint32_t available = uart_rx_peek(&p_data);
+    size_t consumed = 0u;
+    int32_t result = CLI_BIN_FEED_MORE;
+
+    while ((0u != available) && (CLI_BIN_FEED_MORE == result))
+    {
+        result = cli_bin_feed(p_data, available, &consumed);
+        uart_rx_consume((uint32_t)consumed);
+        available = uart_rx_peek(&p_data);
+    }
+
+    return (CLI_BIN_FEED_MORE == result) ? CLI_FALSE : CLI_TRUE;
+}
+
+
+/*!
+ * @brief Check whether the next line starts a JSON request.
+ *
+ * @return CLI_TRUE if no text has been assembled yet and '{' is next.
+ */
+static base_type
+cli_receive_starts_json (void)
+{
+    char const * p_data = NULL;
+
+    return ((0u == line_edit_length()) && (0u != uart_rx_peek(&p_data)) &&
+            ('{' == p_data[0])) ? CLI_TRUE : CLI_FALSE;
+}
+
+
+/*!
+ * @brief Edit the command line with bytes waiting in the RX ring.
+ *
+ * Bytes go from the RX ring straight into the line editor, and its echo
+ * straight into a TX ring reservation, one reservation per contiguous RX
+ * run. If the TX ring has no room for the echo the input stays queued and
+ * is retried after the next TX_DRAINED event.
+ *
+ * @return CLI_TRUE when g_line_buffer holds a complete null-terminated line.
+ */
+static base_type
+cli_receive_line (void)
 {
-    static char response_buffer[CLI_WRITE_BUFFER_SIZE];
+    char const * p_data = NULL;
+    uint32_t available = uart_rx_peek(&p_data);
+    char * p_echo = NULL;
+    size_t consumed = 0u;
+    size_t echo_length = 0u;
+    int32_t result = LINE_EDIT_MORE;
 
-    /* Only process when command reception is complete */
-    if (UART_STATE_IDLE == g_rx_state)
+    while ((0u != available) && (LINE_EDIT_MORE == result))
     {
-        
-        /* Null-terminate received command */
-        if (g_rx_index > 0u)
+        p_echo = uart_tx_reserve(CLI_ECHO_SIZE);
+
+        if (NULL == p_echo)
         {
-            g_p_rx_buffer[g_rx_index] = '\0';
+            return CLI_FALSE;
         }
 
-        /* Parse and execute command */
-        (void)cli_process_command(g_p_rx_buffer,
-                                  response_buffer,
-                                  sizeof(response_buffer));
+        result = line_edit_feed(p_data, available, &consumed,
+                                p_echo, CLI_ECHO_SIZE, &echo_length);
+        uart_rx_consume((uint32_t)consumed);
+        uart_tx_commit((uint32_t)echo_length);
+        available = uart_rx_peek(&p_data);
+    }
+
+    return (LINE_EDIT_DONE == result) ? CLI_TRUE : CLI_FALSE;
+}
+
+
+/*!
+ * @brief Check whether a tokenized line is "script <word>".
+ *
+ * @param[in] p_args Tokenized line.
+ * @param[in] p_word Sub-command (null-terminated).
+ *
+ * @return CLI_TRUE if it matches.
+ */
+static base_type
+cli_script_is (cli_args_t const * p_args, char const * p_word)
+{
+    size_t const length = strlen(p_word);
+
+    return ((2 == p_args->argc) && (6u == p_args->arglen[0]) &&
+            (0 == strncmp(p_args->argv[0], "script", 6u)) &&
+            (length == p_args->arglen[1]) &&
+            (0 == strncmp(p_args->argv[1], p_word, length))) ? CLI_TRUE : CLI_FALSE;
+}
+
+
+/*!
+ * @brief Take a completed line while a script is being recorded.
+ *
+ * Lines are appended to the script without a reply or prompt, so a host
+ * can stream them back to back. "script end" starts the run and
+ * "script abort" drops the script.
+ */
+static void
+cli_script_record_line (void)
+{
+    cli_args_t args;
+    uint32_t const length = (uint32_t)line_edit_length();
+
+    (void)cli_tokenize(g_line_buffer, &args);
 
-        /* Wait for transmitter to be ready */
-        wait_for_tx_idle();
+    if (CLI_TRUE == cli_script_is(&args, "end"))
+    {
+        /* Run every recorded command, then report how many ran */
+        g_b_script_recording = FALSE;
+        g_b_script_running = TRUE;
+        g_script_commands = 0u;
+        g_b_more_output = cli_batch_begin(g_script_buffer,
+                                          &g_script_buffer[g_script_length]);
+        g_b_script_summary = (CLI_FALSE == g_b_more_output);
+        g_b_more_output = CLI_TRUE;
+        g_cli_state = CLI_STATE_RESPONDING;
+    }
+    else if (CLI_TRUE == cli_script_is(&args, "abort"))
+    {
+        g_b_script_recording = FALSE;
+        line_edit_begin();
+        cli_start_output(SCRIPT_MSG_DISCARDED, sizeof(SCRIPT_MSG_DISCARDED) - 1u,
+                         CLI_STATE_PROMPTING);
+    }
+    else if ((g_script_length + length + 1u) > CLI_SCRIPT_SIZE)
+    {
+        g_b_script_recording = FALSE;
+        line_edit_begin();
+        cli_start_output(SCRIPT_MSG_TOO_LONG, sizeof(SCRIPT_MSG_TOO_LONG) - 1u,
+                         CLI_STATE_PROMPTING);
+    }
+    else
+    {
+        /* Keep the terminator: recorded lines end in '\0' */
+        (void)memcpy(&g_script_buffer[g_script_length], g_line_buffer, length + 1u);
+        g_script_length += length + 1u;
+        line_edit_begin();
+    }
+}
 
-        /* Send command response */
-        (void)uart_transmit_buffer(response_buffer);
 
-        /* Wait for response transmission to complete */
-        wait_for_tx_idle();
+/*!
+ * @brief Stream the stored key-value pairs, as many per chunk as fit.
+ *
+ * @param[in,out] p_output Output for this chunk.
+ *
+ * @return CLI_FALSE when the dump is complete, CLI_TRUE if more output pending.
+ */
+static base_type
+cli_kv_list (cli_output_t * p_output)
+{
+    static uint32_t entry_index = 0u;
+    char const * p_key = NULL;
+    char const * p_value = NULL;
+    size_t key_len = 0u;
+    size_t value_len = 0u;
+    size_t start_length = p_output->length;
 
-        /* Send command prompt */
-        (void)uart_transmit_buffer(PROMPT);
+    if (CLI_TRUE == cli_cancel_requested())
+    {
+        entry_index = 0u;
+        return CLI_FALSE;
+    }
 
-        /* Reset receive buffer index */
-        g_rx_index = 0u;
+    while (KV_OK == kv_get_entry(entry_index, &p_key, &key_len,
+                                 &p_value, &value_len))
+    {
+        /* "  " + key + " = " + value + "\r\n" */
+        if (((p_output->length + key_len + value_len + 7u) > p_output->size) &&
+            (start_length != p_output->length))
+        {
+            /* Chunk full - resume with this entry on the next call */
+            return CLI_TRUE;
+        }
 
-        /* Restart reception for next command */
-        (void)uart_receive_buffer();
+        cli_output_printf(p_output, "  %.*s = %.*s\r\n",
+                          (int)key_len, p_key, (int)value_len, p_value);
+        entry_index++;
+    }
+
+    entry_index = 0u;
+
+    return CLI_FALSE;
+}
+
+
+/*!
+ * @brief Stream the pairs changed since the previous poll as key=value lines.
+ *
+ * A pair is marked as seen only once its line is in the output, so a
+ * cancelled or interrupted poll leaves the rest for the next one. Nothing
+ * changed means an empty response.
+ *
+ * @param[in,out] p_output Output for this chunk.
+ *
+ * @return CLI_FALSE when the delta is complete, CLI_TRUE if more output pending.
+ */
+static base_type
+cli_kv_poll (cli_output_t * p_output)
+{
+    static uint32_t entry_index = 0u;
+    char const * p_key = NULL;
+    char const * p_value = NULL;
+    size_t key_len = 0u;
+    size_t value_len = 0u;
+    size_t start_length = p_output->length;
+    int32_t index = 0;
+
+    if (CLI_TRUE == cli_cancel_requested())
+    {
+        entry_index = 0u;
+        return CLI_FALSE;
+    }
+
+    index = kv_next_changed(entry_index);
+
+    while ((index >= 0) &&
+           (KV_OK == kv_get_entry((uint32_t)index, &p_key, &key_len, &p_value, &value_len)))
+    {
+        /* key + "=" + value + "\r\n" */
+        if (((p_output->length + key_len + value_len + 3u) > p_output->size) &&
+            (start_length != p_output->length))
+        {
+            /* Chunk full - resume with this entry on the next call */
+            entry_index = (uint32_t)index;
+            return CLI_TRUE;
+        }
+
+        cli_output_write(p_output, p_key, key_len);
+        cli_output_write(p_output, "=", 1u);
+        cli_output_write(p_output, p_value, value_len);
+        cli_output_write(p_output, "\r\n", 2u);
+        kv_clear_changed((uint32_t)index);
+
+        index = kv_next_changed((uint32_t)index + 1u);
+    }
+
+    entry_index = 0u;
+
+    return CLI_FALSE;
+}
+
+
+/*!
+ * @brief Key-value store command handler.
+ *
+ * "kv" reports capacity and fill level, "kv list" streams all pairs,
+ * "kv poll" streams only the pairs changed since the previous poll,
+ * "kv save" appends a snapshot to flash and "kv load" restores the newest
+ * snapshot.
+ *
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line.
+ *
+ * @return CLI_FALSE when complete, CLI_TRUE while "kv list" or "kv poll"
+ *         has more output.
+ */
+static base_type
+cli_kv_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    kv_usage_t usage;
+    uint32_t sequence = 0u;
+
+    if (1 == p_args->argc)
+    {
+        kv_get_usage(&usage);
+        cli_output_printf(p_output, "KV: %u/%u keys, %u/%u arena bytes\r\n",
+                          usage.entries, usage.capacity,
+                          usage.arena_used, usage.arena_size);
+    }
+    else if ((2 == p_args->argc) && (4u == p_args->arglen[1]) &&
+             (0 == strncmp(p_args->argv[1], "list", 4u)))
+    {
+        return cli_kv_list(p_output);
+    }
+    else if ((2 == p_args->argc) && (4u == p_args->arglen[1]) &&
+             (0 == strncmp(p_args->argv[1], "poll", 4u)))
+    {
+        return cli_kv_poll(p_output);
+    }
+    else if ((2 == p_args->argc) && (4u == p_args->arglen[1]) &&
+             (0 == strncmp(p_args->argv[1], "save", 4u)))
+    {
+        if (KV_FLASH_OK == kv_flash_save(&sequence))
+        {
+            cli_output_printf(p_output, "KV: saved snapshot %u\r\n", sequence);
+        }
+        else
+        {
+            cli_output_write(p_output, KV_MSG_WRITE_FAILED,
+                             sizeof(KV_MSG_WRITE_FAILED) - 1u);
+        }
+    }
+    else if ((2 == p_args->argc) && (4u == p_args->arglen[1]) &&
+             (0 == strncmp(p_args->argv[1], "load", 4u)))
+    {
+        if (KV_FLASH_OK == kv_flash_load(&sequence))
+        {
+            cli_output_printf(p_output, "KV: loaded snapshot %u\r\n", sequence);
+        }
+        else
+        {
+            cli_output_write(p_output, KV_MSG_NO_SNAPSHOT,
+                             sizeof(KV_MSG_NO_SNAPSHOT) - 1u);
+        }
+    }
+    else
+    {
+        cli_output_write(p_output, KV_MSG_USAGE, sizeof(KV_MSG_USAGE) - 1u);
+    }
+
+    return CLI_FALSE;
+}
+
+/* Application command: key-value store status and persistence */
+CLI_COMMAND(kv,
+            "\r\nkv [list|poll|save|load]:\r\nShows usage, lists all or changed pairs, saves or loads a snapshot\r\n",
+            NULL, -1, cli_kv_interpreter);
+
+
+/*!
+ * @brief Append one timing slot to the stats report.
+ *
+ * @param[in,out] p_output Output for this chunk.
+ * @param[in] p_name Slot label (not necessarily null-terminated).
+ * @param[in] name_length Length of p_name.
+ * @param[in] slot PROF_SLOT_* index.
+ */
+static void
+cli_stats_slot (cli_output_t * p_output, char const * p_name,
+                size_t name_length, uint32_t slot)
+{
+    prof_stat_t const * p_stat = prof_get(slot);
+
+    /* Commands past the last profiling slot are never timed */
+    if ((NULL == p_stat) || (0u == p_stat->count))
+    {
+        cli_output_printf(p_output, "  %.*s n=0\r\n", (int)name_length, p_name);
+        return;
+    }
+
+    cli_output_printf(p_output, "  %.*s n=%u min=%u avg=%u max=%u\r\n",
+                      (int)name_length, p_name, p_stat->count, p_stat->min,
+                      prof_average(p_stat), p_stat->max);
+}
+
+
+/*!
+ * @brief Stream the stats report, as many lines per chunk as fit.
+ *
+ * Rows are the header, the ISR and latency slots, one per command, and
+ * the UART error counters.
+ *
+ * @param[in,out] p_output Output for this chunk.
+ *
+ * @return CLI_FALSE when the report is complete, CLI_TRUE if more output pending.
+ */
+static base_type
+cli_stats_report (cli_output_t * p_output)
+{
+    static uint32_t row = 0u;
+    uint32_t const command_rows = (uint32_t)cli_get_command_count();
+    char const * p_name = NULL;
+    size_t name_length = 0u;
+    uart_stats_t uart_stats;
+
+    if (CLI_TRUE == cli_cancel_requested())
+    {
+        row = 0u;
+        return CLI_FALSE;
+    }
+
+    while (row <= (command_rows + 4u))
+    {
+        if ((p_output->length + STATS_LINE_MAX) > p_output->size)
+        {
+            /* Chunk full - resume with this row on the next call */
+            return CLI_TRUE;
+        }
+
+        if (0u == row)
+        {
+            cli_output_printf(p_output, "Cycles at %u Hz:\r\n", clock_get_hz());
+        }
+        else if (1u == row)
+        {
+            cli_stats_slot(p_output, "isr.uart", 8u, PROF_SLOT_UART_ISR);
+        }
+        else if (2u == row)
+        {
+            cli_stats_slot(p_output, "isr.dma", 7u, PROF_SLOT_DMA_ISR);
+        }
+        else if (3u == row)
+        {
+            cli_stats_slot(p_output, "latency", 7u, PROF_SLOT_LATENCY);
+        }
+        else if (row < (command_rows + 4u))
+        {
+            p_name = cli_get_command_name((int32_t)(row - 4u), &name_length);
+            cli_stats_slot(p_output, p_name, name_length,
+                           PROF_SLOT_COMMAND + (row - 4u));
+        }
+        else
+        {
+            uart_get_stats(&uart_stats);
+            cli_output_printf(p_output,
+                              "UART errors: ovr=%u fe=%u pe=%u ne=%u drop=%u held=%u lost=%u\r\n",
+                              uart_stats.overrun, uart_stats.framing,
+                              uart_stats.parity, uart_stats.noise,
+                              uart_stats.rx_dropped, uart_stats.rx_held,
+                              uart_stats.rx_lines_lost);
+        }
+
+        row++;
+    }
+
+    row = 0u;
+
+    return CLI_FALSE;
+}
+
+
+/*!
+ * @brief Profiling statistics command handler.
+ *
+ * "stats" reports count/min/avg/max cycles of the UART and DMA interrupt
+ * service, of request latency (from the wakeup that delivered a request's
+ * last byte until its reply is queued) and of every command handler, plus
+ * the UART error counters. "stats reset" clears them all.
+ *
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line.
+ *
+ * @return CLI_FALSE when complete, CLI_TRUE while the report has more output.
+ */
+static base_type
+cli_stats_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    if (1 == p_args->argc)
+    {
+        return cli_stats_report(p_output);
+    }
+
+    if ((2 == p_args->argc) && (5u == p_args->arglen[1]) &&
+        (0 == strncmp(p_args->argv[1], "reset", 5u)))
+    {
+        prof_reset();
+        uart_reset_stats();
+        cli_output_write(p_output, STATS_MSG_RESET, sizeof(STATS_MSG_RESET) - 1u);
+    }
+    else
+    {
+        cli_output_write(p_output, STATS_MSG_USAGE, sizeof(STATS_MSG_USAGE) - 1u);
+    }
+
+    return CLI_FALSE;
+}
+
+/* Application command: timing and error statistics */
+CLI_COMMAND(stats,
+            "\r\nstats [reset]:\r\nShows or clears cycle timings and UART error counts\r\n",
+            NULL, -1, cli_stats_interpreter);
+
+
+/*!
+ * @brief Script command handler.
+ *
+ * "script begin" records the following lines without running them or
+ * prompting; the next "script end" then runs them all in one pass with
+ * their replies back to back, and "script abort" drops them. Those two
+ * are taken by the recorder, so reaching this handler with them means no
+ * script is being recorded.
+ *
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line.
+ *
+ * @return CLI_FALSE (command complete).
+ */
+static base_type
+cli_script_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    if (CLI_TRUE == cli_script_is(p_args, "begin"))
+    {
+        if (g_b_script_running)
+        {
+            cli_output_write(p_output, SCRIPT_MSG_NESTED, sizeof(SCRIPT_MSG_NESTED) - 1u);
+        }
+        else
+        {
+            g_script_length = 0u;
+            g_b_script_recording = TRUE;
+            cli_output_write(p_output, SCRIPT_MSG_RECORDING,
+                             sizeof(SCRIPT_MSG_RECORDING) - 1u);
+        }
+    }
+    else if ((CLI_TRUE == cli_script_is(p_args, "end")) ||
+             (CLI_TRUE == cli_script_is(p_args, "abort")))
+    {
+        cli_output_write(p_output, SCRIPT_MSG_NOT_RECORDING,
+                         sizeof(SCRIPT_MSG_NOT_RECORDING) - 1u);
+    }
+    else
+    {
+        cli_output_write(p_output, SCRIPT_MSG_USAGE, sizeof(SCRIPT_MSG_USAGE) - 1u);
+    }
+
+    return CLI_FALSE;
+}
+
+/* Application command: record and replay a block of commands */
+CLI_COMMAND(script,
+            "\r\nscript begin|end|abort:\r\nRecords lines, then runs them in one pass\r\n",
+            NULL, -1, cli_script_interpreter);
+
+
+/*!
+ * @brief Protocol command handler.
+ *
+ * "proto" reports the current wire protocol, "proto bin" and "proto text"
+ * switch to it after this reply has been sent in the current one.
+ *
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line.
+ *
+ * @return CLI_FALSE (command complete).
+ */
+static base_type
+cli_proto_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    if ((2 == p_args->argc) && (3u == p_args->arglen[1]) &&
+        (0 == strncmp(p_args->argv[1], "bin", 3u)))
+    {
+        g_protocol_next = CLI_PROTOCOL_BINARY;
+    }
+    else if ((2 == p_args->argc) && (4u == p_args->arglen[1]) &&
+             (0 == strncmp(p_args->argv[1], "text", 4u)))
+    {
+        g_protocol_next = CLI_PROTOCOL_TEXT;
+    }
+    else if (1 != p_args->argc)
+    {
+        cli_output_write(p_output, PROTO_MSG_USAGE, sizeof(PROTO_MSG_USAGE) - 1u);
+        return CLI_FALSE;
+    }
+    else
+    {
+        /* Report only */
+    }
+
+    if (CLI_PROTOCOL_BINARY == g_protocol_next)
+    {
+        cli_output_write(p_output, PROTO_MSG_BIN, sizeof(PROTO_MSG_BIN) - 1u);
+    }
+    else
+    {
+        cli_output_write(p_output, PROTO_MSG_TEXT, sizeof(PROTO_MSG_TEXT) - 1u);
+    }
+
+    return CLI_FALSE;
+}
+
+/* Application command: wire protocol selection */
+CLI_COMMAND(proto,
+            "\r\nproto [text|bin]:\r\nShows or switches the wire protocol\r\n",
+            NULL, -1, cli_proto_interpreter);
+
+
+/*!
+ * @brief Baud rate command handler.
+ *
+ * "baud" reports the line rate, "baud <rate> [x8|x16]" validates a new one
+ * and schedules the switch for when this reply has left the wire. The rate
+ * actually reached after divisor rounding is reported back.
+ *
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line.
+ *
+ * @return CLI_FALSE (command complete).
+ */
+static base_type
+cli_baud_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    uint32_t baud = 0u;
+    uint32_t actual = 0u;
+    bool_t b_oversample8 = FALSE;
+    bool_t b_valid = TRUE;
+
+    if (1 == p_args->argc)
+    {
+        baud = uart_get_baud(&b_oversample8);
+        cli_output_printf(p_output, "Baud: %u (%s), clock %u Hz\r\n",
+                          baud, b_oversample8 ? "x8" : "x16", clock_get_hz());
+        return CLI_FALSE;
+    }
+
+    if ((3 == p_args->argc) && (2u == p_args->arglen[2]) &&
+        (0 == strncmp(p_args->argv[2], "x8", 2u)))
+    {
+        b_oversample8 = TRUE;
+    }
+    else if ((3 == p_args->argc) && ((3u != p_args->arglen[2]) ||
+             (0 != strncmp(p_args->argv[2], "x16", 3u))))
+    {
+        b_valid = FALSE;
+    }
+    else
+    {
+        /* 16x oversampling */
+    }
+
+    if ((!b_valid) || (p_args->argc > 3) ||
+        (CLI_FALSE == cli_parse_uint(p_args->argv[1], p_args->arglen[1], &baud)))
+    {
+        cli_output_write(p_output, BAUD_MSG_USAGE, sizeof(BAUD_MSG_USAGE) - 1u);
+        return CLI_FALSE;
+    }
+
+    actual = uart_baud_actual(baud, b_oversample8);
+
+    if (0u == actual)
+    {
+        cli_output_write(p_output, BAUD_MSG_UNSUPPORTED,
+                         sizeof(BAUD_MSG_UNSUPPORTED) - 1u);
+        return CLI_FALSE;
+    }
+
+    g_pending_baud = baud;
+    g_b_pending_oversample8 = b_oversample8;
+    cli_output_printf(p_output, "Baud: switching to %u (actual %u)\r\n",
+                      baud, actual);
+
+    return CLI_FALSE;
+}
+
+/* Application command: line rate */
+CLI_COMMAND(baud,
+            "\r\nbaud [<rate> [x8|x16]]:\r\nShows or changes the UART baud rate\r\n",
+            NULL, -1, cli_baud_interpreter);
+
+
+/*!
+ * @brief Memory budget command handler.
+ *
+ * Reports static RAM (.data, .bss, .noinit), the arena with the peak use
+ * of every pool carved from it, and the deepest stack use since reset.
+ * Peaks are in pool items: entries, tokens, or bytes for byte pools.
+ *
+ * @param[in,out] p_output Output for the response.
+ * @param[in] p_args Tokenized command line (unused).
+ *
+ * @return CLI_FALSE, the report fits one chunk.
+ */
+static base_type
+cli_mem_interpreter (cli_output_t * p_output, cli_args_t const * p_args)
+{
+    arena_usage_t usage;
+    arena_pool_t const * p_pool = arena_get_pools();
+
+    (void)p_args;
+
+    arena_get_usage(&usage);
+    cli_output_printf(p_output, "RAM: %u static, arena %u/%u, stack %u/%u bytes\r\n",
+                      usage.static_bytes, usage.arena_used, usage.arena_size,
+                      usage.stack_used, usage.stack_size);
+
+    while (NULL != p_pool)
+    {
+        cli_output_printf(p_output, "  %s: peak %u/%u x %u bytes\r\n",
+                          p_pool->p_name, p_pool->peak, p_pool->capacity,
+                          p_pool->item_size);
+        p_pool = p_pool->p_next;
+    }
+
+    return CLI_FALSE;
+}
+
+/* Application command: RAM budget */
+CLI_COMMAND(mem,
+            "\r\nmem:\r\nShows static RAM, arena pools with peak use, and stack depth\r\n",
+            NULL, 0, cli_mem_interpreter);
+
+
+/*!
+ * @brief Initialize CLI subsystem.
+ *
+ * Switches to the 64 MHz PLL clock, starts the cycle counter, configures the
+ * UART peripheral, registers built-in commands, restores the
+ * key-value store from flash, enables interrupts, and displays welcome
+ * message.
+ */
+static void
+cli_init (void)
+{
+    /* 64 MHz from the PLL first: the baud divisor derives from it */
+    (void)clock_init();
+
+    /* Cycle counter runs from the final system clock */
+    prof_init();
+    power_init();
+
+    /* Initialize UART peripheral */
+    (void)uart_init();
+    uart_set_oob(TRUE);
+    uart_set_resync(TRUE);
+    line_edit_init(g_line_buffer, sizeof(g_line_buffer));
+
+    /* Working pools come from the arena; a short arena shows in "mem" */
+    (void)cli_json_init();
+    (void)kv_init();
+
+    /* Restore persisted keys; an empty or erased log leaves the store empty */
+    (void)kv_flash_load(NULL);
+
+    /* Console port interrupts were enabled in the NVIC by uart_init() */
+    enable_global_irq();
+
+    /* Transmit welcome message - reception is already running */
+    cli_start_output(WELCOME_MSG, sizeof(WELCOME_MSG) - 1u,
+                     CLI_STATE_PROMPTING);
+}
+
+
+/*!
+ * @brief Leave a completed response: switch protocol, then prompt or not.
+ *
+ * Text commands are followed by a prompt; JSON requests and binary frames
+ * are not, so those links stay one reply per request.
+ */
+static void
+cli_finish_response (void)
+{
+    /* Line buffer is free again */
+    line_edit_begin();
+    g_b_cancelled = FALSE;
+
+    PROF_END(PROF_SLOT_LATENCY, g_request_cycles);
+
+    if (CLI_PROTOCOL_BINARY == g_protocol_next)
+    {
+        /* Binary replies are frames: no prompt */
+        g_protocol = g_protocol_next;
+        g_b_json_line = CLI_FALSE;
+        cli_bin_begin();
+        g_cli_state = CLI_STATE_RECEIVING;
+    }
+    else if ((CLI_TRUE == g_b_json_line) && (CLI_PROTOCOL_TEXT == g_protocol))
+    {
+        /* No prompt: keep the link one JSON object per line */
+        g_b_json_line = CLI_FALSE;
+        g_cli_state = CLI_STATE_RECEIVING;
+    }
+    else
+    {
+        /* Text, or back to text from binary mode */
+        g_protocol = g_protocol_next;
+        g_b_json_line = CLI_FALSE;
+        cli_start_output(PROMPT, sizeof(PROMPT) - 1u, CLI_STATE_PROMPTING);
+    }
+
+    /* Binary payloads carry the control byte values as data, and frames
+       carry their own CRC instead of resyncing on line ends */
+    uart_set_oob((CLI_PROTOCOL_TEXT == g_protocol) ? TRUE : FALSE);
+    uart_set_resync((CLI_PROTOCOL_TEXT == g_protocol) ? TRUE : FALSE);
+}
+
+
+/*!
+ * @brief Advance the CLI scheduler as far as possible without blocking.
+ *
+ * Called after every wakeup. When a complete command has been received via
+ * UART, parses it, executes the handler, and starts the response output.
+ * Response and prompt are continuations that resume whenever the TX ring
+ * frees space; a handler returning CLI_TRUE is called again for the next
+ * chunk as soon as the previous one is queued. A baud rate change waits
+ * until the reply has drained. The next line keeps arriving in the RX
+ * ring meanwhile.
+ */
+static void
+cli_process (void)
+{
+    base_type b_progress = CLI_TRUE;
+    int32_t baud_result;
+
+    while (CLI_TRUE == b_progress)
+    {
+        b_progress = CLI_FALSE;
+
+        /* Priority lane: control bytes act before the next step of the request */
+        cli_service_oob();
+
+        switch (g_cli_state)
+        {
+            case CLI_STATE_RECEIVING:
+            {
+                if (CLI_PROTOCOL_BINARY == g_protocol)
+                {
+                    if (CLI_TRUE == cli_receive_frame())
+                    {
+                        g_request_cycles = g_wake_cycles;
+                        g_b_more_output = CLI_TRUE;
+                        g_cli_state = CLI_STATE_RESPONDING;
+                        b_progress = CLI_TRUE;
+                    }
+                    break;
+                }
+
+                cli_skip_input();
+
+                if ((CLI_FALSE == g_b_json_line) && (CLI_TRUE == cli_receive_starts_json()))
+                {
+                    /* Stream the request into the JSON parser as it arrives */
+                    g_b_json_line = CLI_TRUE;
+                    cli_json_begin();
+                }
+
+                /* Only process when command reception is complete */
+                if (((CLI_TRUE == g_b_json_line) && (CLI_TRUE == cli_receive_json())) ||
+                    ((CLI_FALSE == g_b_json_line) && (CLI_TRUE == cli_receive_line())))
+                {
+                    g_request_cycles = g_wake_cycles;
+                    b_progress = CLI_TRUE;
+
+                    if ((CLI_FALSE == g_b_json_line) && g_b_script_recording)
+                    {
+                        cli_script_record_line();
+                        break;
+                    }
+
+                    /* A text line may be a ';' batch; a blank one only gets a new prompt */
+                    g_b_more_output = (CLI_TRUE == g_b_json_line) ? CLI_TRUE :
+                                      cli_batch_begin(g_line_buffer,
+                                                      &g_line_buffer[line_edit_length() + 1u]);
+                    g_cli_state = CLI_STATE_RESPONDING;
+                }
+                break;
+            }
+
+            case CLI_STATE_RESPONDING:
+            {
+                if (CLI_TRUE == g_b_more_output)
+                {
+                    /* Next chunk formats while the previous one transmits */
+                    b_progress = cli_generate_chunk();
+                }
+                else if (0u != g_pending_baud)
+                {
+                    /* Reply must leave at the old rate first */
+                    g_cli_state = CLI_STATE_SWITCHING_BAUD;
+                    b_progress = CLI_TRUE;
+                }
+                else
+                {
+                    cli_finish_response();
+                    b_progress = CLI_TRUE;
+                }
+                break;
+            }
+
+            case CLI_STATE_SWITCHING_BAUD:
+            {
+                /* Retried on every TX_DRAINED until the ring has emptied (-2);
+                   a rate the clock can no longer reach (-1) ends it too */
+                baud_result = uart_set_baud(g_pending_baud, g_b_pending_oversample8);
+
+                if (-2 != baud_result)
+                {
+                    g_pending_baud = 0u;
+                    cli_finish_response();
+                    b_progress = CLI_TRUE;
+
+                    /* Text replies then say so ahead of the prompt */
+                    if ((0 != baud_result) && (CLI_STATE_PROMPTING == g_cli_state))
+                    {
+                        cli_start_output(BAUD_MSG_SWITCH_FAILED,
+                                         sizeof(BAUD_MSG_SWITCH_FAILED) - 1u,
+                                         CLI_STATE_PROMPTING);
+                    }
+                }
+                break;
+            }
+
+            case CLI_STATE_PROMPTING:
+            default:
+            {
+                if (CLI_TRUE == cli_continue_output())
+                {
+                    g_cli_state = CLI_STATE_RECEIVING;
+                    b_progress = CLI_TRUE;
+                }
+                break;
+            }
+        }
+    }
+}
+
+
+/*!
+ * @brief Sleep until a UART interrupt posts an event.
+ *
+ * Events are checked with interrupts masked so one posted just before
+ * WFI still wakes the core. cli_process() re-derives what to do from the
+ * ring state, so the event bits themselves only gate sleeping.
+ *
+ * While a line is awaited and the console has nothing in flight, a console
+ * that can wake from STOP (UART_STOP_WAKEUP) lets the core stop instead.
+ * The LPUART takes the first byte itself on HSI16; the PLL is restored
+ * after the waking interrupt, well within a character time at 115200.
+ */
+static void
+cli_wait_for_event (void)
+{
+    bool_t b_stopped = FALSE;
+
+    disable_global_irq();
+
+    if (0u != uart_take_events())
+    {
+        /* Something to do already */
+    }
+    else if ((CLI_STATE_RECEIVING == g_cli_state) && uart_arm_wakeup())
+    {
+        power_stop();
+        b_stopped = TRUE;
+    }
+    else
+    {
+        wait_for_interrupt();
+    }
+
+    enable_global_irq();
+
+    if (b_stopped)
+    {
+        /* Woke on HSI16: back to the 64 MHz PLL */
+        (void)clock_init();
     }
 }
 
@@ -153,7 +1517,8 @@ cli_process (void)
 /*!
  * @brief Main application entry point.
  *
- * Initializes CLI subsystem and enters infinite command processing loop.
+ * Initializes CLI subsystem and enters infinite event loop: process
+ * whatever is ready, then sleep until the next UART event.
  *
  * @return Never returns (embedded system main loop).
  */
@@ -164,7 +1529,9 @@ main (void)
 
     for (;;)
     {
+        PROF_BEGIN(g_wake_cycles);
         cli_process();
+        cli_wait_for_event();
     }
 
     /* Never reached */
@@ -0,0 +1,72 @@
+/** @file power.c
+ *
+ * @brief STOP mode entry for the idle loop.
+ *
+ * PWR_CR1.LPMS selects STOP 1 once at init; SLEEPDEEP is set only around
+ * the WFI that should stop, so the ordinary idle WFI stays a light Sleep.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include "power.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Register bit position constants */
+#define RCC_APBENR1_PWR_BIT        28u
+#define PWR_CR1_LPMS_MASK          0x7u
+#define PWR_CR1_LPMS_STOP1         0x1u
+#define SCB_SCR_SLEEPDEEP_BIT      2u
+
+/* Defining RCC, PWR and SCB Registers used  */
+/*
+
+RCC_APBENR1 --> At an Offset of 0x3C from RCC base (0x40021000)
+PWR_CR1 --> At an Offset of 0x00 from PWR base (0x40007000)
+SCB_SCR --> At 0xE000ED10 (System Control Block)
+
+*/
+#define RCC_APBENR1     ((volatile uint32_t *)0x4002103Cu)
+#define PWR_CR1         ((volatile uint32_t *)0x40007000u)
+#define SCB_SCR         ((volatile uint32_t *)0xE000ED10u)
+
+
+/*!
+ * @brief Clock the PWR block and select STOP 1 as the deep sleep mode.
+ */
+void
+power_init (void)
+{
+    *RCC_APBENR1 |= (1u << RCC_APBENR1_PWR_BIT);
+    *PWR_CR1 = (*PWR_CR1 & ~PWR_CR1_LPMS_MASK) | PWR_CR1_LPMS_STOP1;
+}
+
+
+/*!
+ * @brief Enter STOP 1 until the next wakeup interrupt.
+ *
+ * Returns running from HSI16 (16 MHz) with the PLL off; call clock_init()
+ * to get back to 64 MHz. A USART whose kernel clock is PCLK runs at the
+ * wrong baud rate until then.
+ *
+ * @par
+ * NOTE: Call with interrupts masked, after checking nothing is pending;
+ * the waking interrupt is taken once they are enabled again.
+ */
+void
+power_stop (void)
+{
+    *SCB_SCR |= (1u << SCB_SCR_SLEEPDEEP_BIT);
+    __asm volatile ("wfi" : : : "memory");
+    *SCB_SCR &= ~(1u << SCB_SCR_SLEEPDEEP_BIT);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
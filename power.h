@@ -0,0 +1,33 @@
+/** @file power.h
+ *
+ * @brief STOP mode entry for the idle loop.
+ *
+ * STOP 1 halts every clock but the LSI/LSE and the HSI16 a wakeup-capable
+ * peripheral (LPUART1, see UART_STOP_WAKEUP) requests for itself, with the
+ * regulator in low-power mode; RAM and registers are kept. The core wakes
+ * on HSI16 with the PLL off, so clock_init() has to run again afterwards.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Public API functions */
+void power_init(void);
+void power_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_H */
+
+/*** end of file ***/
@@ -0,0 +1,88 @@
+/** @file prof.h
+ *
+ * @brief Cycle-count instrumentation of the interrupt and command hot paths.
+ *
+ * TIM2 runs free as a 32-bit counter at the system clock, so one tick is
+ * one CPU cycle (15.6 ns at 64 MHz). Each instrumented path owns a slot in
+ * a fixed table holding count, min, max and a running total; the stats
+ * command reports them. Set PROF_ENABLE to 0 to compile the hooks out.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Instrumentation on/off */
+#ifndef PROF_ENABLE
+#define PROF_ENABLE            1u
+#endif
+
+/* Slots for command handlers, indexed by command table index */
+#define PROF_COMMAND_SLOTS     16u
+
+/* Fixed slots, followed by one per command */
+#define PROF_SLOT_UART_ISR     0u   /* USART interrupt service */
+#define PROF_SLOT_DMA_ISR      1u   /* DMA interrupt service */
+#define PROF_SLOT_LATENCY      2u   /* Wakeup with a request's last byte -> reply queued */
+#define PROF_SLOT_COMMAND      3u   /* First command slot */
+#define PROF_SLOT_COUNT        (PROF_SLOT_COMMAND + PROF_COMMAND_SLOTS)
+
+/* TIM2_CNT, free-running cycle counter */
+#define PROF_TIMER_CNT         ((volatile uint32_t *)0x40000024u)
+
+/**
+ * @brief Accumulated timing of one instrumented path, in cycles.
+ */
+typedef struct prof_stat
+{
+    uint32_t count;             /**< Samples in total (halved with it on overflow) */
+    uint32_t min;               /**< Shortest sample (UINT32_MAX while count is 0) */
+    uint32_t max;               /**< Longest sample */
+    uint32_t total;             /**< Sum of samples, total / count is the mean */
+} prof_stat_t;
+
+/* Public API functions */
+void prof_init(void);
+void prof_reset(void);
+void prof_record(uint32_t slot, uint32_t cycles);
+prof_stat_t const * prof_get(uint32_t slot);
+uint32_t prof_average(prof_stat_t const * p_stat);
+
+/*!
+ * @brief Current cycle count.
+ *
+ * @return TIM2 counter; differences are cycles even across wraparound.
+ */
+static inline uint32_t
+prof_now (void)
+{
+    return *PROF_TIMER_CNT;
+}
+
+/* Hooks: time the code between PROF_BEGIN and PROF_END into a slot (start is a uint32_t) */
+#if (PROF_ENABLE != 0u)
+#define PROF_BEGIN(start)           ((start) = prof_now())
+#define PROF_ELAPSED(start)         (prof_now() - (start))
+#define PROF_RECORD(slot, cycles)   prof_record((slot), (cycles))
+#else
+#define PROF_BEGIN(start)           ((void)(start))
+#define PROF_ELAPSED(start)         ((void)(start), 0u)
+#define PROF_RECORD(slot, cycles)   ((void)(cycles))
+#endif
+#define PROF_END(slot, start)       PROF_RECORD((slot), PROF_ELAPSED(start))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROF_H */
+
+/*** end of file ***/
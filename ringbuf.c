@@ -0,0 +1,328 @@
+/** @file ringbuf.c
+ *
+ * @brief Lock-free single-producer/single-consumer byte ring buffer.
+ *
+ * Used between the UART interrupt handlers and the main loop. Each index
+ * has exactly one writer; a data memory barrier orders the payload access
+ * against publishing the index so the other side never sees stale bytes.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "ringbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Order payload accesses against index publication */
+#if defined(__ARM_ARCH)
+#define RINGBUF_BARRIER()   __asm volatile ("dmb" : : : "memory")
+#else
+#define RINGBUF_BARRIER()   __sync_synchronize()
+#endif
+
+
+/*!
+ * @brief Initialize a ring buffer over caller-provided storage.
+ *
+ * @param[out] p_ring Ring buffer to initialize.
+ * @param[in] p_storage Backing storage of size bytes.
+ * @param[in] size Storage size in bytes, must be a power of two.
+ *
+ * @return 0 on success, -1 on NULL pointer or invalid size.
+ */
+int32_t
+ringbuf_init (ringbuf_t * p_ring, char * p_storage, uint32_t size)
+{
+    if ((NULL == p_ring) || (NULL == p_storage) ||
+        (0u == size) || (0u != (size & (size - 1u))))
+    {
+        return -1;
+    }
+
+    p_ring->p_storage = p_storage;
+    p_ring->mask = size - 1u;
+    p_ring->head = 0u;
+    p_ring->tail = 0u;
+
+    return 0;
+}
+
+
+/*!
+ * @brief Number of bytes waiting to be consumed.
+ *
+ * @param[in] p_ring Ring buffer.
+ *
+ * @return Bytes currently queued.
+ */
+uint32_t
+ringbuf_count (ringbuf_t const * p_ring)
+{
+    return (p_ring->head - p_ring->tail);
+}
+
+
+/*!
+ * @brief Number of bytes that can still be produced.
+ *
+ * @param[in] p_ring Ring buffer.
+ *
+ * @return Free bytes.
+ */
+uint32_t
+ringbuf_space (ringbuf_t const * p_ring)
+{
+    return ((p_ring->mask + 1u) - (p_ring->head - p_ring->tail));
+}
+
+
+/*!
+ * @brief Produce a single byte.
+ *
+ * @param[in,out] p_ring Ring buffer.
+ * @param[in] c Byte to queue.
+ *
+ * @return TRUE if queued, FALSE if the ring is full.
+ */
+bool_t
+ringbuf_put (ringbuf_t * p_ring, char c)
+{
+    uint32_t head = p_ring->head;
+
+    if ((head - p_ring->tail) > p_ring->mask)
+    {
+        return FALSE;
+    }
+
+    p_ring->p_storage[head & p_ring->mask] = c;
+    RINGBUF_BARRIER();
+    p_ring->head = head + 1u;
+
+    return TRUE;
+}
+
+
+/*!
+ * @brief Produce up to len bytes.
+ *
+ * @param[in,out] p_ring Ring buffer.
+ * @param[in] p_data Bytes to queue.
+ * @param[in] len Number of bytes offered.
+ *
+ * @return Number of bytes actually queued (less than len if ring fills).
+ */
+uint32_t
+ringbuf_write (ringbuf_t * p_ring, char const * p_data, uint32_t len)
+{
+    uint32_t head = p_ring->head;
+    uint32_t offset = 0u;
+    uint32_t first = 0u;
+    uint32_t space = ringbuf_space(p_ring);
+
+    if (len > space)
+    {
+        len = space;
+    }
+
+    /* Copy in at most two runs: up to the end of storage, then wrapped */
+    offset = head & p_ring->mask;
+    first = (p_ring->mask + 1u) - offset;
+
+    if (first > len)
+    {
+        first = len;
+    }
+
+    (void)memcpy(&p_ring->p_storage[offset], p_data, first);
+    (void)memcpy(p_ring->p_storage, &p_data[first], len - first);
+
+    RINGBUF_BARRIER();
+    p_ring->head = head + len;
+
+    return len;
+}
+
+
+/*!
+ * @brief Publish len bytes already placed in storage by the producer.
+ *
+ * Used when the payload is written by hardware (DMA) rather than by
+ * ringbuf_write().
+ *
+ * @param[in,out] p_ring Ring buffer.
+ * @param[in] len Number of bytes to publish.
+ */
+void
+ringbuf_produce (ringbuf_t * p_ring, uint32_t len)
+{
+    RINGBUF_BARRIER();
+    p_ring->head = p_ring->head + len;
+}
+
+
+/*!
+ * @brief Reserve len contiguous bytes at the head for in-place production.
+ *
+ * Lets a producer format data straight into the ring. The storage must
+ * extend at least len - 1 bytes past the ring size; bytes that land in
+ * that slack are folded back to the start of storage by ringbuf_commit().
+ *
+ * @param[in] p_ring Ring buffer.
+ * @param[in] len Number of bytes wanted.
+ *
+ * @return Pointer to the reserved bytes, or NULL if fewer than len are free.
+ */
+char *
+ringbuf_reserve (ringbuf_t * p_ring, uint32_t len)
+{
+    if (len > ringbuf_space(p_ring))
+    {
+        return NULL;
+    }
+
+    return &p_ring->p_storage[p_ring->head & p_ring->mask];
+}
+
+
+/*!
+ * @brief Publish len bytes written into space from ringbuf_reserve().
+ *
+ * @param[in,out] p_ring Ring buffer.
+ * @param[in] len Number of bytes actually written (at most the reservation).
+ */
+void
+ringbuf_commit (ringbuf_t * p_ring, uint32_t len)
+{
+    uint32_t offset = p_ring->head & p_ring->mask;
+    uint32_t size = p_ring->mask + 1u;
+
+    /* Only a reservation that crossed the end of storage costs a copy */
+    if ((offset + len) > size)
+    {
+        (void)memcpy(p_ring->p_storage, &p_ring->p_storage[size],
+                     (offset + len) - size);
+    }
+
+    ringbuf_produce(p_ring, len);
+}
+
+
+/*!
+ * @brief Consume a single byte.
+ *
+ * @param[in,out] p_ring Ring buffer.
+ * @param[out] p_c Storage for the byte.
+ *
+ * @return TRUE if a byte was read, FALSE if the ring is empty.
+ */
+bool_t
+ringbuf_get (ringbuf_t * p_ring, char * p_c)
+{
+    uint32_t tail = p_ring->tail;
+
+    if (p_ring->head == tail)
+    {
+        return FALSE;
+    }
+
+    RINGBUF_BARRIER();
+    *p_c = p_ring->p_storage[tail & p_ring->mask];
+    RINGBUF_BARRIER();
+    p_ring->tail = tail + 1u;
+
+    return TRUE;
+}
+
+
+/*!
+ * @brief Consume up to len bytes.
+ *
+ * @param[in,out] p_ring Ring buffer.
+ * @param[out] p_data Destination buffer.
+ * @param[in] len Destination capacity.
+ *
+ * @return Number of bytes actually read.
+ */
+uint32_t
+ringbuf_read (ringbuf_t * p_ring, char * p_data, uint32_t len)
+{
+    uint32_t tail = p_ring->tail;
+    uint32_t offset = 0u;
+    uint32_t first = 0u;
+    uint32_t count = ringbuf_count(p_ring);
+
+    if (len > count)
+    {
+        len = count;
+    }
+
+    RINGBUF_BARRIER();
+
+    offset = tail & p_ring->mask;
+    first = (p_ring->mask + 1u) - offset;
+
+    if (first > len)
+    {
+        first = len;
+    }
+
+    (void)memcpy(p_data, &p_ring->p_storage[offset], first);
+    (void)memcpy(&p_data[first], p_ring->p_storage, len - first);
+
+    RINGBUF_BARRIER();
+    p_ring->tail = tail + len;
+
+    return len;
+}
+
+
+/*!
+ * @brief Get the longest run of queued bytes that is contiguous in storage.
+ *
+ * Lets a consumer such as the TX DMA read straight out of the ring. Follow
+ * with ringbuf_consume() once the bytes have been used.
+ *
+ * @param[in] p_ring Ring buffer.
+ * @param[out] pp_data Set to the first queued byte.
+ *
+ * @return Length of the contiguous run (0 if empty).
+ */
+uint32_t
+ringbuf_peek_contiguous (ringbuf_t const * p_ring, char const ** pp_data)
+{
+    uint32_t tail = p_ring->tail;
+    uint32_t count = p_ring->head - tail;
+    uint32_t offset = tail & p_ring->mask;
+    uint32_t run = (p_ring->mask + 1u) - offset;
+
+    RINGBUF_BARRIER();
+    *pp_data = &p_ring->p_storage[offset];
+
+    return (count < run) ? count : run;
+}
+
+
+/*!
+ * @brief Release len bytes obtained with ringbuf_peek_contiguous().
+ *
+ * @param[in,out] p_ring Ring buffer.
+ * @param[in] len Number of bytes to release.
+ */
+void
+ringbuf_consume (ringbuf_t * p_ring, uint32_t len)
+{
+    RINGBUF_BARRIER();
+    p_ring->tail = p_ring->tail + len;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** end of file ***/
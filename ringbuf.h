@@ -0,0 +1,61 @@
+/** @file ringbuf.h
+ *
+ * @brief Lock-free single-producer/single-consumer byte ring buffer.
+ *
+ * One side (e.g. an ISR) only ever writes the head index, the other side
+ * (e.g. the main loop) only ever writes the tail index. Indices run freely
+ * and are masked by the power-of-two size, so no critical section is needed:
+ * aligned 32-bit loads and stores are single-copy atomic on Cortex-M0+.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include <stdint.h>
+#include "types.h"  /* For bool_t type */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief SPSC ring buffer control block.
+ */
+typedef struct ringbuf
+{
+    char * p_storage;           /**< Backing storage (size bytes) */
+    uint32_t mask;              /**< size - 1, size is a power of two */
+    volatile uint32_t head;     /**< Free-running write index (producer only) */
+    volatile uint32_t tail;     /**< Free-running read index (consumer only) */
+} ringbuf_t;
+
+/* Setup */
+int32_t ringbuf_init(ringbuf_t * p_ring, char * p_storage, uint32_t size);
+
+/* Either side */
+uint32_t ringbuf_count(ringbuf_t const * p_ring);
+uint32_t ringbuf_space(ringbuf_t const * p_ring);
+
+/* Producer side */
+bool_t ringbuf_put(ringbuf_t * p_ring, char c);
+uint32_t ringbuf_write(ringbuf_t * p_ring, char const * p_data, uint32_t len);
+void ringbuf_produce(ringbuf_t * p_ring, uint32_t len);
+char * ringbuf_reserve(ringbuf_t * p_ring, uint32_t len);
+void ringbuf_commit(ringbuf_t * p_ring, uint32_t len);
+
+/* Consumer side */
+bool_t ringbuf_get(ringbuf_t * p_ring, char * p_c);
+uint32_t ringbuf_read(ringbuf_t * p_ring, char * p_data, uint32_t len);
+uint32_t ringbuf_peek_contiguous(ringbuf_t const * p_ring, char const ** pp_data);
+void ringbuf_consume(ringbuf_t * p_ring, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RINGBUF_H */
+
+/*** end of file ***/
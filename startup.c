@@ -1,4 +1,6 @@
 #include <stdint.h>
+#include "clock.h"
+#include "startup.h"
 
 /* -------------------------------------------------------------------------- */
 /* Linker Script Symbol Declarations                     */
@@ -10,6 +12,8 @@ extern uint32_t _sdata;         /* Start of .data in RAM */
 extern uint32_t _edata;         /* End of .data in RAM */
 extern uint32_t _sbss;          /* Start of .bss in RAM */
 extern uint32_t _ebss;          /* End of .bss in RAM */
+/* .noinit follows .bss and is deliberately left as found (see startup.h) */
+extern uint32_t __arena_end;    /* End of the arena, bottom of the stack room */
 extern uint32_t _top_of_stack;  /* Top of RAM, defined in Linker.ld */
 
 /* -------------------------------------------------------------------------- */
@@ -18,31 +22,101 @@ extern uint32_t _top_of_stack;  /* Top of RAM, defined in Linker.ld */
 extern int main(void);
 void Reset_Handler(void);
 void Default_Handler(void);
+extern void USART1_IRQHandler(void);
 extern void USART2_IRQHandler(void);
+extern void USART3_4_LPUART1_IRQHandler(void);
+extern void DMA1_Channel1_IRQHandler(void);
+extern void DMA1_Channel2_3_IRQHandler(void);
+extern void DMA1_Channel4_5_6_7_IRQHandler(void);
 
 /* -------------------------------------------------------------------------- */
 /* The "Ignition Sequence" (Reset Handler)                   */
 /* -------------------------------------------------------------------------- */
-void Reset_Handler(void) {
-    uint32_t *src, *dst;
+/* Copy [p_dst, p_end) from p_src, three words per ldm/stm pair. Both
+   sections are word aligned and padded to whole words by Linker.ld.
+   r7 is left alone: it is the Thumb frame pointer, which GCC keeps at -O0
+   and will not allow as a clobber then. */
+static void startup_copy(uint32_t *p_dst, uint32_t const *p_src, uint32_t const *p_end) {
+#if defined(__ARM_ARCH)
+    uint32_t left = (uint32_t)((uintptr_t)p_end - (uintptr_t)p_dst);
 
-    /* 1. Copy the .data section from FLASH to RAM */
-    src = &_sidata; // Start of .data in FLASH
-    dst = &_sdata; // Start of .data in RAM
-    while (dst < &_edata) {
-        *dst++ = *src++;
+    __asm volatile (
+        ".syntax unified\n"
+        "    b       2f\n"
+        "1:  ldmia   %[src]!, {r4-r6}\n"
+        "    stmia   %[dst]!, {r4-r6}\n"
+        "2:  subs    %[left], #12\n"
+        "    bhs     1b\n"
+        "    adds    %[left], #12\n"
+        "    b       4f\n"
+        "3:  ldmia   %[src]!, {r4}\n"
+        "    stmia   %[dst]!, {r4}\n"
+        "4:  subs    %[left], #4\n"
+        "    bhs     3b\n"
+        : [src] "+l" (p_src), [dst] "+l" (p_dst), [left] "+l" (left)
+        :
+        : "r4", "r5", "r6", "cc", "memory");
+#else
+    while (p_dst < p_end) {
+        *p_dst++ = *p_src++;
     }
+#endif
+}
+
+/* Fill [p_dst, p_end) with value, three words per stm (r7 as above). */
+static void startup_fill(uint32_t *p_dst, uint32_t const *p_end, uint32_t value) {
+#if defined(__ARM_ARCH)
+    uint32_t left = (uint32_t)((uintptr_t)p_end - (uintptr_t)p_dst);
 
-    /* 2. Clear the .bss section in RAM */
-    dst = &_sbss;
-    while (dst < &_ebss) {
-        *dst++ = 0;
+    __asm volatile (
+        ".syntax unified\n"
+        "    movs    r4, %[value]\n"
+        "    movs    r5, %[value]\n"
+        "    movs    r6, %[value]\n"
+        "    b       2f\n"
+        "1:  stmia   %[dst]!, {r4-r6}\n"
+        "2:  subs    %[left], #12\n"
+        "    bhs     1b\n"
+        "    adds    %[left], #12\n"
+        "    b       4f\n"
+        "3:  stmia   %[dst]!, {r4}\n"
+        "4:  subs    %[left], #4\n"
+        "    bhs     3b\n"
+        : [dst] "+l" (p_dst), [left] "+l" (left)
+        : [value] "l" (value)
+        : "r4", "r5", "r6", "cc", "memory");
+#else
+    while (p_dst < p_end) {
+        *p_dst++ = value;
     }
+#endif
+}
+
+void Reset_Handler(void) {
+    uint32_t frame = 0u;
+
+    /* 1. Move to the 64 MHz PLL first so the copy and zero loops below,
+          and everything after them, already run at full speed. clock_init()
+          only touches RCC and FLASH (its state variable is re-read from the
+          hardware when main() calls it again). */
+    (void)clock_init();
+
+    /* 2. Copy the .data section from FLASH to RAM */
+    startup_copy(&_sdata, &_sidata, &_edata);
+
+    /* 3. Clear the .bss section in RAM (.noinit is skipped) */
+    startup_fill(&_sbss, &_ebss, 0u);
+
+    /* 4. Paint the stack room below this frame (64 bytes of margin) so
+          the mem command can tell how deep the stack has ever been */
+    startup_fill(&__arena_end,
+                 (uint32_t const *)(((uintptr_t)&frame - 64u) & ~(uintptr_t)3u),
+                 STARTUP_STACK_PAINT);
 
-    /* 3. Call the application's main() function */
+    /* 5. Call the application's main() function */
     main();
 
-    /* 4. If main() ever returns, loop forever */
+    /* 6. If main() ever returns, loop forever */
     while (1);
 }
 
@@ -88,9 +162,9 @@ const uint32_t g_pfnVectors[] = {
     (uint32_t)&Default_Handler, // 6. EXTI2_3
     (uint32_t)&Default_Handler, // 7. EXTI4_15
     0,                          // 8. Reserved
-    (uint32_t)&Default_Handler, // 9. DMA_Channel1
-    (uint32_t)&Default_Handler, // 10. DMA_Channel2_3
-    (uint32_t)&Default_Handler, // 11. DMA_Channel4_5_6_7
+    (uint32_t)&DMA1_Channel1_IRQHandler, // 9. DMA_Channel1
+    (uint32_t)&DMA1_Channel2_3_IRQHandler, // 10. DMA_Channel2_3
+    (uint32_t)&DMA1_Channel4_5_6_7_IRQHandler, // 11. DMA_Channel4_5_6_7
     (uint32_t)&Default_Handler, // 12. ADC_COMP
     (uint32_t)&Default_Handler, // 13. TIM1_BRK_UP_TRG_COM
     (uint32_t)&Default_Handler, // 14. TIM1_CC
@@ -106,9 +180,9 @@ const uint32_t g_pfnVectors[] = {
     (uint32_t)&Default_Handler, // 24. I2C2
     (uint32_t)&Default_Handler, // 25. SPI1
     (uint32_t)&Default_Handler, // 26. SPI2
-    (uint32_t)&Default_Handler, // 27. USART1
+    (uint32_t)&USART1_IRQHandler, // 27. USART1
     (uint32_t)&USART2_IRQHandler, // 28. USART2
-    (uint32_t)&Default_Handler, // 29. USART3_4_LPUART1
+    (uint32_t)&USART3_4_LPUART1_IRQHandler, // 29. USART3_4_LPUART1
     (uint32_t)&Default_Handler, // 30. CEC
     (uint32_t)&Default_Handler  // 31. AES_RNG
 };
@@ -0,0 +1,36 @@
+/** @file startup.h
+ *
+ * @brief Reset-time memory setup shared with the application.
+ *
+ * Reset_Handler brings the clock up, copies .data and zeroes .bss before
+ * main() runs. Large buffers whose contents are always written before
+ * they are read can skip the zeroing by living in .noinit instead, which
+ * the linker places after .bss and the startup code leaves untouched.
+ * The RAM between the arena and the initial stack is painted with
+ * STARTUP_STACK_PAINT so the deepest stack use can be measured later.
+ *
+ * @par
+ * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Keep a zero-initialized buffer out of .bss: it holds garbage at boot */
+#define STARTUP_NOINIT    __attribute__((section(".noinit")))
+
+/* Pattern painted over the free stack at reset, for the stack high-water
+   mark (arena_get_usage()) */
+#define STARTUP_STACK_PAINT   0xA5A5A5A5u
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STARTUP_H */
+
+/*** end of file ***/
@@ -66,7 +66,8 @@ void* _sbrk(int incr) {
     }
   //  prev_heap_end = heap_end;
 
-    // We don't have a real heap, so we just return an out-of-memory error.
+    // We don't have a real heap: the heap region is the static arena that
+    // modules carve their pools from (arena.c), so malloc always fails.
     errno = ENOMEM;
     return (void *)-1;
 }
\ No newline at end of file
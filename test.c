@@ -1,10 +1,19 @@
 /** @file test.c
  *
- * @brief UART driver testing application with echo and normal modes.
+ * @brief UART driver test and benchmark application.
  *
- * Provides two test modes:
+ * Provides the test modes selected by UART_CONFIG:
  * - UART_MODE_NORMAL: Periodic transmission of test string
  * - UART_MODE_ECHO: Echo received data back to sender
+ * - UART_MODE_TX_BENCH: Keep the TX ring full; report bytes/s once a second
+ * - UART_MODE_LOOPBACK: Echo a host stream as fast as possible; report
+ *   bytes/s once the stream has stopped for a second
+ * - UART_MODE_PINGPONG: Send numbered probes and time their return, with
+ *   the host echoing bytes or a TX-RX jumper fitted
+ *
+ * Every benchmark report includes bytes lost to a full RX ring and the
+ * hardware error counters, so a driver change (DMA, ring sizes, baud
+ * rate) can be validated on the board. Build with "make bench".
  *
  * @par
  * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
@@ -12,19 +21,333 @@
 
 #include <stdint.h>
 #include <stddef.h>
-#include <stdio.h>
-#include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
 #include "uart.h"
 #include "types.h"  /* For bool_t type */
+#include "clock.h"
+#include "prof.h"
+#include "cli-fmt.h"
 
 /* Delay between normal mode transmissions in milliseconds */
 #define NORMAL_MODE_TX_DELAY_MS    5000u
 
-/* External UART state variables */
-extern volatile uart_state_t g_tx_state;
-extern volatile uart_state_t g_rx_state;
-extern char * g_p_rx_buffer;
+/* Benchmark reporting */
+#define BENCH_REPORT_SIZE          112u
+#define BENCH_REPORT_PERIOD_MS     1000u    /* TX_BENCH window */
+#define BENCH_IDLE_MS              1000u    /* LOOPBACK end-of-stream gap */
+
+/* Ping-pong rounds and per-probe timeout */
+#define BENCH_PING_ROUNDS          100u
+#define BENCH_PING_TIMEOUT_MS      200u
+#define BENCH_PING_PAUSE_MS        1000u
+#define BENCH_PROBE_SIZE           7u       /* "#" + 4 hex digits + "\r\n" */
+
+/* Echo mode staging buffer */
+static char g_echo_buffer[RX_BUFFER_SIZE_BYTES];
+
+/* Sustained TX payload: 64 bytes per write, line-terminated */
+static char const BENCH_TX_PATTERN[] =
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz\r\n";
+
+
+/*!
+ * @brief Enable global interrupts.
+ */
+static inline void
+enable_global_irq (void)
+{
+    __asm volatile ("cpsie i" : : : "memory");
+}
+
+
+/*!
+ * @brief Milliseconds since the first call, derived from the cycle counter.
+ *
+ * Folds whole milliseconds out of the TIM2 count, so it keeps counting
+ * past the 32-bit cycle wrap as long as it is called at least once
+ * every 67 s.
+ *
+ * @return Elapsed milliseconds.
+ */
+static uint32_t
+bench_millis (void)
+{
+    static uint32_t last_cycles = 0u;
+    static uint32_t millis = 0u;
+    static bool_t b_started = FALSE;
+    uint32_t const cycles_per_ms = clock_get_hz() / 1000u;
+
+    if (!b_started)
+    {
+        last_cycles = prof_now();
+        b_started = TRUE;
+    }
+
+    while ((prof_now() - last_cycles) >= cycles_per_ms)
+    {
+        last_cycles += cycles_per_ms;
+        millis++;
+    }
+
+    return millis;
+}
+
+
+/*!
+ * @brief Throughput in bytes per second without 64-bit division.
+ *
+ * @param[in] bytes Bytes moved.
+ * @param[in] millis Time taken (0 is treated as 1 ms).
+ *
+ * @return Bytes per second.
+ */
+static uint32_t
+bench_rate (uint32_t bytes, uint32_t millis)
+{
+    if (0u == millis)
+    {
+        millis = 1u;
+    }
+
+    return ((bytes / millis) * 1000u) + (((bytes % millis) * 1000u) / millis);
+}
+
+
+/*!
+ * @brief Queue a formatted report line, waiting for TX space if needed.
+ *
+ * @param[in] p_format Format string (see cli-fmt.h).
+ */
+static void
+bench_report (char const * p_format, ...)
+{
+    char report[BENCH_REPORT_SIZE];
+    size_t length = 0u;
+    va_list args;
+
+    va_start(args, p_format);
+    length = cli_vfmt(report, sizeof(report), p_format, args);
+    va_end(args);
+
+    while (uart_tx_space() < (uint32_t)length)
+    {
+        /* Previous output still draining */
+    }
+
+    (void)uart_write(report, (uint32_t)length);
+}
+
+
+/*!
+ * @brief Sustained transmit: keep the TX ring full of the test pattern.
+ *
+ * The first report after a baud change reads low by the lines in flight;
+ * later ones show the steady state. Received bytes are discarded.
+ */
+static void
+bench_tx_run (void)
+{
+    uint32_t window_start = bench_millis();
+    uint32_t elapsed = 0u;
+    uint32_t bytes = 0u;
+    uint32_t rate = 0u;
+    uart_stats_t stats;
+
+    for (;;)
+    {
+        while (uart_tx_space() >= (sizeof(BENCH_TX_PATTERN) - 1u))
+        {
+            bytes += uart_write(BENCH_TX_PATTERN, sizeof(BENCH_TX_PATTERN) - 1u);
+        }
+
+        (void)uart_read(g_echo_buffer, sizeof(g_echo_buffer));
+        elapsed = bench_millis() - window_start;
+
+        if (elapsed >= BENCH_REPORT_PERIOD_MS)
+        {
+            rate = bench_rate(bytes, elapsed);
+            uart_get_stats(&stats);
+
+            /* 10 bits per 8N1 character */
+            bench_report("TX %u B/s (%u%% of %u baud) drop %u ovr %u fe %u\r\n",
+                         rate, (rate * 10u * 100u) / uart_get_baud(NULL),
+                         uart_get_baud(NULL), stats.rx_dropped,
+                         stats.overrun, stats.framing);
+
+            bytes = 0u;
+            window_start = bench_millis();
+        }
+    }
+}
+
+
+/*!
+ * @brief Loopback: echo a host stream, report once it stops.
+ *
+ * Only as much is read as can be echoed, so a TX bottleneck shows up as
+ * RX bytes dropped rather than being hidden.
+ */
+static void
+bench_loopback_run (void)
+{
+    bool_t b_streaming = FALSE;
+    uint32_t stream_start = 0u;
+    uint32_t last_rx = 0u;
+    uint32_t bytes = 0u;
+    uint32_t length = 0u;
+    uint32_t space = 0u;
+    uart_stats_t stats;
+
+    for (;;)
+    {
+        space = uart_tx_space();
+        length = uart_read(g_echo_buffer,
+                           (space < sizeof(g_echo_buffer)) ? space : sizeof(g_echo_buffer));
+
+        if (0u != length)
+        {
+            if (!b_streaming)
+            {
+                b_streaming = TRUE;
+                bytes = 0u;
+                stream_start = bench_millis();
+                uart_reset_stats();
+            }
+
+            (void)uart_write(g_echo_buffer, length);
+            bytes += length;
+            last_rx = bench_millis();
+        }
+        else if (b_streaming && ((bench_millis() - last_rx) >= BENCH_IDLE_MS))
+        {
+            uart_get_stats(&stats);
+            bench_report("\r\nLOOP %u B in %u ms, %u B/s drop %u ovr %u fe %u\r\n",
+                         bytes, last_rx - stream_start,
+                         bench_rate(bytes, last_rx - stream_start),
+                         stats.rx_dropped, stats.overrun, stats.framing);
+            b_streaming = FALSE;
+        }
+        else
+        {
+            /* Waiting for the stream */
+        }
+    }
+}
+
+
+/*!
+ * @brief Wait for one probe to come back.
+ *
+ * Bytes that are not the probe (report lines echoed back, stale data)
+ * are skipped.
+ *
+ * @param[in] p_probe Probe that was sent.
+ * @param[in] sent_at bench_millis() when it was sent.
+ *
+ * @return TRUE if the probe returned before BENCH_PING_TIMEOUT_MS.
+ */
+static bool_t
+bench_ping_wait (char const * p_probe, uint32_t sent_at)
+{
+    uint32_t matched = 0u;
+    char c = '\0';
+
+    while ((bench_millis() - sent_at) < BENCH_PING_TIMEOUT_MS)
+    {
+        if (1u != uart_read(&c, 1u))
+        {
+            continue;
+        }
+
+        if (c == p_probe[matched])
+        {
+            matched++;
+        }
+        else
+        {
+            matched = (c == p_probe[0]) ? 1u : 0u;
+        }
+
+        if (BENCH_PROBE_SIZE == matched)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+
+/*!
+ * @brief Ping-pong: time rounds of numbered probes and report the spread.
+ *
+ * A round trip includes the probe's own line time (7 characters) in both
+ * directions plus the echo turnaround.
+ */
+static void
+bench_pingpong_run (void)
+{
+    char probe[BENCH_PROBE_SIZE + 1u];
+    uint16_t sequence = 0u;
+    uint32_t round = 0u;
+    uint32_t returned = 0u;
+    uint32_t start = 0u;
+    uint32_t rtt = 0u;
+    uint32_t rtt_min = UINT32_MAX;
+    uint32_t rtt_max = 0u;
+    uint32_t rtt_total = 0u;
+    uint32_t const cycles_per_us = clock_get_hz() / 1000000u;
+    uart_stats_t stats;
+
+    for (;;)
+    {
+        returned = 0u;
+        rtt_min = UINT32_MAX;
+        rtt_max = 0u;
+        rtt_total = 0u;
+        uart_reset_stats();
+
+        for (round = 0u; round < BENCH_PING_ROUNDS; round++)
+        {
+            /* Forget anything still arriving from the previous round */
+            while (0u != uart_read(g_echo_buffer, sizeof(g_echo_buffer)))
+            {
+                /* Discard */
+            }
+
+            (void)cli_fmt(probe, sizeof(probe), "#%04x\r\n", (unsigned)sequence);
+            sequence++;
+
+            start = prof_now();
+            (void)uart_write(probe, BENCH_PROBE_SIZE);
+
+            if (bench_ping_wait(probe, bench_millis()))
+            {
+                rtt = (prof_now() - start) / cycles_per_us;
+                rtt_total += rtt;
+                rtt_min = (rtt < rtt_min) ? rtt : rtt_min;
+                rtt_max = (rtt > rtt_max) ? rtt : rtt_max;
+                returned++;
+            }
+        }
+
+        uart_get_stats(&stats);
+
+        if (0u != returned)
+        {
+            bench_report("\r\nPING %u/%u back, rtt min %u avg %u max %u us, drop %u ovr %u fe %u\r\n",
+                         returned, BENCH_PING_ROUNDS, rtt_min, rtt_total / returned,
+                         rtt_max, stats.rx_dropped, stats.overrun, stats.framing);
+        }
+        else
+        {
+            bench_report("\r\nPING 0/%u back (no echo?)\r\n", BENCH_PING_ROUNDS);
+        }
+
+        delay_ms(BENCH_PING_PAUSE_MS);
+    }
+}
 
 
 /*!
@@ -33,45 +356,50 @@ extern char * g_p_rx_buffer;
  * Initializes UART and runs continuous test loop based on UART_CONFIG setting.
  * - NORMAL mode: Transmits test string every 5 seconds
  * - ECHO mode: Receives data and echoes it back
+ * - TX_BENCH, LOOPBACK, PINGPONG: Throughput and latency benchmarks
  *
  * @return Never returns (embedded system main loop).
  */
 int32_t
 main (void)
 {
+    /* Benchmarks time with TIM2 cycles at the 64 MHz system clock */
+    (void)clock_init();
+    prof_init();
+
+    /* Also enables the console port interrupts in the NVIC */
     (void)uart_init();
-    
-    NVIC_EnableIRQ(USART2_IRQn);
-    __enable_irq();
-    
-    (void)uart_receive_buffer();
-    
+    enable_global_irq();
+
+#if (UART_CONFIG == UART_MODE_TX_BENCH)
+    bench_tx_run();
+#elif (UART_CONFIG == UART_MODE_LOOPBACK)
+    bench_loopback_run();
+#elif (UART_CONFIG == UART_MODE_PINGPONG)
+    bench_pingpong_run();
+#endif
+
     for (;;)
     {
 #if (UART_CONFIG == UART_MODE_NORMAL)
         {
             /* Normal mode: periodic transmission */
-            if (UART_STATE_IDLE == g_tx_state)
+            if (uart_tx_idle())
             {
                 (void)uart_transmit_buffer("Hello I am Iron Man\r\n");
                 delay_ms(NORMAL_MODE_TX_DELAY_MS);
             }
 
-            if (UART_STATE_IDLE == g_rx_state)
-            {
-                /* Process received data here as needed */
-                (void)uart_receive_buffer();
-            }
+            /* Process received data here as needed */
+            (void)uart_read(g_echo_buffer, sizeof(g_echo_buffer));
         }
 #else
         {
             /* Echo mode: receive and transmit back */
-            if ((UART_STATE_IDLE == g_rx_state) && 
-                (UART_STATE_IDLE == g_tx_state))
-            {
-                (void)uart_transmit_buffer(g_p_rx_buffer);
-                (void)uart_receive_buffer();
-            }
+            uint32_t length = uart_read(g_echo_buffer,
+                               (uart_tx_space() < sizeof(g_echo_buffer)) ?
+                               uart_tx_space() : sizeof(g_echo_buffer));
+            (void)uart_write(g_echo_buffer, length);
         }
 #endif
     }
@@ -80,4 +408,4 @@ main (void)
     return 0;
 }
 
-/*** end of file ***/
\ No newline at end of file
+/*** end of file ***/
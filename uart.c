@@ -3,7 +3,11 @@
  * @brief UART driver implementation for STM32G0 with interrupt handling.
  *
  * Provides interrupt-driven UART TX/RX with state machine management
- * and hardware error detection/recovery.
+ * and hardware error detection/recovery. Each enabled USART/LPUART runs
+ * from a uart_port_t context: a constant hardware description in flash
+ * (register block, DMA channels, pins, IRQ) plus the rings and state in
+ * RAM. The vector table entries are thin thunks that hand their port(s)
+ * to the shared service routines.
  *
  * @par
  * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
@@ -14,106 +18,203 @@
 #include <string.h>
 #include "uart.h"
 #include "types.h"  /* For bool_t type */
+#include "ringbuf.h"
+#include "startup.h"
+#include "clock.h"
+#include "prof.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if (UART_CONSOLE_ID >= UART_ID_COUNT)
+#error "UART_CONSOLE_ID is not a UART instance"
+#endif
+
+#if (UART_STOP_WAKEUP != 0u) && ((UART_CONSOLE_ID != UART_ID_LPUART1) || (UART_ENABLE_LPUART1 == 0u))
+#error "UART_STOP_WAKEUP needs the console on LPUART1"
+#endif
+
 /* Register bit position constants */
 #define RCC_APBENR1_USART2_BIT     17u
-#define RCC_IOPENR_GPIOA_BIT       0u
+#define RCC_APBENR1_USART3_BIT     18u
+#define RCC_APBENR1_USART4_BIT     19u
+#define RCC_APBENR1_LPUART1_BIT    20u
+#define RCC_APBENR2_USART1_BIT     14u
 #define GPIO_MODER_AF_MODE         0x2u
-#define GPIO_AFR_AF1               0x1u
 #define USART_CR1_UE_BIT           0u
+#define USART_CR1_UESM_BIT         1u
+#define USART_CR1_OVER8_BIT        15u
 #define USART_CR1_TE_BIT           3u
 #define USART_CR1_RE_BIT           2u
 #define USART_CR1_TXEIE_BIT        7u
 #define USART_CR1_RXNEIE_BIT       5u
 #define USART_ISR_TXE_BIT          7u
+#define USART_ISR_TC_BIT           6u
 #define USART_ISR_RXNE_BIT         5u
 #define USART_ISR_ORE_BIT          3u
-#define USART_ISR_FE_BIT           2u
-#define USART_ISR_NF_BIT           1u
+#define USART_ISR_FE_BIT           1u
+#define USART_ISR_NF_BIT           2u
 #define USART_ISR_PE_BIT           0u
+#define USART_ISR_ERROR_MASK       ((1u << USART_ISR_ORE_BIT) | (1u << USART_ISR_FE_BIT) | \
+                                    (1u << USART_ISR_NF_BIT) | (1u << USART_ISR_PE_BIT))
+#define USART_CR1_IDLEIE_BIT       4u
+#define USART_ISR_IDLE_BIT         4u
+#define USART_CR3_EIE_BIT          0u
+#define USART_CR3_DMAR_BIT         6u
+#define USART_CR3_DMAT_BIT         7u
+#define USART_CR3_RTSE_BIT         8u
+#define USART_CR3_CTSE_BIT         9u
+#define USART_CR3_WUS_SHIFT        20u
+#define USART_CR3_WUS_START_BIT    0x2u
+#define USART_CR3_WUFIE_BIT        22u
+#define USART_ISR_BUSY_BIT         16u
+#define USART_ISR_WUF_BIT          20u
+#define RCC_CCIPR_LPUART1SEL_SHIFT 10u
+#define RCC_CCIPR_LPUART1SEL_MASK  0x3u
+#define RCC_CCIPR_SEL_HSI16        0x2u
+#define EXTI_LINE_LPUART1          28u
+
+/* DMA1 / DMAMUX bit position constants */
+#define RCC_AHBENR_DMA1_BIT        0u
+#define DMA_CCR_EN_BIT             0u
+#define DMA_CCR_TCIE_BIT           1u
+#define DMA_CCR_HTIE_BIT           2u
+#define DMA_CCR_DIR_BIT            4u
+#define DMA_CCR_CIRC_BIT           5u
+#define DMA_CCR_MINC_BIT           7u
+#define DMA_FLAGS_PER_CHANNEL      4u
+#define DMA_FLAG_GIF               0x1u
+#define DMA_FLAG_TCIF              0x2u
+#define DMA_FLAG_HTIF              0x4u
+#define DMAMUX_REQ_LPUART1_RX      14u
+#define DMAMUX_REQ_LPUART1_TX      15u
+#define DMAMUX_REQ_USART1_RX       50u
+#define DMAMUX_REQ_USART1_TX       51u
+#define DMAMUX_REQ_USART2_RX       52u
+#define DMAMUX_REQ_USART2_TX       53u
 
 /* Pin configuration constants */
-#define PA2_PIN_NUM                2u
-#define PA3_PIN_NUM                3u
+#define GPIO_PORT_A                0u
+#define GPIO_PORT_B                1u
+#define UART_PIN_NONE              0xFFu
 #define BITS_PER_PIN               2u
 #define AFR_BITS_PER_PIN           4u
-#define PA2_AFR_SHIFT              8u
-#define PA3_AFR_SHIFT              12u
+#define AFR_PINS_PER_REGISTER      8u
+
+/* USARTDIV limits (BRR must be at least 16, 16 bits wide) */
+#define UART_USARTDIV_MIN          16u
+#define UART_USARTDIV_MAX          0xFFFFu
 
-/* Baud rate calculation for 16MHz clock, 9600 baud */
-#define BAUD_RATE_9600_AT_16MHZ    1667u
+/* LPUART BRR = 256 * clock / baud, 0x300..0xFFFFF, baud at most clock / 3 */
+#define LPUART_BRR_MIN             0x300u
+#define LPUART_BRR_MAX             0xFFFFFu
+#define LPUART_BAUD_MAX            0x00FFFFFFu
 
 /* SysTick configuration for 1ms tick */
 #define SYSTICK_CTRL_ENABLE_BIT    0u
 #define SYSTICK_CTRL_CLKSRC_BIT    2u
 #define SYSTICK_CTRL_COUNTFLAG_BIT 16u
 #define SYSTICK_MS_DIVISOR         1000u
-#define SYSTEM_CORE_CLOCK 16000000UL // Default 16 MHz HSI clock
-
-/* Global state variables for UART state machine */
-volatile char const * g_p_tx_buffer;
-char g_rx_buffer_storage[RX_BUFFER_SIZE_BYTES];
-char * g_p_rx_buffer = g_rx_buffer_storage;
-volatile uint32_t g_tx_length;
-volatile uint32_t g_tx_index = 0u;
-volatile uint32_t g_rx_index = 0u;
-volatile uart_state_t g_tx_state = UART_STATE_IDLE;
-volatile uart_state_t g_rx_state = UART_STATE_IDLE;
-volatile uart_error_t g_error = UART_ERROR_NONE;
+
+/* Interrupt Enable Number */
+#define USART1_IRQn                27u
+#define USART2_IRQn                28u
+#define USART3_4_LPUART1_IRQn      29u
+#define DMA1_Channel1_IRQn         9u
+#define DMA1_Channel2_3_IRQn       10u
+#define DMA1_Channel4_5_6_7_IRQn   11u
 
 /* Defining UART Registers used  */
 /*
 
-In this project currently USART2 is chosen so as to transmit the JSON payload into Virtual Com Port
-In STM32G071RBTx uC, USART2 has the possibility of connecting to a virtual com port as it is an internally connected port
-If in the case where the JSON payload needs to be transmitte to a different Rx via a different USART instance, then
-RM0444 specification can be referred and set the USART instances along with their register values accordingly 
+All USART instances and LPUART1 share one register layout (RM0444), so a
+port only needs the base address of its block:
 
-USART_CR1 --> At an Offset of 0x00
-USART_BRR --> At an Offset of 0x0C
-USART_ISR --> At an Offset of 0x1C
-USART_ICR --> At an Offset of 0x20
-USART_RDR --> At an Offset of 0x24
-USART_TDR --> At an Offset of 0x28
+USART1 --> 0x40013800    USART2 --> 0x40004400    USART3 --> 0x40004800
+USART4 --> 0x40004C00    LPUART1 --> 0x40008000
 
 */
-volatile uint32_t * USART2 = (uint32_t *) 0x40004400; 
+typedef struct uart_regs
+{
+    volatile uint32_t CR1;      /* 0x00 */
+    volatile uint32_t CR2;      /* 0x04 */
+    volatile uint32_t CR3;      /* 0x08 */
+    volatile uint32_t BRR;      /* 0x0C */
+    volatile uint32_t GTPR;     /* 0x10 */
+    volatile uint32_t RTOR;     /* 0x14 */
+    volatile uint32_t RQR;      /* 0x18 */
+    volatile uint32_t ISR;      /* 0x1C */
+    volatile uint32_t ICR;      /* 0x20 */
+    volatile uint32_t RDR;      /* 0x24 */
+    volatile uint32_t TDR;      /* 0x28 */
+    volatile uint32_t PRESC;    /* 0x2C */
+} uart_regs_t;
 
-volatile uint32_t * USART_CR1 = (uint32_t *) 0x40004400;
-volatile uint32_t * USART_BRR = (uint32_t *) 0x4000440C;
-volatile uint32_t * USART_ISR = (uint32_t *) 0x4000441C;
-volatile uint32_t * USART_ICR = (uint32_t *) 0x40004420;
-volatile uint32_t * USART_RDR = (uint32_t *) 0x40004424;
-volatile uint32_t * USART_TDR = (uint32_t *) 0x40004428;
+#define USART1_REGS     ((uart_regs_t *)0x40013800u)
+#define USART2_REGS     ((uart_regs_t *)0x40004400u)
+#define USART3_REGS     ((uart_regs_t *)0x40004800u)
+#define USART4_REGS     ((uart_regs_t *)0x40004C00u)
+#define LPUART1_REGS    ((uart_regs_t *)0x40008000u)
 
 /* Defining RCC Registers used  */
 /*
 
 RCC_IOPENR --> At an Offset of 0x34
+RCC_AHBENR --> At an Offset of 0x38
 RCC_APBENR1 --> At an Offset of 0x3C
+RCC_APBENR2 --> At an Offset of 0x40
+RCC_CCIPR --> At an Offset of 0x54
+EXTI_IMR1 --> At an Offset of 0x80 from EXTI base (0x40021800)
 
 */
-volatile uint32_t * RCC = (uint32_t *) 0x40021000;
-
-volatile uint32_t * RCC_IOPENR = (uint32_t *) 0x40021034;
-volatile uint32_t * RCC_APBENR1 = (uint32_t *) 0x4002103C;
+#define RCC_IOPENR      ((volatile uint32_t *)0x40021034u)
+#define RCC_AHBENR      ((volatile uint32_t *)0x40021038u)
+#define RCC_APBENR1     ((volatile uint32_t *)0x4002103Cu)
+#define RCC_APBENR2     ((volatile uint32_t *)0x40021040u)
+#define RCC_CCIPR       ((volatile uint32_t *)0x40021054u)
+#define EXTI_IMR1       ((volatile uint32_t *)0x40021880u)
 
 /* Defining GPIO Registers used  */
 /*
-USART2 is mapped to GPIOA port.
+
+GPIOA at 0x50000000, one 0x400 block per port.
 
 GPIOx_MODER --> At an Offset of 0x00
 GPIOx_AFRL --> At an Offset of 0x20
+GPIOx_AFRH --> At an Offset of 0x24
+
+*/
+#define GPIO_MODER(port)      ((volatile uint32_t *)(uintptr_t)(0x50000000u + (0x400u * (port))))
+#define GPIO_AFR(port, pin)   ((volatile uint32_t *)(uintptr_t)(0x50000020u + (0x400u * (port)) + \
+                                                     (4u * ((pin) / AFR_PINS_PER_REGISTER))))
+
+/* Defining DMA Registers used  */
+/*
+
+DMA1 channel n (1..7) is fed by DMAMUX channel n - 1, which selects the
+USART request. Interrupt flags are four bits per channel in DMA_ISR.
+
+DMA_ISR --> At an Offset of 0x00
+DMA_IFCR --> At an Offset of 0x04
+DMA_CCRn ... DMA_CMARn --> At an Offset of 0x08 + 0x14 * (n - 1)
+DMAMUX_CxCR --> At an Offset of 0x04 * x from DMAMUX base
 
 */
-volatile uint32_t * GPIOA = (uint32_t *) 0x50000000;
+typedef struct uart_dma_channel
+{
+    volatile uint32_t CCR;      /* 0x00 */
+    volatile uint32_t CNDTR;    /* 0x04 */
+    volatile uint32_t CPAR;     /* 0x08 */
+    volatile uint32_t CMAR;     /* 0x0C */
+    volatile uint32_t RESERVED; /* 0x10 */
+} uart_dma_channel_t;
 
-volatile uint32_t * GPIOx_MODER = (uint32_t *) 0x50000000;
-volatile uint32_t * GPIOx_AFRL = (uint32_t *) 0x50000020;
+#define DMA1_ISR                ((volatile uint32_t *)0x40020000u)
+#define DMA1_IFCR               ((volatile uint32_t *)0x40020004u)
+#define DMA1_CHANNEL(n)         ((uart_dma_channel_t *)(uintptr_t)(0x40020008u + (0x14u * ((uint32_t)(n) - 1u))))
+#define DMAMUX_CCR(n)           ((volatile uint32_t *)(uintptr_t)(0x40020800u + (4u * ((uint32_t)(n) - 1u))))
+#define DMA_FLAGS(n, flags)     ((uint32_t)(flags) << (DMA_FLAGS_PER_CHANNEL * ((uint32_t)(n) - 1u)))
 
 /* Defining SysTick Registers used  */
 /*
@@ -122,270 +223,2141 @@ SYST_CSR --> At an Offset of 0x10
 SYST_RVR --> At an Offset of 0x14
 
 */
-volatile uint32_t * SYST_CSR = (uint32_t *) 0xE000E010;
-volatile uint32_t * SYST_RVR = (uint32_t *) 0xE000E014;
+#define SYST_CSR        ((volatile uint32_t *)0xE000E010u)
+#define SYST_RVR        ((volatile uint32_t *)0xE000E014u)
 
 /* Define NVIC Register  */
 #define NVIC_ISER0 ((volatile uint32_t *)0xE000E100)
 
-/* Interrupt Enable Number */
-#define USART2_IRQn 28u
+/* A port uses a DMA engine only if selected and given a channel */
+#define UART_TX_USES_DMA(p_hw)  ((UART_TX_MODE == UART_TX_MODE_DMA) && (0u != (p_hw)->tx_dma_channel))
+#define UART_RX_USES_DMA(p_hw)  ((UART_RX_MODE == UART_RX_MODE_DMA) && (0u != (p_hw)->rx_dma_channel))
 
-/* Inline functions for interrupt control */
-static inline void __enable_irq(void) {
-    __asm volatile ("cpsie i" : : : "memory");
-}
+/* Only LPUART1 keeps its (HSI16) kernel clock through STOP */
+#define UART_WAKES_FROM_STOP(p_hw)  ((UART_STOP_WAKEUP != 0u) && (p_hw)->b_lpuart)
+
+/**
+ * @brief Constant description of one UART instance (lives in flash).
+ */
+typedef struct uart_hw
+{
+    uart_regs_t * p_regs;                   /**< Register block */
+    volatile uint32_t * p_clock_enable;     /**< RCC APBENRx register */
+    uint32_t clock_enable_mask;             /**< Enable bit in it */
+    uint8_t gpio_port;                      /**< 0 = GPIOA, 1 = GPIOB, ... */
+    uint8_t tx_pin;                         /**< TX pin number */
+    uint8_t rx_pin;                         /**< RX pin number */
+    uint8_t pin_af;                         /**< Alternate function of all pins */
+    uint8_t rts_pin;                        /**< RTS pin (same port), UART_PIN_NONE if unrouted */
+    uint8_t cts_pin;                        /**< CTS pin (same port), UART_PIN_NONE if unrouted */
+    uint8_t irq;                            /**< NVIC interrupt number */
+    uint8_t tx_dma_channel;                 /**< DMA1 channel 1..7, 0 = TXE interrupt */
+    uint8_t rx_dma_channel;                 /**< DMA1 channel 1..7, 0 = RXNE interrupt */
+    uint8_t tx_dma_request;                 /**< DMAMUX request id for TX */
+    uint8_t rx_dma_request;                 /**< DMAMUX request id for RX */
+    uint8_t dma_irq;                        /**< NVIC number of the DMA channels */
+    bool_t b_lpuart;                        /**< LPUART baud generator */
+} uart_hw_t;
+
+/**
+ * @brief Runtime context of one UART instance.
+ */
+struct uart_port
+{
+    uart_hw_t const * p_hw;                 /**< Hardware description */
+    char * p_tx_storage;                    /**< TX ring storage (+ reserve slack) */
+    char * p_rx_storage;                    /**< RX ring storage (RX DMA target) */
+    ringbuf_t tx_ring;                      /**< Produced by the app, consumed by ISR/DMA */
+    ringbuf_t rx_ring;                      /**< Produced by ISR/DMA, consumed by the app */
+    volatile uart_state_t tx_state;         /**< Transmit engine state */
+    volatile uart_state_t rx_state;         /**< Receive engine state */
+    volatile uart_error_t error;            /**< Last hardware error */
+    volatile uint32_t error_count[UART_ERROR_NOISE + 1]; /**< Occurrences per uart_error_t */
+    volatile uint32_t rx_dropped;           /**< Bytes lost because the RX ring was full */
+    volatile uint32_t events;               /**< UART_EVENT_* bits posted by the ISRs */
+    volatile bool_t b_oob;                  /**< Control bytes are acted on in the ISR */
+    volatile bool_t b_tx_paused;            /**< XOFF received, TX held until XON */
+    volatile bool_t b_cancel;               /**< Ctrl-C seen, not yet taken */
+    volatile bool_t b_status;               /**< Ctrl-T seen, not yet taken */
+    uint8_t flow;                           /**< UART_FLOW_* in effect on this port */
+    volatile bool_t b_rx_held;              /**< Sender held at the RX high watermark */
+    volatile char flow_char;                /**< XON/XOFF to send ahead of the TX ring, or '\0' */
+    volatile uint32_t rx_held;              /**< Times the sender was held */
+    volatile bool_t b_resync;               /**< A receive error drops the rest of its line */
+    volatile bool_t b_rx_corrupt;           /**< Error seen, reader not yet past its line */
+    volatile uint32_t rx_error_at;          /**< Free-running RX index where the error hit */
+    bool_t b_rx_discarding;                 /**< Reader is dropping up to the next terminator */
+    bool_t b_line_lost;                     /**< A corrupt line was dropped, not yet taken */
+    volatile uint32_t rx_lines_lost;        /**< Lines dropped after receive errors */
+    uint32_t rx_dma_pos;                    /**< Free-running RX DMA write index (ISR only) */
+    volatile bool_t b_rx_overrun;           /**< The DMA overwrote bytes not yet read */
+    volatile uint32_t rx_overrun_to;        /**< Oldest RX index still intact after it */
+    uint32_t tx_dma_length;                 /**< Ring run currently owned by the TX DMA */
+    uint32_t baud;                          /**< Line rate currently programmed */
+    bool_t b_oversample8;                   /**< 8x oversampling selected */
+};
+
+/* Port instance with its own ring storage */
+#define UART_DEFINE_PORT(name, hw)                                          \
+    static char g_##name##_tx_storage[UART_TX_RING_SIZE + UART_TX_RESERVE_MAX] STARTUP_NOINIT; \
+    static char g_##name##_rx_storage[UART_RX_RING_SIZE] STARTUP_NOINIT;    \
+    static uart_port_t g_##name##_port = {                                  \
+        .p_hw = &(hw),                                                      \
+        .p_tx_storage = g_##name##_tx_storage,                              \
+        .p_rx_storage = g_##name##_rx_storage                               \
+    }
+
+#if (UART_ENABLE_USART1 != 0u)
+static uart_hw_t const g_usart1_hw = {
+    USART1_REGS, RCC_APBENR2, (1u << RCC_APBENR2_USART1_BIT),
+    GPIO_PORT_A, 9u, 10u, 1u, 12u, 11u, USART1_IRQn,
+    3u, 4u, DMAMUX_REQ_USART1_TX, DMAMUX_REQ_USART1_RX, DMA1_Channel2_3_IRQn, FALSE
+};
+UART_DEFINE_PORT(usart1, g_usart1_hw);
+#endif
+
+#if (UART_ENABLE_USART2 != 0u)
+/* USART2 is internally connected to the ST-LINK virtual COM port; its
+   RTS/CTS (PA1/PA0) are only on the headers, and PA0/PA1 clash with USART4 */
+static uart_hw_t const g_usart2_hw = {
+    USART2_REGS, RCC_APBENR1, (1u << RCC_APBENR1_USART2_BIT),
+    GPIO_PORT_A, 2u, 3u, 1u, 1u, 0u, USART2_IRQn,
+    1u, 2u, DMAMUX_REQ_USART2_TX, DMAMUX_REQ_USART2_RX, DMA1_Channel1_IRQn, FALSE
+};
+UART_DEFINE_PORT(usart2, g_usart2_hw);
+#endif
+
+#if (UART_ENABLE_USART3 != 0u)
+static uart_hw_t const g_usart3_hw = {
+    USART3_REGS, RCC_APBENR1, (1u << RCC_APBENR1_USART3_BIT),
+    GPIO_PORT_B, 10u, 11u, 4u, 14u, 13u, USART3_4_LPUART1_IRQn,
+    0u, 0u, 0u, 0u, 0u, FALSE
+};
+UART_DEFINE_PORT(usart3, g_usart3_hw);
+#endif
+
+#if (UART_ENABLE_USART4 != 0u)
+static uart_hw_t const g_usart4_hw = {
+    USART4_REGS, RCC_APBENR1, (1u << RCC_APBENR1_USART4_BIT),
+    GPIO_PORT_A, 0u, 1u, 4u, UART_PIN_NONE, UART_PIN_NONE, USART3_4_LPUART1_IRQn,
+    0u, 0u, 0u, 0u, 0u, FALSE
+};
+UART_DEFINE_PORT(usart4, g_usart4_hw);
+#endif
+
+#if (UART_ENABLE_LPUART1 != 0u)
+static uart_hw_t const g_lpuart1_hw = {
+    LPUART1_REGS, RCC_APBENR1, (1u << RCC_APBENR1_LPUART1_BIT),
+    GPIO_PORT_A, 2u, 3u, 6u, UART_PIN_NONE, UART_PIN_NONE, USART3_4_LPUART1_IRQn,
+    5u, 6u, DMAMUX_REQ_LPUART1_TX, DMAMUX_REQ_LPUART1_RX, DMA1_Channel4_5_6_7_IRQn, TRUE
+};
+UART_DEFINE_PORT(lpuart1, g_lpuart1_hw);
+#endif
+
+/* Enabled ports by UART_ID_*, NULL where compiled out */
+static uart_port_t * const g_uart_ports[UART_ID_COUNT] = {
+#if (UART_ENABLE_USART1 != 0u)
+    &g_usart1_port,
+#else
+    NULL,
+#endif
+#if (UART_ENABLE_USART2 != 0u)
+    &g_usart2_port,
+#else
+    NULL,
+#endif
+#if (UART_ENABLE_USART3 != 0u)
+    &g_usart3_port,
+#else
+    NULL,
+#endif
+#if (UART_ENABLE_USART4 != 0u)
+    &g_usart4_port,
+#else
+    NULL,
+#endif
+#if (UART_ENABLE_LPUART1 != 0u)
+    &g_lpuart1_port
+#else
+    NULL
+#endif
+};
+
+/* Port behind the console functions */
+#define UART_CONSOLE            (g_uart_ports[UART_CONSOLE_ID])
 
-static inline void __disable_irq(void) {
-    __asm volatile ("cpsid i" : : : "memory");
-}
 
 /* Inline Function for enabling IRQ */
 static inline void NVIC_EnableIRQ(uint32_t IRQn) {
     NVIC_ISER0[IRQn >> 5] = (1u << (IRQn & 0x1F));
 }
 
+/* Mask interrupts around register updates shared with the ISRs */
+static inline uint32_t uart_irq_save(void) {
+    uint32_t primask = 0u;
+
+    __asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) : : "memory");
+
+    return primask;
+}
+
+static inline void uart_irq_restore(uint32_t primask) {
+    __asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+
 /*!
- * @brief Initialize UART2 peripheral with 9600 baud, 8N1 configuration.
- *
- * Configures GPIO pins PA2 (TX) and PA3 (RX) for UART alternate function,
- * enables peripheral clocks, and sets up UART2 for interrupt-driven operation.
+ * @brief Route one pin to an alternate function.
  *
- * @return 0 on success, -1 if peripheral pointers are NULL.
+ * @param[in] port GPIO port index (0 = GPIOA).
+ * @param[in] pin Pin number 0..15.
+ * @param[in] af Alternate function number.
  */
-int32_t
-uart_init (void)
+static void
+uart_gpio_set_af (uint32_t port, uint32_t pin, uint32_t af)
 {
-    /* Verify peripheral base addresses are valid */
-    if ((NULL == GPIOA) || (NULL == RCC) || (NULL == USART2))
-    {
-        return -1;
-    }
-    
-    /* Enable peripheral clocks */
-    *RCC_APBENR1 |= (1u << RCC_APBENR1_USART2_BIT);
-    *RCC_IOPENR |= (1u << RCC_IOPENR_GPIOA_BIT);
-
-    /* Configure PA2 (TX) and PA3 (RX) as alternate function mode */
-    *GPIOx_MODER &= ~(0x3u << (BITS_PER_PIN * PA2_PIN_NUM));
-    *GPIOx_MODER &= ~(0x3u << (BITS_PER_PIN * PA3_PIN_NUM));
-    *GPIOx_MODER |= (GPIO_MODER_AF_MODE << (BITS_PER_PIN * PA2_PIN_NUM));
-    *GPIOx_MODER |= (GPIO_MODER_AF_MODE << (BITS_PER_PIN * PA3_PIN_NUM));
-
-    /* Set alternate function AF1 for USART2 on PA2 */
-    *GPIOx_AFRL &= ~(0xFu << PA2_AFR_SHIFT);
-    *GPIOx_AFRL |= (GPIO_AFR_AF1 << PA2_AFR_SHIFT);
-
-    /* Set alternate function AF1 for USART2 on PA3 */
-    *GPIOx_AFRL &= ~(0xFu << PA3_AFR_SHIFT);
-    *GPIOx_AFRL |= (GPIO_AFR_AF1 << PA3_AFR_SHIFT);
-
-    /* Configure baud rate for 9600 @ 16MHz system clock */
-    *USART_BRR = BAUD_RATE_9600_AT_16MHZ;
-    
-    /* Enable USART, transmitter, and receiver */
-    *USART_CR1 |= ((1u << USART_CR1_UE_BIT) | 
-                    (1u << USART_CR1_TE_BIT) | 
-                    (1u << USART_CR1_RE_BIT));
-        
-    return 0;
+    volatile uint32_t * p_moder = GPIO_MODER(port);
+    volatile uint32_t * p_afr = GPIO_AFR(port, pin);
+    uint32_t afr_shift = AFR_BITS_PER_PIN * (pin % AFR_PINS_PER_REGISTER);
+
+    *p_moder &= ~(0x3u << (BITS_PER_PIN * pin));
+    *p_moder |= (GPIO_MODER_AF_MODE << (BITS_PER_PIN * pin));
+
+    *p_afr &= ~(0xFu << afr_shift);
+    *p_afr |= (af << afr_shift);
 }
 
 
 /*!
- * @brief Transmit a null-terminated string via UART2.
+ * @brief Count and clear every pending USART receive error.
  *
- * Initiates interrupt-driven transmission. The ISR handles byte-by-byte
- * transmission until the entire string is sent.
+ * One byte can raise several flags at once (framing with noise, say).
+ * ISR is read once, each flag set is counted, and all of them are cleared
+ * with a single ICR write, so none is left to taint the next byte.
  *
- * @param[in] p_str Pointer to null-terminated string to transmit.
+ * @param[in,out] p_port Port whose instance to check.
  *
- * @return 0 on success, -1 if p_str is NULL, -2 if transmitter busy.
+ * @return The most severe error seen (overrun, framing, parity, noise),
+ *         also kept as the port's last error; UART_ERROR_NONE if none.
  */
-int32_t
-uart_transmit_buffer (char const * const p_str)
+static uart_error_t
+uart_clear_errors (uart_port_t * p_port)
 {
-    if (NULL == p_str)
+    uart_regs_t * p_regs = p_port->p_hw->p_regs;
+    uint32_t const pending = p_regs->ISR & USART_ISR_ERROR_MASK;
+    uart_error_t error = UART_ERROR_NONE;
+
+    if (0u == pending)
     {
-        return -1;
+        return UART_ERROR_NONE;
+    }
+
+    p_regs->ICR = pending;
+
+    /* Least severe first, so the last one set is what gets reported */
+    if ((pending & (1u << USART_ISR_NF_BIT)) != 0u)
+    {
+        p_port->error_count[UART_ERROR_NOISE]++;
+        error = UART_ERROR_NOISE;
     }
 
-    /* Critical section: check and update TX state atomically */
-    __disable_irq();
-        
-    if (UART_STATE_IDLE != g_tx_state)
+    if ((pending & (1u << USART_ISR_PE_BIT)) != 0u)
     {
-        __enable_irq();
-        return -2;
+        p_port->error_count[UART_ERROR_PARITY]++;
+        error = UART_ERROR_PARITY;
     }
 
-    g_tx_state = UART_STATE_TX_BUSY;
-    __enable_irq();
+    if ((pending & (1u << USART_ISR_FE_BIT)) != 0u)
+    {
+        p_port->error_count[UART_ERROR_FRAMING]++;
+        error = UART_ERROR_FRAMING;
+    }
 
-    /* Initialize transmission parameters */
-    g_p_tx_buffer = p_str;
-    g_tx_length = (uint32_t)strlen(p_str);
-    g_tx_index = 0u;
-    
-    /* Enable TXE interrupt to start transmission */
-    *USART_CR1 |= (1u << USART_CR1_TXEIE_BIT);
-    
-    return 0;
+    if ((pending & (1u << USART_ISR_ORE_BIT)) != 0u)
+    {
+        p_port->error_count[UART_ERROR_OVERRUN]++;
+        error = UART_ERROR_OVERRUN;
+    }
+
+    p_port->error = error;
+
+    return error;
 }
 
 
 /*!
- * @brief Enable interrupt-driven UART reception.
+ * @brief Mark the line being received as corrupt after a receive error.
+ *
+ * The reader gets everything before position as usual, then drops the
+ * rest of the line up to its terminator (see uart_rx_resync()). Further
+ * errors before the reader gets there belong to the same resync.
  *
- * Prepares the receiver state machine and enables RXNE interrupt.
- * Reception continues until newline or buffer overflow.
+ * @param[in,out] p_port Port that saw the error.
+ * @param[in] position Free-running RX index at which the error was seen.
  *
- * @return 0 on success, -1 if receiver already busy.
+ * @par
+ * NOTE: Must only run in the port's USART interrupt context.
  */
-int32_t
-uart_receive_buffer (void)
+static void
+uart_rx_mark_corrupt (uart_port_t * p_port, uint32_t position)
 {
-    /* Critical section: check and update RX state atomically */
-    __disable_irq();
-        
-    if (UART_STATE_IDLE != g_rx_state)
+    if (p_port->b_resync && (!p_port->b_rx_corrupt))
     {
-        __enable_irq();
-        return -1;
-    }
-    
-    g_rx_state = UART_STATE_RX_BUSY;
-    __enable_irq();
+        p_port->rx_error_at = position;
+        p_port->b_rx_corrupt = TRUE;
 
-    /* Enable RXNE interrupt to start reception */
-    *USART_CR1 |= (1u << USART_CR1_RXNEIE_BIT);
-    
-    return 0;
+        /* Wake the reader so the line is dropped without waiting for more */
+        p_port->events |= UART_EVENT_RX;
+    }
 }
 
 
 /*!
- * @brief USART2 interrupt service routine.
+ * @brief Hold or release a port's transmitter (XOFF / XON).
  *
- * Handles both TX and RX interrupts with error detection.
- * TX: Sends next byte or disables interrupt when complete.
- * RX: Receives bytes until newline or error, with overflow protection.
+ * With TX DMA the USART just stops requesting bytes (DMAT), so a running
+ * transfer stalls in place and carries on where it stopped. The
+ * interrupt-driven transmitter stops taking TXE interrupts instead.
+ *
+ * @param[in,out] p_port Port to pause or resume.
+ * @param[in] b_pause TRUE to hold transmission.
  */
-void
-USART2_IRQHandler (void)
+static void
+uart_tx_pause (uart_port_t * p_port, bool_t b_pause)
 {
-    bool_t b_has_error = FALSE;  /* Changed to bool_t for Keil */
+    uart_regs_t * p_regs = p_port->p_hw->p_regs;
 
-    /* Handle transmit interrupt - TXE flag set */
-    if (((*USART_ISR & (1u << USART_ISR_TXE_BIT)) != 0u) && 
-        (UART_STATE_TX_BUSY == g_tx_state))
+    p_port->b_tx_paused = b_pause;
+
+    if (UART_TX_USES_DMA(p_port->p_hw))
     {
-        if ((NULL != g_p_tx_buffer) && (g_tx_index < g_tx_length))
+        if (b_pause)
         {
-            *USART_TDR = (uint32_t)g_p_tx_buffer[g_tx_index];
-            g_tx_index++;
+            p_regs->CR3 &= ~(1u << USART_CR3_DMAT_BIT);
+        }
+        else if ('\0' == p_port->flow_char)
+        {
+            p_regs->CR3 |= (1u << USART_CR3_DMAT_BIT);
         }
         else
         {
-            /* Transmission complete */
-            *USART_CR1 &= ~(1u << USART_CR1_TXEIE_BIT);
-            g_p_tx_buffer = NULL;
-            g_tx_state = UART_STATE_IDLE;
+            /* Requests resume once the pending XON/XOFF is out */
         }
     }
+    else if (b_pause)
+    {
+        p_regs->CR1 &= ~(1u << USART_CR1_TXEIE_BIT);
+    }
+    else if (UART_STATE_TX_BUSY == p_port->tx_state)
+    {
+        p_regs->CR1 |= (1u << USART_CR1_TXEIE_BIT);
+    }
+    else
+    {
+        /* Nothing queued - the next write starts the transmitter */
+    }
+}
 
-    /* Handle receive interrupt - RXNE flag set */
-    if (((*USART_ISR & (1u << USART_ISR_RXNE_BIT)) != 0u) && 
-        (UART_STATE_RX_BUSY == g_rx_state))
+
+/*!
+ * @brief Act on an out-of-band control byte.
+ *
+ * XON/XOFF take effect right here; cancel and status are left as flags
+ * for the application, which is woken to pick them up even while it is
+ * busy streaming a response.
+ *
+ * @param[in,out] p_port Port that received the byte.
+ * @param[in] c Received byte.
+ *
+ * @return TRUE if c was a control byte.
+ *
+ * @par
+ * NOTE: Must only run in the port's USART/DMA interrupt context.
+ */
+static bool_t
+uart_oob_byte (uart_port_t * p_port, char c)
+{
+    switch (c)
     {
-        /* Check for hardware errors */
-        b_has_error = (((*USART_ISR & (1u << USART_ISR_ORE_BIT)) != 0u) ||
-                       ((*USART_ISR & (1u << USART_ISR_FE_BIT)) != 0u) ||
-                       ((*USART_ISR & (1u << USART_ISR_NF_BIT)) != 0u) ||
-                       ((*USART_ISR & (1u << USART_ISR_PE_BIT)) != 0u));
+        case UART_OOB_CHAR_CANCEL:
+        {
+            /* A paused terminal would never see the abort */
+            uart_tx_pause(p_port, FALSE);
+            p_port->b_cancel = TRUE;
+            p_port->events |= UART_EVENT_RX;
+            break;
+        }
 
-        if (!b_has_error)
+        case UART_OOB_CHAR_XON:
         {
-            g_error = UART_ERROR_NONE;
-            
-            /* Buffer has space for new data plus null terminator */
-            if (g_rx_index < (RX_BUFFER_SIZE_BYTES - 1u))
-            {
-                g_p_rx_buffer[g_rx_index] = (char) *USART_RDR;
-                g_rx_index++;
+            uart_tx_pause(p_port, FALSE);
+            break;
+        }
 
-                /* Check for line ending characters */
-                if ((g_rx_index > 0u) && 
-                    (('\n' == g_p_rx_buffer[g_rx_index - 1u]) || 
-                     ('\r' == g_p_rx_buffer[g_rx_index - 1u])))
-                {
-                    g_p_rx_buffer[g_rx_index] = '\0';
-                    g_rx_state = UART_STATE_IDLE;
-                    *USART_CR1 &= ~(1u << USART_CR1_RXNEIE_BIT);
-                }
-            }
-            else
-            {
-                /* Buffer overflow - disable interrupt */
-                *USART_CR1 &= ~(1u << USART_CR1_RXNEIE_BIT);
-                g_rx_state = UART_STATE_IDLE;
-            }
+        case UART_OOB_CHAR_XOFF:
+        {
+            uart_tx_pause(p_port, TRUE);
+            break;
         }
-        else
+
+        case UART_OOB_CHAR_STATUS:
         {
-            /* Hardware error detected */
-            *USART_CR1 &= ~(1u << USART_CR1_RXNEIE_BIT);
-            g_rx_state = UART_STATE_ERROR;
-            
-            /* Identify and clear specific error */
-            if ((*USART_ISR & (1u << USART_ISR_ORE_BIT)) != 0u)
-            {
-                *USART_ICR |= (1u << USART_ISR_ORE_BIT);
-                g_error = UART_ERROR_OVERRUN;
-            }
-            else if ((*USART_ISR & (1u << USART_ISR_FE_BIT)) != 0u)
-            {
-                *USART_ICR |= (1u << USART_ISR_FE_BIT);
-                g_error = UART_ERROR_FRAMING;
-            }
-            else if ((*USART_ISR & (1u << USART_ISR_PE_BIT)) != 0u)
-            {
-                *USART_ICR |= (1u << USART_ISR_PE_BIT);
-                g_error = UART_ERROR_PARITY;
-            }
-            else if ((*USART_ISR & (1u << USART_ISR_NF_BIT)) != 0u)
-            {
-                *USART_ICR |= (1u << USART_ISR_NF_BIT);
-                g_error = UART_ERROR_NOISE;
-            }
-            else
-            {
-                /* Should never reach here */
-            }
+            p_port->b_status = TRUE;
+            p_port->events |= UART_EVENT_RX;
+            break;
+        }
+
+        default:
+        {
+            return FALSE;
         }
     }
+
+    return TRUE;
 }
 
 
 /*!
- * @brief Reset UART receiver after error condition.
+ * @brief Send XON or XOFF ahead of everything queued in the TX ring.
+ *
+ * The byte goes out from the next TXE interrupt. With TX DMA the USART's
+ * DMA requests are held meanwhile, so the DMA and the CPU never write
+ * TDR for the same slot.
  *
- * Clears error state and re-enables reception. Call this after
- * handling the error reported in g_error.
+ * @param[in,out] p_port Port to send on.
+ * @param[in] c UART_OOB_CHAR_XON or UART_OOB_CHAR_XOFF.
+ *
+ * @par
+ * NOTE: Call from the port's interrupt context or with interrupts masked.
  */
-void
-uart_error_reset (void)
+static void
+uart_flow_send (uart_port_t * p_port, char c)
+{
+    uart_regs_t * p_regs = p_port->p_hw->p_regs;
+
+    p_port->flow_char = c;
+
+    if (UART_TX_USES_DMA(p_port->p_hw))
+    {
+        p_regs->CR3 &= ~(1u << USART_CR3_DMAT_BIT);
+    }
+
+    p_regs->CR1 |= (1u << USART_CR1_TXEIE_BIT);
+}
+
+
+/*!
+ * @brief Hold the sender once the RX ring reaches the high watermark.
+ *
+ * With RTS/CTS the receiver simply stops draining RDR (DMA requests or
+ * RXNE interrupts off); a full RDR deasserts RTS in hardware. With
+ * XON/XOFF an XOFF is sent.
+ *
+ * @param[in,out] p_port Port that just received data.
+ *
+ * @par
+ * NOTE: Must only run in the port's USART/DMA interrupt context.
+ */
+static void
+uart_rx_flow_hold (uart_port_t * p_port)
+{
+    uart_regs_t * p_regs = p_port->p_hw->p_regs;
+
+    if ((UART_FLOW_NONE == p_port->flow) || p_port->b_rx_held ||
+        (ringbuf_count(&p_port->rx_ring) < UART_RX_FLOW_HIGH))
+    {
+        return;
+    }
+
+    p_port->b_rx_held = TRUE;
+    p_port->rx_held++;
+
+    if (UART_FLOW_XON_XOFF == p_port->flow)
+    {
+        uart_flow_send(p_port, UART_OOB_CHAR_XOFF);
+    }
+    else if (UART_RX_USES_DMA(p_port->p_hw))
+    {
+        p_regs->CR3 &= ~(1u << USART_CR3_DMAR_BIT);
+    }
+    else
+    {
+        p_regs->CR1 &= ~(1u << USART_CR1_RXNEIE_BIT);
+    }
+}
+
+
+/*!
+ * @brief Let the sender go again once the RX ring is down to the low mark.
+ *
+ * @param[in,out] p_port Port whose RX ring was just consumed from.
+ */
+static void
+uart_rx_flow_release (uart_port_t * p_port)
+{
+    uart_regs_t * p_regs = p_port->p_hw->p_regs;
+    uint32_t primask = 0u;
+
+    if ((!p_port->b_rx_held) || (ringbuf_count(&p_port->rx_ring) > UART_RX_FLOW_LOW))
+    {
+        return;
+    }
+
+    primask = uart_irq_save();
+
+    p_port->b_rx_held = FALSE;
+
+    if (UART_FLOW_XON_XOFF == p_port->flow)
+    {
+        uart_flow_send(p_port, UART_OOB_CHAR_XON);
+    }
+    else if (UART_RX_USES_DMA(p_port->p_hw))
+    {
+        p_regs->CR3 |= (1u << USART_CR3_DMAR_BIT);
+    }
+    else if (UART_STATE_RX_BUSY == p_port->rx_state)
+    {
+        p_regs->CR1 |= (1u << USART_CR1_RXNEIE_BIT);
+    }
+    else
+    {
+        /* Receiver stopped - uart_port_error_reset() restarts it */
+    }
+
+    uart_irq_restore(primask);
+}
+
+
+/*!
+ * @brief Start the TX DMA on the next contiguous run of the TX ring.
+ *
+ * @param[in,out] p_port Port using a TX DMA channel.
+ *
+ * @par
+ * NOTE: Only called with the DMA channel stopped, either from the TC
+ * interrupt or from uart_port_write() while the transmitter is idle.
+ */
+static void
+uart_tx_dma_start (uart_port_t * p_port)
+{
+    uart_dma_channel_t * p_channel = DMA1_CHANNEL(p_port->p_hw->tx_dma_channel);
+    char const * p_run = NULL;
+
+    p_port->tx_dma_length = ringbuf_peek_contiguous(&p_port->tx_ring, &p_run);
+
+    if (0u == p_port->tx_dma_length)
+    {
+        p_port->tx_state = UART_STATE_IDLE;
+        return;
+    }
+
+    p_port->tx_state = UART_STATE_TX_BUSY;
+
+    /* Program channel while disabled, then start the whole run */
+    p_channel->CCR &= ~(1u << DMA_CCR_EN_BIT);
+    p_channel->CMAR = (uint32_t)(uintptr_t)p_run;
+    p_channel->CNDTR = p_port->tx_dma_length;
+    *DMA1_IFCR = DMA_FLAGS(p_port->p_hw->tx_dma_channel, DMA_FLAG_GIF);
+    p_channel->CCR |= (1u << DMA_CCR_EN_BIT);
+}
+
+
+/*!
+ * @brief Publish bytes written by the RX DMA to the RX ring.
+ *
+ * The ring storage is the DMA target itself, so receiving more data only
+ * means moving the ring head up to the DMA write position. The head never
+ * gets more than a ring ahead of the reader: if the DMA has lapped it, the
+ * overwritten bytes are counted as dropped and the reader skips them (see
+ * uart_rx_resync()), losing the rest of that line. A half/full transfer
+ * flag whose boundary the new bytes do not reach means the DMA went a
+ * whole lap further than its position shows. Out-of-band control bytes
+ * are acted on here but stay in the ring, so consumers skip them like any
+ * other control character.
+ *
+ * @param[in,out] p_port Port using an RX DMA channel.
+ *
+ * @par
+ * NOTE: Must only run in the port's USART/DMA interrupt context (single
+ * producer), or with interrupts masked.
+ */
+static void
+uart_rx_dma_publish (uart_port_t * p_port)
 {
-    if (UART_STATE_ERROR == g_rx_state)
+    uint32_t const channel = p_port->p_hw->rx_dma_channel;
+    uint32_t const start = p_port->rx_dma_pos;
+    uint32_t const to_half = ((UART_RX_RING_SIZE / 2u) - start) & (UART_RX_RING_SIZE - 1u);
+    uint32_t const to_wrap = (0u - start) & (UART_RX_RING_SIZE - 1u);
+    uint32_t flags = 0u;
+    uint32_t dma_pos = 0u;
+    uint32_t fresh = 0u;
+    uint32_t oldest = 0u;
+    uint32_t skip_from = 0u;
+    uint32_t head = 0u;
+    uint32_t index = 0u;
+
+    /* Boundaries passed since the previous publish, then where the DMA is */
+    flags = *DMA1_ISR & DMA_FLAGS(channel, DMA_FLAG_HTIF | DMA_FLAG_TCIF);
+    *DMA1_IFCR = flags;
+    dma_pos = (UART_RX_RING_SIZE - DMA1_CHANNEL(channel)->CNDTR) & (UART_RX_RING_SIZE - 1u);
+    fresh = (dma_pos - start) & (UART_RX_RING_SIZE - 1u);
+
+    /* A boundary right at start may be flagged by the previous publish */
+    if ((((flags & DMA_FLAGS(channel, DMA_FLAG_HTIF)) != 0u) && (0u != to_half) && (to_half > fresh)) ||
+        (((flags & DMA_FLAGS(channel, DMA_FLAG_TCIF)) != 0u) && (0u != to_wrap) && (to_wrap > fresh)))
+    {
+        fresh += UART_RX_RING_SIZE;
+    }
+
+    p_port->rx_dma_pos = start + fresh;
+    oldest = p_port->rx_dma_pos - UART_RX_RING_SIZE;
+
+    if (p_port->b_oob)
+    {
+        for (index = (fresh > UART_RX_RING_SIZE) ? oldest : start; index != p_port->rx_dma_pos; index++)
+        {
+            (void)uart_oob_byte(p_port, p_port->p_rx_storage[index & (UART_RX_RING_SIZE - 1u)]);
+        }
+    }
+
+    /* Unread bytes the DMA has written over (an earlier overrun may not
+       have been skipped yet) */
+    skip_from = p_port->b_rx_overrun ? p_port->rx_overrun_to : p_port->rx_ring.tail;
+
+    if ((int32_t)(oldest - skip_from) > 0)
+    {
+        p_port->rx_dropped += (oldest - skip_from);
+        p_port->rx_overrun_to = oldest;
+        p_port->b_rx_overrun = TRUE;
+    }
+
+    /* Never publish more than the ring holds; after an overrun the rest
+       follows once the reader has skipped the overwritten bytes */
+    head = p_port->rx_ring.tail + UART_RX_RING_SIZE;
+
+    if ((int32_t)(p_port->rx_dma_pos - head) < 0)
+    {
+        head = p_port->rx_dma_pos;
+    }
+
+    if ((head != p_port->rx_ring.head) || (0u != fresh))
     {
-        g_rx_state = UART_STATE_RX_BUSY;
-        g_error = UART_ERROR_NONE;
-        g_rx_index = 0u;
-        *USART_CR1 |= (1u << USART_CR1_RXNEIE_BIT);
+        ringbuf_produce(&p_port->rx_ring, head - p_port->rx_ring.head);
+        p_port->events |= UART_EVENT_RX;
+        uart_rx_flow_hold(p_port);
     }
 }
 
 
+/*!
+ * @brief Apply a pending resync before the reader takes RX bytes.
+ *
+ * Bytes up to the error position belong to earlier lines or to the start
+ * of the corrupt one and are handed out normally. From there the rest of
+ * the corrupt line, its terminator included, is dropped and the line is
+ * reported lost so the reader can throw away the part it already has.
+ * Bytes the RX DMA overwrote are skipped first, and with resync enabled
+ * the line they cut is handled as corrupt from there.
+ *
+ * @param[in,out] p_port Port about to be read from.
+ *
+ * @return Bytes the reader may take now, UINT32_MAX if not limited.
+ */
+static uint32_t
+uart_rx_resync (uart_port_t * p_port)
+{
+    char const * p_data = NULL;
+    uint32_t available = 0u;
+    uint32_t index = 0u;
+    uint32_t primask = 0u;
+
+    if (p_port->b_rx_overrun)
+    {
+        primask = uart_irq_save();
+
+        /* Skip what the RX DMA overwrote; the rest starts mid-line */
+        if ((int32_t)(p_port->rx_overrun_to - p_port->rx_ring.tail) > 0)
+        {
+            ringbuf_consume(&p_port->rx_ring, p_port->rx_overrun_to - p_port->rx_ring.tail);
+        }
+
+        p_port->b_rx_overrun = FALSE;
+
+        if (p_port->b_resync)
+        {
+            p_port->rx_error_at = p_port->rx_ring.tail;
+            p_port->b_rx_corrupt = TRUE;
+        }
+
+        /* Publish what the full ring held back */
+        uart_rx_dma_publish(p_port);
+        uart_irq_restore(primask);
+        uart_rx_flow_release(p_port);
+    }
+
+    if (!p_port->b_rx_corrupt)
+    {
+        return UINT32_MAX;
+    }
+
+    if (!p_port->b_rx_discarding)
+    {
+        /* The reader never passes the error position, so this can't wrap */
+        available = p_port->rx_error_at - p_port->rx_ring.tail;
+
+        if (0u != available)
+        {
+            return available;
+        }
+
+        p_port->b_rx_discarding = TRUE;
+    }
+
+    available = ringbuf_peek_contiguous(&p_port->rx_ring, &p_data);
+
+    while (0u != available)
+    {
+        index = 0u;
+
+        while ((index < available) && ('\r' != p_data[index]) && ('\n' != p_data[index]))
+        {
+            index++;
+        }
+
+        if (index < available)
+        {
+            /* Take a CRLF pair as one terminator if both are here */
+            if (('\r' == p_data[index]) && ((index + 1u) < available) &&
+                ('\n' == p_data[index + 1u]))
+            {
+                index++;
+            }
+
+            ringbuf_consume(&p_port->rx_ring, index + 1u);
+            uart_rx_flow_release(p_port);
+
+            p_port->b_rx_discarding = FALSE;
+            p_port->b_line_lost = TRUE;
+            p_port->rx_lines_lost++;
+            p_port->b_rx_corrupt = FALSE;
+
+            return UINT32_MAX;
+        }
+
+        ringbuf_consume(&p_port->rx_ring, available);
+        uart_rx_flow_release(p_port);
+        available = ringbuf_peek_contiguous(&p_port->rx_ring, &p_data);
+    }
+
+    /* Terminator not received yet */
+    return 0u;
+}
+
+
+/*!
+ * @brief Kernel clock of a USART/LPUART instance.
+ *
+ * @param[in] p_hw Instance description.
+ *
+ * @return HSI16 for the STOP-wakeup LPUART (see uart_port_init()), the
+ *         current system clock for every other instance.
+ */
+static uint32_t
+uart_kernel_hz (uart_hw_t const * p_hw)
+{
+    return UART_WAKES_FROM_STOP(p_hw) ? CLOCK_HSI16_HZ : clock_get_hz();
+}
+
+
+/*!
+ * @brief Compute the baud divisor for a rate at the current kernel clock.
+ *
+ * @param[in] p_hw Instance description.
+ * @param[in] baud Requested line rate.
+ * @param[in] b_oversample8 Use 8x instead of 16x oversampling (USART only).
+ *
+ * @return USARTDIV, or the LPUART BRR value (rounded to nearest), or 0 if
+ *         out of range.
+ */
+static uint32_t
+uart_usartdiv (uart_hw_t const * p_hw, uint32_t baud, bool_t b_oversample8)
+{
+    uint32_t clock_hz = uart_kernel_hz(p_hw);
+    uint32_t usartdiv = 0u;
+
+    if (0u == baud)
+    {
+        return 0u;
+    }
+
+    if (p_hw->b_lpuart)
+    {
+        /* 256 * clock overflows: split into whole and fractional part */
+        if (b_oversample8 || (baud > LPUART_BAUD_MAX) || ((baud * 3u) > clock_hz))
+        {
+            return 0u;
+        }
+
+        usartdiv = ((clock_hz / baud) * 256u) +
+                   ((((clock_hz % baud) * 256u) + (baud / 2u)) / baud);
+
+        return ((usartdiv < LPUART_BRR_MIN) || (usartdiv > LPUART_BRR_MAX)) ? 0u : usartdiv;
+    }
+
+    /* 8x oversampling doubles the divisor (2 * 64 MHz still fits 32 bits) */
+    if (b_oversample8)
+    {
+        usartdiv = ((clock_hz * 2u) + (baud / 2u)) / baud;
+    }
+    else
+    {
+        usartdiv = (clock_hz + (baud / 2u)) / baud;
+    }
+
+    if ((usartdiv < UART_USARTDIV_MIN) || (usartdiv > UART_USARTDIV_MAX))
+    {
+        return 0u;
+    }
+
+    return usartdiv;
+}
+
+
+/*!
+ * @brief Program BRR and the oversampling mode.
+ *
+ * @param[in] p_hw Instance description.
+ * @param[in] usartdiv Divisor from uart_usartdiv().
+ * @param[in] b_oversample8 Use 8x oversampling.
+ *
+ * @par
+ * NOTE: The instance must be disabled (UE = 0).
+ */
+static void
+uart_apply_baud (uart_hw_t const * p_hw, uint32_t usartdiv, bool_t b_oversample8)
+{
+    uart_regs_t * p_regs = p_hw->p_regs;
+
+    if (b_oversample8)
+    {
+        /* BRR[3] must stay 0; the low fraction bits move down by one */
+        p_regs->BRR = (usartdiv & 0xFFF0u) | ((usartdiv & 0xFu) >> 1u);
+        p_regs->CR1 |= (1u << USART_CR1_OVER8_BIT);
+    }
+    else
+    {
+        p_regs->BRR = usartdiv;
+        p_regs->CR1 &= ~(1u << USART_CR1_OVER8_BIT);
+    }
+}
+
+
+/*!
+ * @brief Look up an enabled port.
+ *
+ * @param[in] id UART_ID_* instance.
+ *
+ * @return Port context, or NULL if the instance is not compiled in.
+ */
+uart_port_t *
+uart_port_get (uint32_t id)
+{
+    return (id < UART_ID_COUNT) ? g_uart_ports[id] : NULL;
+}
+
+
+/*!
+ * @brief Initialize a UART port with UART_DEFAULT_BAUD, 8N1 configuration.
+ *
+ * Routes the TX and RX pins to the instance, enables its clocks, and sets
+ * it up for interrupt- or DMA-driven operation as selected for the port.
+ * Reception runs continuously into the port's RX ring from here on.
+ *
+ * @param[in,out] p_port Port to initialize.
+ *
+ * @return 0 on success, -1 if p_port is NULL or the baud rate is not
+ *         reachable.
+ */
+int32_t
+uart_port_init (uart_port_t * p_port)
+{
+    uart_hw_t const * p_hw = NULL;
+    uart_regs_t * p_regs = NULL;
+    uart_dma_channel_t * p_channel = NULL;
+    uint32_t usartdiv = 0u;
+
+    if (NULL == p_port)
+    {
+        return -1;
+    }
+
+    p_hw = p_port->p_hw;
+    p_regs = p_hw->p_regs;
+
+    p_port->baud = UART_DEFAULT_BAUD;
+    p_port->b_oversample8 = FALSE;
+    usartdiv = uart_usartdiv(p_hw, p_port->baud, FALSE);
+
+    if (0u == usartdiv)
+    {
+        return -1;
+    }
+
+    (void)ringbuf_init(&p_port->tx_ring, p_port->p_tx_storage, UART_TX_RING_SIZE);
+    (void)ringbuf_init(&p_port->rx_ring, p_port->p_rx_storage, UART_RX_RING_SIZE);
+    p_port->rx_dma_pos = 0u;
+    p_port->b_rx_overrun = FALSE;
+    p_port->tx_state = UART_STATE_IDLE;
+    p_port->error = UART_ERROR_NONE;
+    p_port->events = 0u;
+    p_port->b_oob = FALSE;
+    p_port->b_tx_paused = FALSE;
+    p_port->b_cancel = FALSE;
+    p_port->b_status = FALSE;
+    p_port->b_rx_held = FALSE;
+    p_port->flow_char = '\0';
+    p_port->flow = ((UART_FLOW_RTS_CTS == UART_FLOW_CONTROL) && (UART_PIN_NONE == p_hw->rts_pin)) ?
+                   (uint8_t)UART_FLOW_NONE : (uint8_t)UART_FLOW_CONTROL;
+    uart_port_reset_stats(p_port);
+
+    /* Enable peripheral clocks */
+    *p_hw->p_clock_enable |= p_hw->clock_enable_mask;
+    *RCC_IOPENR |= (1u << p_hw->gpio_port);
+
+    /* Configure TX and RX pins as alternate function */
+    uart_gpio_set_af(p_hw->gpio_port, p_hw->tx_pin, p_hw->pin_af);
+    uart_gpio_set_af(p_hw->gpio_port, p_hw->rx_pin, p_hw->pin_af);
+
+    if (UART_WAKES_FROM_STOP(p_hw))
+    {
+        /* HSI16 kernel clock: the baud rate no longer depends on SYSCLK, and
+           the LPUART can request HSI16 in STOP to take a byte (WUS, UESM) */
+        *RCC_CCIPR = (*RCC_CCIPR & ~(RCC_CCIPR_LPUART1SEL_MASK << RCC_CCIPR_LPUART1SEL_SHIFT)) |
+                     (RCC_CCIPR_SEL_HSI16 << RCC_CCIPR_LPUART1SEL_SHIFT);
+        p_regs->CR3 = (p_regs->CR3 & ~(0x3u << USART_CR3_WUS_SHIFT)) |
+                      (USART_CR3_WUS_START_BIT << USART_CR3_WUS_SHIFT);
+        p_regs->CR1 |= (1u << USART_CR1_UESM_BIT);
+        *EXTI_IMR1 |= (1u << EXTI_LINE_LPUART1);
+    }
+
+    /* Configure baud rate from the current kernel clock */
+    uart_apply_baud(p_hw, usartdiv, FALSE);
+
+    if (UART_FLOW_RTS_CTS == p_port->flow)
+    {
+        /* RTSE/CTSE can only change while UE = 0 */
+        uart_gpio_set_af(p_hw->gpio_port, p_hw->rts_pin, p_hw->pin_af);
+        uart_gpio_set_af(p_hw->gpio_port, p_hw->cts_pin, p_hw->pin_af);
+        p_regs->CR3 |= ((1u << USART_CR3_RTSE_BIT) | (1u << USART_CR3_CTSE_BIT));
+    }
+
+    /* Enable USART, transmitter, and receiver */
+    p_regs->CR1 |= ((1u << USART_CR1_UE_BIT) |
+                    (1u << USART_CR1_TE_BIT) |
+                    (1u << USART_CR1_RE_BIT));
+
+    if (UART_TX_USES_DMA(p_hw))
+    {
+        /* Route TX requests to the port's DMA channel (memory -> TDR, 8-bit) */
+        p_channel = DMA1_CHANNEL(p_hw->tx_dma_channel);
+        *RCC_AHBENR |= (1u << RCC_AHBENR_DMA1_BIT);
+        *DMAMUX_CCR(p_hw->tx_dma_channel) = p_hw->tx_dma_request;
+        p_channel->CCR = 0u;
+        p_channel->CPAR = (uint32_t)(uintptr_t)&p_regs->TDR;
+        p_channel->CCR = ((1u << DMA_CCR_MINC_BIT) |
+                          (1u << DMA_CCR_DIR_BIT) |
+                          (1u << DMA_CCR_TCIE_BIT));
+        p_regs->CR3 |= (1u << USART_CR3_DMAT_BIT);
+    }
+
+    if (UART_RX_USES_DMA(p_hw))
+    {
+        /* Free-running circular RDR -> RX ring, published on IDLE/HT/TC */
+        p_channel = DMA1_CHANNEL(p_hw->rx_dma_channel);
+        *RCC_AHBENR |= (1u << RCC_AHBENR_DMA1_BIT);
+        *DMAMUX_CCR(p_hw->rx_dma_channel) = p_hw->rx_dma_request;
+        p_channel->CCR = 0u;
+        p_channel->CPAR = (uint32_t)(uintptr_t)&p_regs->RDR;
+        p_channel->CMAR = (uint32_t)(uintptr_t)p_port->p_rx_storage;
+        p_channel->CNDTR = UART_RX_RING_SIZE;
+        p_channel->CCR = ((1u << DMA_CCR_MINC_BIT) |
+                          (1u << DMA_CCR_CIRC_BIT) |
+                          (1u << DMA_CCR_HTIE_BIT) |
+                          (1u << DMA_CCR_TCIE_BIT));
+        p_channel->CCR |= (1u << DMA_CCR_EN_BIT);
+
+        p_regs->CR3 |= ((1u << USART_CR3_DMAR_BIT) | (1u << USART_CR3_EIE_BIT));
+        p_regs->CR1 |= (1u << USART_CR1_IDLEIE_BIT);
+    }
+    else
+    {
+        /* Receive continuously into the RX ring */
+        p_regs->CR1 |= (1u << USART_CR1_RXNEIE_BIT);
+    }
+
+    if (UART_TX_USES_DMA(p_hw) || UART_RX_USES_DMA(p_hw))
+    {
+        NVIC_EnableIRQ(p_hw->dma_irq);
+    }
+
+    /* The tx/rx DMA channels of one port always share one DMA vector */
+    p_port->rx_state = UART_STATE_RX_BUSY;
+    NVIC_EnableIRQ(p_hw->irq);
+
+    return 0;
+}
+
+
+/*!
+ * @brief Make sure the port's transmit engine is draining its TX ring.
+ *
+ * @param[in,out] p_port Port with queued output.
+ */
+static void
+uart_tx_kick (uart_port_t * p_port)
+{
+    if (UART_TX_USES_DMA(p_port->p_hw))
+    {
+        /* A running transfer chains the new bytes from its TC interrupt */
+        if (UART_STATE_IDLE == p_port->tx_state)
+        {
+            uart_tx_dma_start(p_port);
+        }
+    }
+    else
+    {
+        /* Enable TXE interrupt to start (or keep) draining the ring */
+        p_port->tx_state = UART_STATE_TX_BUSY;
+
+        if (!p_port->b_tx_paused)
+        {
+            p_port->p_hw->p_regs->CR1 |= (1u << USART_CR1_TXEIE_BIT);
+        }
+    }
+}
+
+
+/*!
+ * @brief Queue bytes for transmission on a port.
+ *
+ * Copies as much of p_data as fits into the TX ring and makes sure the
+ * transmit engine is draining it. Never blocks.
+ *
+ * @param[in,out] p_port Port to transmit on.
+ * @param[in] p_data Bytes to transmit.
+ * @param[in] len Number of bytes offered.
+ *
+ * @return Number of bytes queued (less than len if the TX ring is full).
+ */
+uint32_t
+uart_port_write (uart_port_t * p_port, char const * p_data, uint32_t len)
+{
+    uint32_t queued = 0u;
+
+    if ((NULL == p_data) || (0u == len))
+    {
+        return 0u;
+    }
+
+    queued = ringbuf_write(&p_port->tx_ring, p_data, len);
+    uart_tx_kick(p_port);
+
+    return queued;
+}
+
+
+/*!
+ * @brief Reserve space in a port's TX ring to format output in place.
+ *
+ * Avoids an intermediate buffer: the caller writes up to len bytes at the
+ * returned pointer and then calls uart_port_tx_commit() with the real length.
+ *
+ * @param[in,out] p_port Port to transmit on.
+ * @param[in] len Bytes wanted, at most UART_TX_RESERVE_MAX.
+ *
+ * @return Pointer into the TX ring, or NULL if len bytes are not free yet.
+ */
+char *
+uart_port_tx_reserve (uart_port_t * p_port, uint32_t len)
+{
+    if ((0u == len) || (len > UART_TX_RESERVE_MAX))
+    {
+        return NULL;
+    }
+
+    return ringbuf_reserve(&p_port->tx_ring, len);
+}
+
+
+/*!
+ * @brief Queue bytes written into a uart_port_tx_reserve() reservation.
+ *
+ * @param[in,out] p_port Port the reservation came from.
+ * @param[in] len Bytes actually written (0 abandons the reservation).
+ */
+void
+uart_port_tx_commit (uart_port_t * p_port, uint32_t len)
+{
+    if (0u == len)
+    {
+        return;
+    }
+
+    ringbuf_commit(&p_port->tx_ring, len);
+    uart_tx_kick(p_port);
+}
+
+
+/*!
+ * @brief Take received bytes out of a port's RX ring.
+ *
+ * @param[in,out] p_port Port to read from.
+ * @param[out] p_data Destination buffer.
+ * @param[in] len Destination capacity.
+ *
+ * @return Number of bytes copied (0 if nothing has been received).
+ */
+uint32_t
+uart_port_read (uart_port_t * p_port, char * p_data, uint32_t len)
+{
+    uint32_t limit = 0u;
+
+    if ((NULL == p_data) || (0u == len))
+    {
+        return 0u;
+    }
+
+    limit = uart_rx_resync(p_port);
+    len = ringbuf_read(&p_port->rx_ring, p_data, (len < limit) ? len : limit);
+    uart_rx_flow_release(p_port);
+
+    return len;
+}
+
+
+/*!
+ * @brief Look at received bytes without taking them out of the RX ring.
+ *
+ * Lets a parser decide how much input belongs to it before consuming.
+ *
+ * @param[in] p_port Port to read from.
+ * @param[out] pp_data Set to the oldest received byte.
+ *
+ * @return Number of contiguous bytes available at *pp_data.
+ */
+uint32_t
+uart_port_rx_peek (uart_port_t * p_port, char const ** pp_data)
+{
+    uint32_t const limit = uart_rx_resync(p_port);
+    uint32_t available = ringbuf_peek_contiguous(&p_port->rx_ring, pp_data);
+
+    return (available < limit) ? available : limit;
+}
+
+
+/*!
+ * @brief Release bytes obtained with uart_port_rx_peek().
+ *
+ * @param[in,out] p_port Port to read from.
+ * @param[in] len Number of bytes to release.
+ */
+void
+uart_port_rx_consume (uart_port_t * p_port, uint32_t len)
+{
+    ringbuf_consume(&p_port->rx_ring, len);
+    uart_rx_flow_release(p_port);
+}
+
+
+/*!
+ * @brief Check whether all queued TX data has been handed to the hardware.
+ *
+ * @param[in] p_port Port to check.
+ *
+ * @return TRUE if the TX ring is empty and the transmit engine is idle.
+ */
+bool_t
+uart_port_tx_idle (uart_port_t * p_port)
+{
+    return ((0u == ringbuf_count(&p_port->tx_ring)) &&
+            (UART_STATE_IDLE == p_port->tx_state));
+}
+
+
+/*!
+ * @brief Free space in a port's TX ring.
+ *
+ * @param[in] p_port Port to check.
+ *
+ * @return Number of bytes uart_port_write() would accept right now.
+ */
+uint32_t
+uart_port_tx_space (uart_port_t * p_port)
+{
+    return ringbuf_space(&p_port->tx_ring);
+}
+
+
+/*!
+ * @brief Line rate a baud setting would actually produce on a port.
+ *
+ * Lets a caller validate a request and report the rounding error before
+ * committing to it with uart_port_set_baud().
+ *
+ * @param[in] p_port Port to check.
+ * @param[in] baud Requested line rate.
+ * @param[in] b_oversample8 Use 8x oversampling (USART only, up to clock / 8).
+ *
+ * @return Resulting baud rate, or 0 if not reachable at the current clock.
+ */
+uint32_t
+uart_port_baud_actual (uart_port_t * p_port, uint32_t baud, bool_t b_oversample8)
+{
+    uint32_t usartdiv = uart_usartdiv(p_port->p_hw, baud, b_oversample8);
+    uint32_t clock_hz = uart_kernel_hz(p_port->p_hw);
+
+    if (0u == usartdiv)
+    {
+        return 0u;
+    }
+
+    if (p_port->p_hw->b_lpuart)
+    {
+        return ((clock_hz / usartdiv) * 256u) + (((clock_hz % usartdiv) * 256u) / usartdiv);
+    }
+
+    return b_oversample8 ? ((clock_hz * 2u) / usartdiv) : (clock_hz / usartdiv);
+}
+
+
+/*!
+ * @brief Change a port's line rate once its queued output has left the wire.
+ *
+ * Fails rather than waits while the TX ring or DMA still hold data, so the
+ * caller can retry after the next UART_EVENT_TX_DRAINED. Once the engine
+ * is idle only the last character is still shifting out; waiting for TC
+ * costs at most one character time. Reception restarts at the new rate;
+ * the RX DMA keeps running throughout.
+ *
+ * @param[in,out] p_port Port to reconfigure.
+ * @param[in] baud New line rate.
+ * @param[in] b_oversample8 Use 8x oversampling.
+ *
+ * @return 0 on success, -1 if the rate is not reachable, -2 if TX is busy.
+ */
+int32_t
+uart_port_set_baud (uart_port_t * p_port, uint32_t baud, bool_t b_oversample8)
+{
+    uart_regs_t * p_regs = p_port->p_hw->p_regs;
+    uint32_t usartdiv = uart_usartdiv(p_port->p_hw, baud, b_oversample8);
+
+    if (0u == usartdiv)
+    {
+        return -1;
+    }
+
+    if (!uart_port_tx_idle(p_port))
+    {
+        return -2;
+    }
+
+    while ((p_regs->ISR & (1u << USART_ISR_TC_BIT)) == 0u)
+    {
+        /* Last character still on the wire */
+    }
+
+    p_regs->CR1 &= ~(1u << USART_CR1_UE_BIT);
+    uart_apply_baud(p_port->p_hw, usartdiv, b_oversample8);
+    p_regs->CR1 |= (1u << USART_CR1_UE_BIT);
+
+    p_port->baud = baud;
+    p_port->b_oversample8 = b_oversample8;
+
+    return 0;
+}
+
+
+/*!
+ * @brief Currently configured line rate of a port.
+ *
+ * @param[in] p_port Port to check.
+ * @param[out] p_b_oversample8 Set to the oversampling mode (may be NULL).
+ *
+ * @return Requested baud rate last applied.
+ */
+uint32_t
+uart_port_get_baud (uart_port_t * p_port, bool_t * p_b_oversample8)
+{
+    if (NULL != p_b_oversample8)
+    {
+        *p_b_oversample8 = p_port->b_oversample8;
+    }
+
+    return p_port->baud;
+}
+
+
+/*!
+ * @brief Fetch and clear the events posted by a port's interrupts.
+ *
+ * @param[in,out] p_port Port to check.
+ *
+ * @par
+ * NOTE: Call with interrupts disabled, so that checking for events and
+ * going to sleep on WFI cannot miss an event posted in between.
+ *
+ * @return UART_EVENT_* bits posted since the previous call.
+ */
+uint32_t
+uart_port_take_events (uart_port_t * p_port)
+{
+    uint32_t events = p_port->events;
+
+    p_port->events = 0u;
+
+    return events;
+}
+
+
+/*!
+ * @brief Reset a port's receiver after an error condition.
+ *
+ * Receive errors no longer stop the receiver (see uart_port_set_resync());
+ * this clears the last error and restarts a receiver left in
+ * UART_STATE_ERROR.
+ *
+ * @param[in,out] p_port Port to recover.
+ */
+void
+uart_port_error_reset (uart_port_t * p_port)
+{
+    if (UART_STATE_ERROR == p_port->rx_state)
+    {
+        p_port->rx_state = UART_STATE_RX_BUSY;
+        p_port->error = UART_ERROR_NONE;
+
+        if ((!UART_RX_USES_DMA(p_port->p_hw)) && (!p_port->b_rx_held))
+        {
+            p_port->p_hw->p_regs->CR1 |= (1u << USART_CR1_RXNEIE_BIT);
+        }
+    }
+}
+
+
+/*!
+ * @brief Read a port's receive error counters.
+ *
+ * @param[in] p_port Port to check.
+ * @param[out] p_stats Counters since init or the last reset.
+ */
+void
+uart_port_get_stats (uart_port_t * p_port, uart_stats_t * p_stats)
+{
+    p_stats->overrun = p_port->error_count[UART_ERROR_OVERRUN];
+    p_stats->framing = p_port->error_count[UART_ERROR_FRAMING];
+    p_stats->parity = p_port->error_count[UART_ERROR_PARITY];
+    p_stats->noise = p_port->error_count[UART_ERROR_NOISE];
+    p_stats->rx_dropped = p_port->rx_dropped;
+    p_stats->rx_held = p_port->rx_held;
+    p_stats->rx_lines_lost = p_port->rx_lines_lost;
+}
+
+
+/*!
+ * @brief Clear a port's receive error counters.
+ *
+ * @param[in,out] p_port Port to reset.
+ */
+void
+uart_port_reset_stats (uart_port_t * p_port)
+{
+    uint32_t index = 0u;
+
+    for (index = 0u; index <= (uint32_t)UART_ERROR_NOISE; index++)
+    {
+        p_port->error_count[index] = 0u;
+    }
+
+    p_port->rx_dropped = 0u;
+    p_port->rx_held = 0u;
+    p_port->rx_lines_lost = 0u;
+}
+
+
+/*!
+ * @brief Enable or disable out-of-band control bytes on a port.
+ *
+ * While enabled the RX interrupt acts on Ctrl-C, XON/XOFF and Ctrl-T as
+ * they arrive (see UART_OOB_CHAR_*). Keep it off for binary payloads, in
+ * which those values are ordinary data. Disabling releases a held TX.
+ *
+ * @param[in,out] p_port Port to configure.
+ * @param[in] b_enable TRUE to act on control bytes.
+ */
+void
+uart_port_set_oob (uart_port_t * p_port, bool_t b_enable)
+{
+    p_port->b_oob = b_enable;
+
+    if (!b_enable)
+    {
+        uart_tx_pause(p_port, FALSE);
+        p_port->b_cancel = FALSE;
+        p_port->b_status = FALSE;
+    }
+}
+
+
+/*!
+ * @brief Enable or disable dropping of lines hit by a receive error.
+ *
+ * While enabled a framing, noise, parity or overrun error discards the
+ * rest of the line it hit, up to the next CR or LF, and reports the line
+ * through uart_port_take_line_lost(). Keep it off for framed binary
+ * payloads, which carry their own checks; errors are counted either way
+ * and reception never stops.
+ *
+ * @param[in,out] p_port Port to configure.
+ * @param[in] b_enable TRUE to drop corrupt lines.
+ */
+void
+uart_port_set_resync (uart_port_t * p_port, bool_t b_enable)
+{
+    p_port->b_resync = b_enable;
+
+    if (!b_enable)
+    {
+        /* Binary input from here on: no line to resync on */
+        p_port->b_rx_corrupt = FALSE;
+        p_port->b_rx_discarding = FALSE;
+        p_port->b_line_lost = FALSE;
+    }
+}
+
+
+/*!
+ * @brief Check whether a corrupt line was dropped since the previous call.
+ *
+ * The part of the line read before the error was already handed out; the
+ * caller should throw that away as well.
+ *
+ * @param[in,out] p_port Port to check.
+ *
+ * @return TRUE once per dropped line (repeated drops count once).
+ */
+bool_t
+uart_port_take_line_lost (uart_port_t * p_port)
+{
+    bool_t const b_lost = p_port->b_line_lost;
+
+    p_port->b_line_lost = FALSE;
+
+    return b_lost;
+}
+
+
+/*!
+ * @brief Fetch and clear the cancel and status requests of a port.
+ *
+ * Repeated requests before the next call count once.
+ *
+ * @param[in,out] p_port Port to check.
+ *
+ * @return UART_OOB_* bits received since the previous call.
+ */
+uint32_t
+uart_port_take_oob (uart_port_t * p_port)
+{
+    uint32_t requests = 0u;
+
+    if (p_port->b_cancel)
+    {
+        p_port->b_cancel = FALSE;
+        requests |= UART_OOB_CANCEL;
+    }
+
+    if (p_port->b_status)
+    {
+        p_port->b_status = FALSE;
+        requests |= UART_OOB_STATUS;
+    }
+
+    return requests;
+}
+
+
+/*!
+ * @brief Check whether a port's transmitter is held by XOFF.
+ *
+ * @param[in] p_port Port to check.
+ *
+ * @return TRUE between XOFF and the next XON (or Ctrl-C).
+ */
+bool_t
+uart_port_tx_paused (uart_port_t * p_port)
+{
+    return p_port->b_tx_paused;
+}
+
+
+/*!
+ * @brief Check that a port can sleep through STOP and arm its wakeup.
+ *
+ * STOP halts the DMA and every kernel clock but the LPUART's HSI16, so
+ * the port must have nothing in flight: TX ring empty and the last stop
+ * bit sent, no byte being received and none left in the RX ring or the
+ * DMA buffer. The wakeup flag is cleared before the checks, so a start
+ * bit arriving after them sets it again and wakes STOP straight away.
+ *
+ * @param[in,out] p_port Port to check.
+ *
+ * @return TRUE if the port may enter STOP now (wakeup interrupt armed),
+ *         FALSE if it is busy or cannot wake the core from STOP.
+ *
+ * @par
+ * NOTE: Call with interrupts masked, immediately before entering STOP.
+ */
+bool_t
+uart_port_arm_wakeup (uart_port_t * p_port)
+{
+    uart_hw_t const * p_hw = p_port->p_hw;
+    uart_regs_t * p_regs = p_hw->p_regs;
+    uint32_t dma_pos = 0u;
+
+    if (!UART_WAKES_FROM_STOP(p_hw))
+    {
+        return FALSE;
+    }
+
+    p_regs->ICR = (1u << USART_ISR_WUF_BIT);
+
+    if ((!uart_port_tx_idle(p_port)) || ('\0' != p_port->flow_char) ||
+        ((p_regs->ISR & (1u << USART_ISR_TC_BIT)) == 0u) ||
+        ((p_regs->ISR & (1u << USART_ISR_BUSY_BIT)) != 0u) ||
+        (0u != ringbuf_count(&p_port->rx_ring)))
+    {
+        return FALSE;
+    }
+
+    if (UART_RX_USES_DMA(p_hw))
+    {
+        /* Bytes the DMA wrote but IDLE has not published yet */
+        dma_pos = (UART_RX_RING_SIZE - DMA1_CHANNEL(p_hw->rx_dma_channel)->CNDTR) &
+                  (UART_RX_RING_SIZE - 1u);
+
+        if (dma_pos != (p_port->rx_dma_pos & (UART_RX_RING_SIZE - 1u)))
+        {
+            return FALSE;
+        }
+    }
+
+    p_regs->CR3 |= (1u << USART_CR3_WUFIE_BIT);
+
+    return TRUE;
+}
+
+
+/*!
+ * @brief USART/LPUART interrupt service, shared by all ports.
+ *
+ * Handles both TX and RX interrupts with error detection.
+ * TX: Sends next queued byte or disables interrupt when the ring is empty
+ *     (ports without TX DMA only).
+ * RX: Queues received bytes into the RX ring, with error detection. With
+ *     RX DMA, publishes the DMA progress when the line goes idle.
+ *
+ * @param[in,out] p_port Port whose instance raised the interrupt.
+ */
+static void
+uart_port_service (uart_port_t * p_port)
+{
+    uart_hw_t const * p_hw = p_port->p_hw;
+    uart_regs_t * p_regs = p_hw->p_regs;
+    uart_error_t error = UART_ERROR_NONE;
+    char c = '\0';
+
+    /* Start bit woke the core from STOP; the byte itself follows as usual */
+    if (((p_regs->ISR & (1u << USART_ISR_WUF_BIT)) != 0u) &&
+        ((p_regs->CR3 & (1u << USART_CR3_WUFIE_BIT)) != 0u))
+    {
+        p_regs->ICR = (1u << USART_ISR_WUF_BIT);
+        p_regs->CR3 &= ~(1u << USART_CR3_WUFIE_BIT);
+    }
+
+    /* Handle transmit interrupt - TXE flag set */
+    if (((p_regs->ISR & (1u << USART_ISR_TXE_BIT)) != 0u) &&
+        ((p_regs->CR1 & (1u << USART_CR1_TXEIE_BIT)) != 0u))
+    {
+        if ('\0' != p_port->flow_char)
+        {
+            /* XON/XOFF jump the queue (and an XOFF received from the host) */
+            p_regs->TDR = (uint32_t)(uint8_t)p_port->flow_char;
+            p_port->flow_char = '\0';
+
+            if (UART_TX_USES_DMA(p_hw))
+            {
+                /* Hand TDR back to the DMA */
+                p_regs->CR1 &= ~(1u << USART_CR1_TXEIE_BIT);
+
+                if (!p_port->b_tx_paused)
+                {
+                    p_regs->CR3 |= (1u << USART_CR3_DMAT_BIT);
+                }
+            }
+        }
+        else if (UART_TX_USES_DMA(p_hw))
+        {
+            /* DMA drives TX: TXE only ever serves XON/XOFF */
+            p_regs->CR1 &= ~(1u << USART_CR1_TXEIE_BIT);
+        }
+        else if (p_port->b_tx_paused)
+        {
+            /* XOFF raced with uart_tx_kick() - hold until XON */
+            p_regs->CR1 &= ~(1u << USART_CR1_TXEIE_BIT);
+        }
+        else if (ringbuf_get(&p_port->tx_ring, &c))
+        {
+            p_regs->TDR = (uint32_t)(uint8_t)c;
+
+            /* Wake the producer once, when half of the ring is free again */
+            if (ringbuf_count(&p_port->tx_ring) == (UART_TX_RING_SIZE / 2u))
+            {
+                p_port->events |= UART_EVENT_TX_DRAINED;
+            }
+        }
+        else
+        {
+            /* Transmission complete */
+            p_regs->CR1 &= ~(1u << USART_CR1_TXEIE_BIT);
+            p_port->tx_state = UART_STATE_IDLE;
+            p_port->events |= UART_EVENT_TX_DRAINED;
+        }
+    }
+
+    if (UART_RX_USES_DMA(p_hw))
+    {
+        /* DMA keeps receiving through errors - record and clear them */
+        error = uart_clear_errors(p_port);
+
+        /* Line went idle - publish everything received so far */
+        if ((p_regs->ISR & (1u << USART_ISR_IDLE_BIT)) != 0u)
+        {
+            p_regs->ICR = (1u << USART_ISR_IDLE_BIT);
+        }
+
+        uart_rx_dma_publish(p_port);
+
+        /* The bad byte is the last one received, or the next to arrive */
+        if (UART_ERROR_NONE != error)
+        {
+            uart_rx_mark_corrupt(p_port, p_port->rx_dma_pos);
+        }
+    }
+    else if (((p_regs->ISR & (1u << USART_ISR_RXNE_BIT)) != 0u) &&
+             ((p_regs->CR1 & (1u << USART_CR1_RXNEIE_BIT)) != 0u) &&
+             (UART_STATE_RX_BUSY == p_port->rx_state))
+    {
+        /* Count and clear hardware errors, all flags at once */
+        error = uart_clear_errors(p_port);
+
+        if (UART_ERROR_NONE == error)
+        {
+            p_port->error = UART_ERROR_NONE;
+            c = (char)p_regs->RDR;
+
+            if (p_port->b_oob && uart_oob_byte(p_port, c))
+            {
+                /* Control byte handled here, never queued */
+            }
+            else if (!ringbuf_put(&p_port->rx_ring, c))
+            {
+                /* Ring full - application is not keeping up */
+                p_port->rx_dropped++;
+            }
+
+            uart_rx_flow_hold(p_port);
+
+            /* Wake the application per byte: line editing echoes every key
+               and JSON/COBS delimiters can end a request mid-line */
+            p_port->events |= UART_EVENT_RX;
+        }
+        else
+        {
+            /* Drop the byte and keep receiving */
+            (void)p_regs->RDR;
+            uart_rx_mark_corrupt(p_port, p_port->rx_ring.head);
+        }
+    }
+    else
+    {
+        /* Not a receive interrupt */
+    }
+}
+
+
+/*!
+ * @brief DMA channel interrupt service for every port using the channels.
+ *
+ * TX channels raise TC once per ring run: the run is released and the next
+ * one chained. RX channels raise half/full ring events; publishing here as
+ * well as on IDLE keeps data flowing during long back-to-back input.
+ *
+ * @param[in] first_channel First DMA1 channel of the vector.
+ * @param[in] last_channel Last DMA1 channel of the vector.
+ */
+static void
+uart_dma_service (uint32_t first_channel, uint32_t last_channel)
+{
+    uart_port_t * p_port = NULL;
+    uart_hw_t const * p_hw = NULL;
+    uint32_t id = 0u;
+    uint32_t channel = 0u;
+
+    for (id = 0u; id < UART_ID_COUNT; id++)
+    {
+        p_port = g_uart_ports[id];
+
+        if (NULL == p_port)
+        {
+            continue;
+        }
+
+        p_hw = p_port->p_hw;
+        channel = p_hw->tx_dma_channel;
+
+        if (UART_TX_USES_DMA(p_hw) &&
+            (channel >= first_channel) && (channel <= last_channel) &&
+            ((*DMA1_ISR & DMA_FLAGS(channel, DMA_FLAG_TCIF)) != 0u))
+        {
+            *DMA1_IFCR = DMA_FLAGS(channel, DMA_FLAG_GIF);
+            DMA1_CHANNEL(channel)->CCR &= ~(1u << DMA_CCR_EN_BIT);
+
+            ringbuf_consume(&p_port->tx_ring, p_port->tx_dma_length);
+            p_port->events |= UART_EVENT_TX_DRAINED;
+            uart_tx_dma_start(p_port);
+        }
+
+        channel = p_hw->rx_dma_channel;
+
+        if (UART_RX_USES_DMA(p_hw) &&
+            (channel >= first_channel) && (channel <= last_channel) &&
+            ((*DMA1_ISR & DMA_FLAGS(channel, DMA_FLAG_GIF)) != 0u))
+        {
+            /* Publish first: it needs the half/full flags to spot a lap */
+            uart_rx_dma_publish(p_port);
+            *DMA1_IFCR = DMA_FLAGS(channel, DMA_FLAG_GIF);
+        }
+    }
+}
+
+
+/*!
+ * @brief USART1 interrupt service routine (thunk).
+ */
+void
+USART1_IRQHandler (void)
+{
+    uint32_t start = 0u;
+
+    PROF_BEGIN(start);
+#if (UART_ENABLE_USART1 != 0u)
+    uart_port_service(&g_usart1_port);
+#endif
+    PROF_END(PROF_SLOT_UART_ISR, start);
+}
+
+
+/*!
+ * @brief USART2 interrupt service routine (thunk).
+ */
+void
+USART2_IRQHandler (void)
+{
+    uint32_t start = 0u;
+
+    PROF_BEGIN(start);
+#if (UART_ENABLE_USART2 != 0u)
+    uart_port_service(&g_usart2_port);
+#endif
+    PROF_END(PROF_SLOT_UART_ISR, start);
+}
+
+
+/*!
+ * @brief USART3/USART4/LPUART1 shared interrupt service routine (thunk).
+ */
+void
+USART3_4_LPUART1_IRQHandler (void)
+{
+    uint32_t start = 0u;
+
+    PROF_BEGIN(start);
+#if (UART_ENABLE_USART3 != 0u)
+    uart_port_service(&g_usart3_port);
+#endif
+#if (UART_ENABLE_USART4 != 0u)
+    uart_port_service(&g_usart4_port);
+#endif
+#if (UART_ENABLE_LPUART1 != 0u)
+    uart_port_service(&g_lpuart1_port);
+#endif
+    PROF_END(PROF_SLOT_UART_ISR, start);
+}
+
+
+/*!
+ * @brief DMA1 channel 1 interrupt service routine (thunk).
+ */
+void
+DMA1_Channel1_IRQHandler (void)
+{
+    uint32_t start = 0u;
+
+    PROF_BEGIN(start);
+    uart_dma_service(1u, 1u);
+    PROF_END(PROF_SLOT_DMA_ISR, start);
+}
+
+
+/*!
+ * @brief DMA1 channel 2/3 interrupt service routine (thunk).
+ */
+void
+DMA1_Channel2_3_IRQHandler (void)
+{
+    uint32_t start = 0u;
+
+    PROF_BEGIN(start);
+    uart_dma_service(2u, 3u);
+    PROF_END(PROF_SLOT_DMA_ISR, start);
+}
+
+
+/*!
+ * @brief DMA1 channel 4..7 interrupt service routine (thunk).
+ */
+void
+DMA1_Channel4_5_6_7_IRQHandler (void)
+{
+    uint32_t start = 0u;
+
+    PROF_BEGIN(start);
+    uart_dma_service(4u, 7u);
+    PROF_END(PROF_SLOT_DMA_ISR, start);
+}
+
+
+/*!
+ * @brief Initialize the console port (UART_CONSOLE_ID).
+ *
+ * @return 0 on success, -1 if the console port is not enabled.
+ */
+int32_t
+uart_init (void)
+{
+    return uart_port_init(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Queue bytes for transmission on the console port.
+ *
+ * @param[in] p_data Bytes to transmit.
+ * @param[in] len Number of bytes offered.
+ *
+ * @return Number of bytes queued (less than len if the TX ring is full).
+ */
+uint32_t
+uart_write (char const * p_data, uint32_t len)
+{
+    return uart_port_write(UART_CONSOLE, p_data, len);
+}
+
+
+/*!
+ * @brief Reserve space in the console TX ring to format output in place.
+ *
+ * @param[in] len Bytes wanted, at most UART_TX_RESERVE_MAX.
+ *
+ * @return Pointer into the TX ring, or NULL if len bytes are not free yet.
+ */
+char *
+uart_tx_reserve (uint32_t len)
+{
+    return uart_port_tx_reserve(UART_CONSOLE, len);
+}
+
+
+/*!
+ * @brief Queue bytes written into a uart_tx_reserve() reservation.
+ *
+ * @param[in] len Bytes actually written (0 abandons the reservation).
+ */
+void
+uart_tx_commit (uint32_t len)
+{
+    uart_port_tx_commit(UART_CONSOLE, len);
+}
+
+
+/*!
+ * @brief Queue a null-terminated string for transmission on the console.
+ *
+ * The string is copied into the TX ring, so it does not need to outlive
+ * the call. Either the whole string is queued or nothing is.
+ *
+ * @param[in] p_str Pointer to null-terminated string to transmit.
+ *
+ * @return 0 on success, -1 if p_str is NULL, -2 if the TX ring lacks space.
+ */
+int32_t
+uart_transmit_buffer (char const * const p_str)
+{
+    uint32_t length = 0u;
+
+    if (NULL == p_str)
+    {
+        return -1;
+    }
+
+    length = (uint32_t)strlen(p_str);
+
+    if (length > uart_port_tx_space(UART_CONSOLE))
+    {
+        return -2;
+    }
+
+    (void)uart_port_write(UART_CONSOLE, p_str, length);
+
+    return 0;
+}
+
+
+/*!
+ * @brief Take received bytes out of the console RX ring.
+ *
+ * @param[out] p_data Destination buffer.
+ * @param[in] len Destination capacity.
+ *
+ * @return Number of bytes copied (0 if nothing has been received).
+ */
+uint32_t
+uart_read (char * p_data, uint32_t len)
+{
+    return uart_port_read(UART_CONSOLE, p_data, len);
+}
+
+
+/*!
+ * @brief Look at received console bytes without consuming them.
+ *
+ * @param[out] pp_data Set to the oldest received byte.
+ *
+ * @return Number of contiguous bytes available at *pp_data.
+ */
+uint32_t
+uart_rx_peek (char const ** pp_data)
+{
+    return uart_port_rx_peek(UART_CONSOLE, pp_data);
+}
+
+
+/*!
+ * @brief Release bytes obtained with uart_rx_peek().
+ *
+ * @param[in] len Number of bytes to release.
+ */
+void
+uart_rx_consume (uint32_t len)
+{
+    uart_port_rx_consume(UART_CONSOLE, len);
+}
+
+
+/*!
+ * @brief Check whether all queued console output has reached the hardware.
+ *
+ * @return TRUE if the TX ring is empty and the transmit engine is idle.
+ */
+bool_t
+uart_tx_idle (void)
+{
+    return uart_port_tx_idle(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Free space in the console TX ring.
+ *
+ * @return Number of bytes uart_write() would accept right now.
+ */
+uint32_t
+uart_tx_space (void)
+{
+    return uart_port_tx_space(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Line rate a baud setting would produce on the console.
+ *
+ * @param[in] baud Requested line rate.
+ * @param[in] b_oversample8 Use 8x oversampling.
+ *
+ * @return Resulting baud rate, or 0 if not reachable at the current clock.
+ */
+uint32_t
+uart_baud_actual (uint32_t baud, bool_t b_oversample8)
+{
+    return uart_port_baud_actual(UART_CONSOLE, baud, b_oversample8);
+}
+
+
+/*!
+ * @brief Change the console line rate once queued output has drained.
+ *
+ * @param[in] baud New line rate.
+ * @param[in] b_oversample8 Use 8x oversampling.
+ *
+ * @return 0 on success, -1 if the rate is not reachable, -2 if TX is busy.
+ */
+int32_t
+uart_set_baud (uint32_t baud, bool_t b_oversample8)
+{
+    return uart_port_set_baud(UART_CONSOLE, baud, b_oversample8);
+}
+
+
+/*!
+ * @brief Currently configured console line rate.
+ *
+ * @param[out] p_b_oversample8 Set to the oversampling mode (may be NULL).
+ *
+ * @return Requested baud rate last applied.
+ */
+uint32_t
+uart_get_baud (bool_t * p_b_oversample8)
+{
+    return uart_port_get_baud(UART_CONSOLE, p_b_oversample8);
+}
+
+
+/*!
+ * @brief Fetch and clear the events posted for the console port.
+ *
+ * @return UART_EVENT_* bits posted since the previous call.
+ */
+uint32_t
+uart_take_events (void)
+{
+    return uart_port_take_events(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Reset the console receiver after an error condition.
+ */
+void
+uart_error_reset (void)
+{
+    uart_port_error_reset(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Read the console port's receive error counters.
+ *
+ * @param[out] p_stats Counters since init or the last reset.
+ */
+void
+uart_get_stats (uart_stats_t * p_stats)
+{
+    uart_port_get_stats(UART_CONSOLE, p_stats);
+}
+
+
+/*!
+ * @brief Clear the console port's receive error counters.
+ */
+void
+uart_reset_stats (void)
+{
+    uart_port_reset_stats(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Enable or disable out-of-band control bytes on the console port.
+ *
+ * @param[in] b_enable TRUE to act on control bytes.
+ */
+void
+uart_set_oob (bool_t b_enable)
+{
+    uart_port_set_oob(UART_CONSOLE, b_enable);
+}
+
+
+/*!
+ * @brief Enable or disable dropping of corrupt lines on the console.
+ *
+ * @param[in] b_enable TRUE to drop lines hit by a receive error.
+ */
+void
+uart_set_resync (bool_t b_enable)
+{
+    uart_port_set_resync(UART_CONSOLE, b_enable);
+}
+
+
+/*!
+ * @brief Check whether the console dropped a corrupt line.
+ *
+ * @return TRUE once per dropped line.
+ */
+bool_t
+uart_take_line_lost (void)
+{
+    return uart_port_take_line_lost(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Fetch and clear the console's cancel and status requests.
+ *
+ * @return UART_OOB_* bits received since the previous call.
+ */
+uint32_t
+uart_take_oob (void)
+{
+    return uart_port_take_oob(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Check whether the console transmitter is held by XOFF.
+ *
+ * @return TRUE between XOFF and the next XON (or Ctrl-C).
+ */
+bool_t
+uart_tx_paused (void)
+{
+    return uart_port_tx_paused(UART_CONSOLE);
+}
+
+
+/*!
+ * @brief Check that the console can sleep through STOP and arm its wakeup.
+ *
+ * @return TRUE if STOP may be entered now.
+ */
+bool_t
+uart_arm_wakeup (void)
+{
+    return uart_port_arm_wakeup(UART_CONSOLE);
+}
+
+
 /*!
  * @brief Blocking delay using SysTick timer.
  *
@@ -401,7 +2373,7 @@ delay_ms (uint32_t milliseconds)
     *SYST_CSR |= ((1u << SYSTICK_CTRL_ENABLE_BIT) | 
                       (1u << SYSTICK_CTRL_CLKSRC_BIT));
 
-    *SYST_RVR = (SYSTEM_CORE_CLOCK / SYSTICK_MS_DIVISOR) - 1u;
+    *SYST_RVR = (clock_get_hz() / SYSTICK_MS_DIVISOR) - 1u;
 
     for (uint32_t i = 0u; i < milliseconds; i++)
     {
@@ -2,6 +2,11 @@
  *
  * @brief UART driver interface for STM32G0 interrupt-driven communication.
  *
+ * Every USART/LPUART instance is driven through its own uart_port_t
+ * context with independent rings, state and line rate; the uart_port_*
+ * functions take the port to act on. The plain uart_* functions are the
+ * same operations on the console port (UART_CONSOLE_ID) used by the CLI.
+ *
  * @par
  * COPYRIGHT NOTICE: (c) 2025 Your Name. All rights reserved.
  */
@@ -12,15 +17,116 @@
 #include <stdint.h>
 #include "types.h"  /* For bool_t type (Keil compatible) */
 
-/* Buffer size for UART reception */
+/* Maximum length of one received command line */
 #define RX_BUFFER_SIZE_BYTES   100u
 
-/* UART configuration modes */
-#define UART_MODE_NORMAL       0u
-#define UART_MODE_ECHO         1u
+/* ISR <-> application ring buffers (sizes must be powers of two) */
+#define UART_RX_RING_SIZE      256u
+#define UART_TX_RING_SIZE      1024u
+
+/* Largest in-place reservation from uart_tx_reserve() */
+#define UART_TX_RESERVE_MAX    128u
+
+#if ((UART_RX_RING_SIZE & (UART_RX_RING_SIZE - 1u)) != 0u) || \
+    ((UART_TX_RING_SIZE & (UART_TX_RING_SIZE - 1u)) != 0u)
+#error "UART ring buffer sizes must be powers of two"
+#endif
+
+/* Line rate after reset (8N1, 16x oversampling) */
+#ifndef UART_DEFAULT_BAUD
+#define UART_DEFAULT_BAUD      9600u
+#endif
+
+/* UART instances */
+#define UART_ID_USART1         0u
+#define UART_ID_USART2         1u
+#define UART_ID_USART3         2u
+#define UART_ID_USART4         3u
+#define UART_ID_LPUART1        4u
+#define UART_ID_COUNT          5u
+
+/* Instances compiled in (each costs its rings in RAM) */
+#ifndef UART_ENABLE_USART1
+#define UART_ENABLE_USART1     0u   /* PA9/PA10 AF1, DMA1 ch3/ch4 */
+#endif
+#ifndef UART_ENABLE_USART2
+#define UART_ENABLE_USART2     1u   /* PA2/PA3 AF1, DMA1 ch1/ch2 (ST-LINK VCP) */
+#endif
+#ifndef UART_ENABLE_USART3
+#define UART_ENABLE_USART3     0u   /* PB10/PB11 AF4, interrupt driven */
+#endif
+#ifndef UART_ENABLE_USART4
+#define UART_ENABLE_USART4     0u   /* PA0/PA1 AF4, interrupt driven */
+#endif
+#ifndef UART_ENABLE_LPUART1
+#define UART_ENABLE_LPUART1    0u   /* PA2/PA3 AF6 (shares the VCP pins with USART2), DMA1 ch5/ch6 */
+#endif
+
+/* Port behind the uart_* console functions */
+#ifndef UART_CONSOLE_ID
+#define UART_CONSOLE_ID        UART_ID_USART2
+#endif
+
+/* LPUART1 runs from HSI16 and wakes the core from STOP on a start bit
+   (console must be LPUART1; USART2 off, it shares PA2/PA3) */
+#ifndef UART_STOP_WAKEUP
+#define UART_STOP_WAKEUP       0u
+#endif
+
+/* UART configuration modes (test.c) */
+#define UART_MODE_NORMAL       0u   /* One test string every 5 s */
+#define UART_MODE_ECHO         1u   /* Echo received data */
+#define UART_MODE_TX_BENCH     2u   /* Sustained TX, bytes/s reported every second */
+#define UART_MODE_LOOPBACK     3u   /* Echo a host stream, summary once it stops */
+#define UART_MODE_PINGPONG     4u   /* Round-trip time of probes echoed back */
 
 /* Select active UART mode */
+#ifndef UART_CONFIG
 #define UART_CONFIG            UART_MODE_NORMAL
+#endif
+
+/* UART transmit engines */
+#define UART_TX_MODE_IRQ       0u   /* One TXE interrupt per byte */
+#define UART_TX_MODE_DMA       1u   /* Port's TX DMA channel, one TC interrupt per ring run */
+
+/* Select active transmit engine (ports without a DMA channel use IRQ) */
+#define UART_TX_MODE           UART_TX_MODE_DMA
+
+/* UART receive engines */
+#define UART_RX_MODE_IRQ       0u   /* One RXNE interrupt per byte */
+#define UART_RX_MODE_DMA       1u   /* Port's circular RX DMA channel + IDLE line detection */
+
+/* Select active receive engine (ports without a DMA channel use IRQ) */
+#define UART_RX_MODE           UART_RX_MODE_DMA
+
+/* Flow control of received data */
+#define UART_FLOW_NONE         0u   /* Sender paces itself; excess bytes are dropped */
+#define UART_FLOW_RTS_CTS      1u   /* Hardware RTS/CTS, on ports that have the pins */
+#define UART_FLOW_XON_XOFF     2u   /* XOFF/XON sent at the RX ring watermarks (text only) */
+
+/* Select flow control for every port */
+#ifndef UART_FLOW_CONTROL
+#define UART_FLOW_CONTROL      UART_FLOW_NONE
+#endif
+
+/* RX ring watermarks. RX DMA publishes up to half a ring at a time, so
+   holding at a quarter still leaves a quarter for bytes in flight. */
+#define UART_RX_FLOW_HIGH      (UART_RX_RING_SIZE / 4u)
+#define UART_RX_FLOW_LOW       (UART_RX_RING_SIZE / 8u)
+
+/* Events posted by the UART interrupts for an event-driven main loop */
+#define UART_EVENT_RX          (1u << 0)   /* Byte received (RX DMA: idle line, half/full ring) */
+#define UART_EVENT_TX_DRAINED  (1u << 1)   /* TX ring space was freed */
+
+/* Out-of-band control bytes, acted on by the RX interrupt once enabled */
+#define UART_OOB_CHAR_CANCEL   '\x03'      /* Ctrl-C: abort the running command */
+#define UART_OOB_CHAR_XON      '\x11'      /* Ctrl-Q: resume transmission */
+#define UART_OOB_CHAR_XOFF     '\x13'      /* Ctrl-S: pause transmission */
+#define UART_OOB_CHAR_STATUS   '\x14'      /* Ctrl-T: status query */
+
+/* Requests left for the application by uart_take_oob() */
+#define UART_OOB_CANCEL        (1u << 0)
+#define UART_OOB_STATUS        (1u << 1)
 
 /* UART state machine states */
 typedef enum
@@ -41,11 +147,70 @@ typedef enum
     UART_ERROR_NOISE
 } uart_error_t;
 
-/* Public API functions */
+/* Receive error counters since init or the last reset */
+typedef struct uart_stats
+{
+    uint32_t overrun;           /* UART_ERROR_OVERRUN occurrences */
+    uint32_t framing;           /* UART_ERROR_FRAMING occurrences */
+    uint32_t parity;            /* UART_ERROR_PARITY occurrences */
+    uint32_t noise;             /* UART_ERROR_NOISE occurrences */
+    uint32_t rx_dropped;        /* Bytes lost to a full RX ring */
+    uint32_t rx_held;           /* Times the sender was held at the high watermark */
+    uint32_t rx_lines_lost;     /* Lines dropped after a receive error */
+} uart_stats_t;
+
+/* Per-port driver context (defined in uart.c) */
+typedef struct uart_port uart_port_t;
+
+/* Per-port API functions */
+uart_port_t * uart_port_get(uint32_t id);
+int32_t uart_port_init(uart_port_t * p_port);
+uint32_t uart_port_write(uart_port_t * p_port, char const * p_data, uint32_t len);
+char * uart_port_tx_reserve(uart_port_t * p_port, uint32_t len);
+void uart_port_tx_commit(uart_port_t * p_port, uint32_t len);
+uint32_t uart_port_read(uart_port_t * p_port, char * p_data, uint32_t len);
+uint32_t uart_port_rx_peek(uart_port_t * p_port, char const ** pp_data);
+void uart_port_rx_consume(uart_port_t * p_port, uint32_t len);
+bool_t uart_port_tx_idle(uart_port_t * p_port);
+uint32_t uart_port_tx_space(uart_port_t * p_port);
+uint32_t uart_port_baud_actual(uart_port_t * p_port, uint32_t baud, bool_t b_oversample8);
+int32_t uart_port_set_baud(uart_port_t * p_port, uint32_t baud, bool_t b_oversample8);
+uint32_t uart_port_get_baud(uart_port_t * p_port, bool_t * p_b_oversample8);
+uint32_t uart_port_take_events(uart_port_t * p_port);
+void uart_port_error_reset(uart_port_t * p_port);
+void uart_port_get_stats(uart_port_t * p_port, uart_stats_t * p_stats);
+void uart_port_reset_stats(uart_port_t * p_port);
+void uart_port_set_resync(uart_port_t * p_port, bool_t b_enable);
+bool_t uart_port_take_line_lost(uart_port_t * p_port);
+void uart_port_set_oob(uart_port_t * p_port, bool_t b_enable);
+uint32_t uart_port_take_oob(uart_port_t * p_port);
+bool_t uart_port_tx_paused(uart_port_t * p_port);
+bool_t uart_port_arm_wakeup(uart_port_t * p_port);
+
+/* Console port API functions */
 int32_t uart_init(void);
+uint32_t uart_write(char const * p_data, uint32_t len);
+char * uart_tx_reserve(uint32_t len);
+void uart_tx_commit(uint32_t len);
+uint32_t uart_read(char * p_data, uint32_t len);
+uint32_t uart_rx_peek(char const ** pp_data);
+void uart_rx_consume(uint32_t len);
 int32_t uart_transmit_buffer(char const * const p_str);
-int32_t uart_receive_buffer(void);
+bool_t uart_tx_idle(void);
+uint32_t uart_tx_space(void);
+uint32_t uart_baud_actual(uint32_t baud, bool_t b_oversample8);
+int32_t uart_set_baud(uint32_t baud, bool_t b_oversample8);
+uint32_t uart_get_baud(bool_t * p_b_oversample8);
+uint32_t uart_take_events(void);
 void uart_error_reset(void);
+void uart_get_stats(uart_stats_t * p_stats);
+void uart_reset_stats(void);
+void uart_set_resync(bool_t b_enable);
+bool_t uart_take_line_lost(void);
+void uart_set_oob(bool_t b_enable);
+uint32_t uart_take_oob(void);
+bool_t uart_tx_paused(void);
+bool_t uart_arm_wakeup(void);
 void delay_ms(uint32_t milliseconds);
 
 #endif /* UART_H */